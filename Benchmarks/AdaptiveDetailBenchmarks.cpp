@@ -0,0 +1,140 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/ReverbEngine.h"
+
+/**
+ * A minute of program-like material (phrases of decaying harmonic notes with rests between them)
+ * through the engine at full and at adaptive tank detail: the cost of each, how long the tank
+ * spent at each detail, and how far the adaptive render strays from the full one.
+ */
+class AdaptiveDetailBenchmarks : public Benchmark
+{
+public:
+    AdaptiveDetailBenchmarks() : Benchmark ("Adaptive tank detail on program material: cost and quality") {}
+
+    void run() override
+    {
+        // As in the plugin's processBlock: quiet tails would otherwise run on denormals
+        juce::ScopedNoDenormals noDenormals;
+
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+
+        const auto program = makeProgram (sampleRate, 60.0);
+        const int numSamples = program.getNumSamples();
+
+        DSP::ReverbSettings settings;
+        settings.decayS = 2.5f;
+        settings.modDepth = 0.5f;
+        settings.earlySend = 0.3f;
+
+        juce::AudioBuffer<float> wet[2] = { { 2, numSamples }, { 2, numSamples } };
+        std::array<juce::int64, 3> samplesAtDetail {};
+        double cost[2] = {};
+
+        for (int adaptive = 0; adaptive < 2; ++adaptive)
+        {
+            DSP::ReverbEngine engine;
+            engine.setIsa (DSP::CpuDispatch::select());
+            engine.setSettings (settings);
+            engine.setAdaptiveDetail (adaptive != 0);
+            engine.prepare (sampleRate, blockSize);
+
+            auto render = [&] (bool countDetail)
+            {
+                engine.reset();
+
+                for (int pos = 0; pos < numSamples; pos += blockSize)
+                {
+                    const int n = juce::jmin (blockSize, numSamples - pos);
+                    engine.process (program.getReadPointer (0, pos), program.getReadPointer (1, pos),
+                                    wet[adaptive].getWritePointer (0, pos), wet[adaptive].getWritePointer (1, pos), n);
+
+                    if (countDetail)
+                        samplesAtDetail[(size_t) engine.getTankDetail()] += n;
+                }
+            };
+
+            cost[adaptive] = measure (adaptive != 0 ? "ReverbEngine, adaptive tank detail" : "ReverbEngine, full tank detail",
+                                      numSamples, [&] { render (false); benchmarkSink (wet[adaptive].getSample (0, numSamples - 1)); },
+                                      "ns/sample", 3);
+
+            if (adaptive != 0)
+                render (true);
+        }
+
+        report ("  adaptive vs full", cost[1] / cost[0], "x");
+
+        const char* names[] = { "  time at full detail", "  time held (no modulation, whole-sample reads)", "  time folded to four lines" };
+        for (size_t d = 0; d < 3; ++d)
+            report (names[d], 100.0 * (double) samplesAtDetail[d] / (double) numSamples, "%");
+
+        // Quality: the envelopes in 50 ms windows while the full render is above -100 dBFS, and the
+        // largest sample difference (the tails' fine structure changes once the modulation holds)
+        const int window = (int) (0.05 * sampleRate);
+        float worstEnvelopeDb = 0.0f, maxDiff = 0.0f, peak = 0.0f;
+
+        for (int pos = 0; pos + window <= numSamples; pos += window)
+        {
+            double energy[2] = {};
+
+            for (int v = 0; v < 2; ++v)
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = pos; i < pos + window; ++i)
+                        energy[v] += wet[v].getSample (ch, i) * wet[v].getSample (ch, i);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = pos; i < pos + window; ++i)
+                {
+                    maxDiff = juce::jmax (maxDiff, std::abs (wet[1].getSample (ch, i) - wet[0].getSample (ch, i)));
+                    peak = juce::jmax (peak, std::abs (wet[0].getSample (ch, i)));
+                }
+
+            if (energy[0] / (2.0 * window) > 1.0e-10)
+                worstEnvelopeDb = juce::jmax (worstEnvelopeDb, std::abs ((float) (10.0 * std::log10 (energy[1] / energy[0]))));
+        }
+
+        report ("  worst 50 ms envelope difference, wet above -100 dBFS", worstEnvelopeDb, "dB");
+        report ("  largest sample difference, relative to peak", juce::Decibels::gainToDecibels (maxDiff / peak, -200.0f), "dB");
+    }
+
+private:
+    /** Phrases of 2 - 6 s, a note every 150 - 400 ms, then 1.5 - 6 s of rest for the tail. */
+    static juce::AudioBuffer<float> makeProgram (double sampleRate, double seconds)
+    {
+        juce::AudioBuffer<float> buffer (2, (int) (sampleRate * seconds));
+        buffer.clear();
+        juce::Random rng (11);
+
+        double t = 0.0;
+        while (t < seconds)
+        {
+            const double phraseEnd = t + 2.0 + 4.0 * rng.nextDouble();
+
+            for (; t < phraseEnd; t += 0.15 + 0.25 * rng.nextDouble())
+            {
+                const double hz = 110.0 * std::pow (2.0, 3.0 * rng.nextDouble());
+                const float pan = rng.nextFloat();
+                const int start = (int) (t * sampleRate);
+                const int length = juce::jmin ((int) (1.5 * sampleRate), buffer.getNumSamples() - start);
+
+                for (int i = 0; i < length; ++i)
+                {
+                    const double time = i / sampleRate;
+                    const double phase = juce::MathConstants<double>::twoPi * hz * time;
+                    const float note = (float) ((std::sin (phase) + 0.5 * std::sin (2.0 * phase) + 0.25 * std::sin (3.0 * phase))
+                                                * 0.15 * std::exp (-time / 0.3));
+
+                    buffer.addSample (0, start + i, note * (1.0f - pan));
+                    buffer.addSample (1, start + i, note * pan);
+                }
+            }
+
+            t += 1.5 + 4.5 * rng.nextDouble();
+        }
+
+        return buffer;
+    }
+};
+
+static AdaptiveDetailBenchmarks adaptiveDetailBenchmarks;
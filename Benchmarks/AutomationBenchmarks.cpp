@@ -0,0 +1,82 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/CrossfadingEngine.h"
+#include "../Source/DSP/AutomationScheduler.h"
+
+class AutomationBenchmarks : public Benchmark
+{
+public:
+    AutomationBenchmarks() : Benchmark ("Automation: sub-block parameter updates") {}
+
+    void run() override
+    {
+        constexpr int numSamples = 1 << 15;
+        constexpr int blockSize = 512;
+        constexpr double sampleRate = 48000.0;
+
+        juce::AudioBuffer<float> input (2, numSamples), buffer (2, numSamples), wet (2, blockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        // Decay, hi cut and mod depth: the parameters that touch the most coefficients
+        enum { decay, hiCut, modDepth, numValues };
+
+        auto makeSettings = [] (const float* values)
+        {
+            DSP::ReverbSettings settings;
+            settings.decayS = values[decay];
+            settings.hiCutHz = values[hiCut];
+            settings.modDepth = values[modDepth];
+            return settings;
+        };
+
+        // 0 = no automation, otherwise a step on every parameter each `interval` samples
+        for (int interval : { 0, 256, 64, 16 })
+        {
+            DSP::CrossfadingEngine engine;
+            engine.prepare (sampleRate, blockSize);
+
+            const float initial[numValues] = { 2.0f, 6000.0f, 0.3f };
+            DSP::AutomationScheduler<numValues> scheduler;
+            scheduler.reset (initial);
+            engine.resetSettings (makeSettings (initial));
+
+            auto label = interval == 0 ? juce::String ("no automation")
+                                       : "events every " + juce::String (interval) + " samples";
+            int counter = 0;
+
+            measure (label, numSamples, [&]
+            {
+                buffer.makeCopyOf (input, true);
+                auto* l = buffer.getWritePointer (0);
+                auto* r = buffer.getWritePointer (1);
+
+                for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+                {
+                    for (int offset = 0; interval > 0 && offset < blockSize; offset += interval)
+                    {
+                        float t = (float) (++counter % 100) * 0.01f;
+                        scheduler.addEvent ({ decay, 1.0f + t, offset, false });
+                        scheduler.addEvent ({ hiCut, 4000.0f + 4000.0f * t, offset, false });
+                        scheduler.addEvent ({ modDepth, t, offset, false });
+                    }
+
+                    scheduler.process (blockSize, [&] (const float* values, int segmentStart, int n)
+                    {
+                        engine.setSettings (makeSettings (values));
+                        engine.process (l + start + segmentStart, r + start + segmentStart,
+                                        wet.getWritePointer (0), wet.getWritePointer (1), n);
+                        juce::FloatVectorOperations::add (l + start + segmentStart, wet.getReadPointer (0), n);
+                        juce::FloatVectorOperations::add (r + start + segmentStart, wet.getReadPointer (1), n);
+                    });
+                }
+
+                benchmarkSink (l[numSamples - 1]);
+            }, "ns/sample", 5);
+        }
+    }
+};
+
+static AutomationBenchmarks automationBenchmarks;
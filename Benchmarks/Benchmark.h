@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Minimal micro-benchmark base, registered like juce::UnitTest.
+ * Derive, implement run(), and create a static instance in the .cpp file.
+ */
+class Benchmark
+{
+public:
+    explicit Benchmark (const juce::String& benchmarkName) : name (benchmarkName)
+    {
+        getAllBenchmarks().push_back (this);
+    }
+
+    virtual ~Benchmark()
+    {
+        auto& all = getAllBenchmarks();
+        all.erase (std::remove (all.begin(), all.end(), this), all.end());
+    }
+
+    virtual void run() = 0;
+
+    const juce::String& getName() const { return name; }
+
+    static std::vector<Benchmark*>& getAllBenchmarks()
+    {
+        static std::vector<Benchmark*> benchmarks;
+        return benchmarks;
+    }
+
+protected:
+    /**
+     * @brief Times fn (after one warm-up call) and prints the best of numRuns as ns per unit.
+     * unitsPerRun is whatever the caller wants normalised to, usually samples.
+     * @returns ns per unit of the fastest run.
+     */
+    template <typename Fn>
+    double measure (const juce::String& label, juce::int64 unitsPerRun, Fn&& fn,
+                    const juce::String& unit = "ns/sample", int numRuns = 15)
+    {
+        fn();
+
+        double best = 1.0e30;
+        for (int r = 0; r < numRuns; ++r)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            fn();
+            auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            best = juce::jmin (best, elapsed);
+        }
+
+        auto nsPerUnit = best * 1.0e9 / (double) juce::jmax ((juce::int64) 1, unitsPerRun);
+        report (label, nsPerUnit, unit);
+        return nsPerUnit;
+    }
+
+    void report (const juce::String& label, double value, const juce::String& unit)
+    {
+        std::printf ("  %-56s %12.3f %s\n", label.toRawUTF8(), value, unit.toRawUTF8());
+    }
+
+private:
+    juce::String name;
+};
+
+/** Keeps the optimiser from dropping a result. */
+inline void benchmarkSink (float value)
+{
+    static volatile float sink = 0.0f;
+    sink = sink + value;
+}
@@ -0,0 +1,29 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/CpuDispatch.h"
+
+// Usage: AntigravReverb_Benchmarks [name filter]
+int main (int argc, char* argv[])
+{
+    // The instantiation benchmark builds whole processors, which need a message manager
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::String filter = argc > 1 ? juce::String (argv[1]) : juce::String();
+
+    // Everything that goes through a processor runs the variant picked here (ANTIGRAV_ISA overrides)
+    std::printf ("Kernel variant: %s (best supported: %s)\n\n",
+                 DSP::CpuDispatch::getName (DSP::CpuDispatch::select()),
+                 DSP::CpuDispatch::getName (DSP::CpuDispatch::getBestSupported()));
+
+    for (auto* b : Benchmark::getAllBenchmarks())
+    {
+        if (filter.isNotEmpty() && ! b->getName().containsIgnoreCase (filter))
+            continue;
+
+        std::printf ("%s\n", b->getName().toRawUTF8());
+        b->run();
+        std::printf ("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/CrossfadingEngine.h"
+#include "../Source/DSP/BlockAdapter.h"
+
+class BlockSizeBenchmarks : public Benchmark
+{
+public:
+    BlockSizeBenchmarks() : Benchmark ("Block size: host blocks direct vs BlockAdapter") {}
+
+    void run() override
+    {
+        constexpr int numSamples = 1 << 15;
+        constexpr double sampleRate = 48000.0;
+
+        juce::AudioBuffer<float> input (2, numSamples), buffer (2, numSamples), wet (2, DSP::BlockAdapter::maxBlockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        DSP::ReverbSettings settings;
+        settings.modDepth = 0.5f;
+
+        for (int hostBlock : { 16, 32, 64, 128, 512 })
+        {
+            for (int internalBlock : { 0, 64, 128 })
+            {
+                if (internalBlock != 0 && internalBlock <= hostBlock)
+                    continue;
+
+                DSP::CrossfadingEngine engine;
+                engine.prepare (sampleRate, DSP::BlockAdapter::maxBlockSize);
+                engine.resetSettings (settings);
+
+                DSP::BlockAdapter adapter;
+                adapter.prepare();
+                adapter.setBlockSize (internalBlock);
+
+                auto render = [&] (float* l, float* r, int n)
+                {
+                    // Same per-block work as the processor: settings update, engine, mix
+                    engine.setSettings (settings);
+                    engine.process (l, r, wet.getWritePointer (0), wet.getWritePointer (1), n);
+                    juce::FloatVectorOperations::add (l, wet.getReadPointer (0), n);
+                    juce::FloatVectorOperations::add (r, wet.getReadPointer (1), n);
+                };
+
+                auto label = juce::String ("host ") + juce::String (hostBlock)
+                           + (internalBlock == 0 ? juce::String (", direct")
+                                                 : ", adapter " + juce::String (internalBlock));
+
+                measure (label, numSamples, [&]
+                {
+                    buffer.makeCopyOf (input, true);
+                    auto* l = buffer.getWritePointer (0);
+                    auto* r = buffer.getWritePointer (1);
+
+                    for (int start = 0; start + hostBlock <= numSamples; start += hostBlock)
+                        adapter.process (l + start, r + start, hostBlock, render);
+
+                    benchmarkSink (l[numSamples - 1]);
+                }, "ns/sample", 5);
+            }
+        }
+    }
+};
+
+static BlockSizeBenchmarks blockSizeBenchmarks;
@@ -0,0 +1,66 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/ReverbEngine.h"
+
+class ChannelLayoutBenchmarks : public Benchmark
+{
+public:
+    ChannelLayoutBenchmarks() : Benchmark ("Channel layouts: stereo vs mono -> stereo vs mono engine") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 64;
+
+        juce::AudioBuffer<float> input (2, blockSize), wet (2, blockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        const float* inL = input.getReadPointer (0);
+        const float* inR = input.getReadPointer (1);
+        float* wetL = wet.getWritePointer (0);
+        float* wetR = wet.getWritePointer (1);
+
+        // Modulated early field and full late diffusion, so every per-channel stage has work to do
+        DSP::ReverbSettings settings;
+        settings.modDepth = 0.5f;
+        settings.earlySend = 0.3f;
+
+        auto engineCost = [&] (const char* name, const float* sourceR, float* destR, DSP::EarlyEngine early)
+        {
+            settings.earlyEngine = (int) early;
+
+            DSP::ReverbEngine engine;
+            engine.setSettings (settings);
+            engine.prepare (sampleRate, blockSize);
+
+            return measure (name, blockSize * numBlocks, [&]
+            {
+                for (int b = 0; b < numBlocks; ++b)
+                    engine.process (inL, sourceR, wetL, destR, blockSize);
+
+                benchmarkSink (wetL[0]);
+            });
+        };
+
+        for (auto early : { DSP::EarlyEngine::allpass, DSP::EarlyEngine::velvet })
+        {
+            const bool velvet = early == DSP::EarlyEngine::velvet;
+
+            auto stereoCost = engineCost (velvet ? "ReverbEngine, velvet, stereo" : "ReverbEngine, allpass, stereo",
+                                          inR, wetR, early);
+            auto spreadCost = engineCost (velvet ? "ReverbEngine, velvet, mono -> stereo" : "ReverbEngine, allpass, mono -> stereo",
+                                          nullptr, wetR, early);
+            auto monoCost = engineCost (velvet ? "ReverbEngine, velvet, mono" : "ReverbEngine, allpass, mono",
+                                        nullptr, nullptr, early);
+
+            report ("  mono -> stereo vs stereo", spreadCost / stereoCost, "x");
+            report ("  mono vs stereo", monoCost / stereoCost, "x");
+        }
+    }
+};
+
+static ChannelLayoutBenchmarks channelLayoutBenchmarks;
@@ -0,0 +1,99 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/Filters.h"
+#include "../Source/DSP/DampingFilterBank.h"
+#include "../Source/DSP/LateReverb.h"
+
+class DampingBenchmarks : public Benchmark
+{
+public:
+    DampingBenchmarks() : Benchmark ("FDN damping: 16 OnePoleFilters vs DampingFilterBank<8>") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int numSamples = 1 << 16;
+
+        std::vector<float> noise (4096);
+        juce::Random rng (1);
+        for (auto& x : noise)
+            x = rng.nextFloat() * 2.0f - 1.0f;
+
+        // The filter states are the only recursion, as in the tank, where the feedback goes through the delays
+        std::array<DSP::OnePoleFilter, 8> hiCut, loCut;
+        for (size_t i = 0; i < 8; ++i)
+        {
+            hiCut[i].setCoefficients (sampleRate, 6000.0f, DSP::OnePoleFilter::Type::LowPass);
+            loCut[i].setCoefficients (sampleRate, 50.0f, DSP::OnePoleFilter::Type::HighPass);
+        }
+
+        float lines[8] = {};
+        auto onePoleCost = measure ("16 x OnePoleFilter::process, per FDN sample", numSamples, [&]
+        {
+            for (int n = 0; n < numSamples; ++n)
+            {
+                for (size_t i = 0; i < 8; ++i)
+                {
+                    const float x = noise[(size_t) ((n + (int) i * 97) & 4095)];
+                    lines[i] += loCut[i].process (hiCut[i].process (x));
+                }
+            }
+            benchmarkSink (lines[0]);
+        });
+
+        for (bool shelved : { false, true })
+        {
+            DSP::DampingResponse response;
+            response.loCutHz = 50.0f;
+            response.hiCutHz = 6000.0f;
+            response.lowGain = shelved ? 1.2f : 1.0f;
+            response.highGain = shelved ? 0.6f : 1.0f;
+
+            DSP::DampingFilterBank<8> bank;
+            for (int i = 0; i < 8; ++i)
+                bank.setLane (i, sampleRate, response);
+
+            alignas (32) float x[8] = {}, sum[8] = {};
+            auto bankCost = measure (juce::String ("DampingFilterBank<8>::process") + (shelved ? ", T60 shelves" : ", cuts only"),
+                                     numSamples, [&]
+            {
+                for (int n = 0; n < numSamples; ++n)
+                {
+                    for (int i = 0; i < 8; ++i)
+                        x[i] = noise[(size_t) ((n + i * 97) & 4095)];
+
+                    bank.process (x);
+
+                    for (int i = 0; i < 8; ++i)
+                        sum[i] += x[i];
+                }
+                benchmarkSink (sum[0]);
+            });
+
+            report ("  relative cost vs one-pole pairs", bankCost / onePoleCost, "x");
+        }
+
+        // The whole tank, where the damping is one of several per-sample steps
+        juce::AudioBuffer<float> input (2, 512), buffer (2, 512);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < 512; ++i)
+                input.setSample (ch, i, noise[(size_t) (ch * 512 + i)]);
+
+        DSP::LateReverb late;
+        late.prepare (sampleRate);
+        late.setInputDiffusion (0.0f, 0);
+        late.setParameters (2.0f, 0.5f, 0.5f, 6000.0f, 50.0f);
+        late.setDecayShape (1.5f, 0.5f, 250.0f, 4000.0f);
+
+        measure ("LateReverb::processBlock with T60 shelves, 512 block", 512 * 64, [&]
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                buffer.makeCopyOf (input, true);
+                late.processBlock (buffer);
+            }
+        });
+    }
+};
+
+static DampingBenchmarks dampingBenchmarks;
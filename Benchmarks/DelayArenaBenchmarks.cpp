@@ -0,0 +1,151 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/DelayArena.h"
+#include "../Source/DSP/DelayLine.h"
+#include "../Source/DSP/LateReverb.h"
+
+/**
+ * The FDN's delay memory under cache pressure: N tanks at 192 kHz, one block each in turn as a
+ * host would run them. The tank is cut down to the memory traffic (modulated reads, Householder
+ * mix, writes) so the layouts can be compared on their own: eight separate 200 ms DelayLines, as
+ * the late tank had them, against one DelayArena sized line by line, with and without the
+ * block-start prefetch LateReverb issues.
+ * The full LateReverb follows for scale.
+ */
+class DelayArenaBenchmarks : public Benchmark
+{
+public:
+    DelayArenaBenchmarks() : Benchmark ("FDN delay layout: separate lines vs arena, across instance counts") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 192000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 8;
+
+        float input[blockSize], output[blockSize];
+        juce::Random rng (1);
+        for (auto& x : input)
+            x = rng.nextFloat() * 2.0f - 1.0f;
+
+        for (int numInstances : { 1, 8, 32, 128 })
+        {
+            double cost[3] = {};
+            const char* names[] = { " x separate lines, ", " x arena, ", " x arena + prefetch, " };
+
+            for (int layout = 0; layout < 3; ++layout)
+            {
+                std::vector<std::unique_ptr<Tank>> tanks;
+                for (int i = 0; i < numInstances; ++i)
+                    tanks.push_back (std::make_unique<Tank> (sampleRate, layout));
+
+                // Fill the lines, so every read hits memory that was written
+                for (int b = 0; b < (int) (0.2 * sampleRate) / blockSize + 1; ++b)
+                    for (auto& tank : tanks)
+                        tank->process (input, output, blockSize);
+
+                const auto label = juce::String (numInstances) + names[layout]
+                                 + juce::String (juce::roundToInt ((double) tanks[0]->getMemorySize() / 1024.0)) + " KiB each";
+
+                cost[layout] = measure (label, (juce::int64) numInstances * blockSize * numBlocks, [&]
+                {
+                    for (int b = 0; b < numBlocks; ++b)
+                        for (auto& tank : tanks)
+                            tank->process (input, output, blockSize);
+
+                    benchmarkSink (output[0]);
+                }, "ns/sample", 5);
+            }
+
+            report ("  arena relative to separate lines", cost[1] / cost[0], "x");
+            report ("  arena + prefetch relative to separate lines", cost[2] / cost[0], "x");
+        }
+
+        DSP::LateReverb tank;
+        tank.prepare (sampleRate);
+        report ("LateReverb memory per instance (float lines)", (double) tank.getMemorySize() / 1024.0, "KiB");
+    }
+
+private:
+    /** Modulated reads, a Householder mix and writes, with the modulation stepped every 16 samples. */
+    struct Tank
+    {
+        Tank (double sampleRate, int layoutToUse) : layout (layoutToUse)
+        {
+            const float baseDelays[8] = { 29.1f, 37.3f, 44.9f, 53.7f, 61.3f, 79.1f, 88.7f, 97.1f };
+            float maxDelayMs[8];
+
+            for (int i = 0; i < 8; ++i)
+            {
+                nominalMs[i] = baseDelays[i];
+                maxDelayMs[i] = baseDelays[i] + 3.0f;
+                phases[i] = 0.1f * (float) i;
+            }
+
+            if (layout == 0)
+                for (auto& l : lines)
+                    l.prepare (sampleRate, 200.0);
+            else
+                arena.prepare (sampleRate, maxDelayMs);
+        }
+
+        size_t getMemorySize() const
+        {
+            size_t bytes = arena.getMemorySize();
+            for (auto& l : lines)
+                bytes += l.getMemorySize();
+            return bytes;
+        }
+
+        void process (const float* in, float* out, int numSamples)
+        {
+            for (int start = 0; start < numSamples; start += 16)
+            {
+                float delayMs[8];
+                for (int i = 0; i < 8; ++i)
+                {
+                    phases[i] += 0.0005f * (float) (i + 1);
+                    delayMs[i] = nominalMs[i] + 2.0f * std::sin (juce::MathConstants<float>::twoPi * phases[i]);
+                }
+
+                if (layout == 2 && start == 0)
+                    for (int ahead = 0; ahead < 64; ahead += 16)
+                        arena.prefetch (delayMs, ahead);
+
+                for (int n = start; n < juce::jmin (numSamples, start + 16); ++n)
+                {
+                    float delayOuts[8], feedback[8];
+
+                    if (layout == 0)
+                        for (int i = 0; i < 8; ++i)
+                            delayOuts[i] = lines[(size_t) i].read (delayMs[i]);
+                    else
+                        arena.read (delayMs, delayOuts);
+
+                    float sum = 0.0f;
+                    for (auto d : delayOuts)
+                        sum += d;
+                    sum *= 0.25f;
+
+                    for (int i = 0; i < 8; ++i)
+                        feedback[i] = in[n] + 0.9f * (delayOuts[i] - sum);
+
+                    if (layout == 0)
+                        for (int i = 0; i < 8; ++i)
+                            lines[(size_t) i].push (feedback[i]);
+                    else
+                        arena.push (feedback);
+
+                    out[n] = sum;
+                }
+            }
+        }
+
+        int layout;
+        std::array<DSP::DelayLine, 8> lines;
+        DSP::DelayArena<8> arena;
+        float nominalMs[8], phases[8];
+    };
+};
+
+static DelayArenaBenchmarks delayArenaBenchmarks;
@@ -0,0 +1,77 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/LateReverb.h"
+
+/**
+ * N late tanks at 192 kHz, run one block each in turn as a host would, with float and with
+ * half-float lines. One instance stays in cache either way; the half floats pay off once the
+ * instances' lines together no longer fit and every block streams them in from memory.
+ */
+class DelayStorageBenchmarks : public Benchmark
+{
+public:
+    DelayStorageBenchmarks() : Benchmark ("FDN delay storage: float32 vs float16 lines across instance counts") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 192000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 8;
+
+        juce::AudioBuffer<float> input (2, blockSize), buffer (2, blockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        for (int numInstances : { 1, 8, 32, 128 })
+        {
+            double cost[2] = {};
+
+            for (auto storage : { DSP::DelayStorage::float32, DSP::DelayStorage::float16 })
+            {
+                std::vector<std::unique_ptr<DSP::LateReverb>> tanks;
+                for (int i = 0; i < numInstances; ++i)
+                {
+                    auto tank = std::make_unique<DSP::LateReverb>();
+                    tank->setDelayStorage (storage);
+                    tank->prepare (sampleRate);
+                    tank->setInputDiffusion (0.0f, 0);
+                    tank->setParameters (2.0f, 0.5f, 0.5f, 8000.0f, 50.0f);
+                    tanks.push_back (std::move (tank));
+                }
+
+                // Fill the lines, so every read hits memory that was written
+                for (int b = 0; b < (int) (0.2 * sampleRate) / blockSize + 1; ++b)
+                {
+                    for (auto& tank : tanks)
+                    {
+                        buffer.makeCopyOf (input, true);
+                        tank->processBlock (buffer);
+                    }
+                }
+
+                const bool compact = storage == DSP::DelayStorage::float16;
+                const auto label = juce::String (numInstances) + (compact ? " x float16 lines, " : " x float32 lines, ")
+                                 + juce::String (juce::roundToInt ((double) tanks[0]->getMemorySize() / 1024.0)) + " KiB each";
+
+                cost[compact ? 1 : 0] = measure (label, (juce::int64) numInstances * blockSize * numBlocks, [&]
+                {
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        for (auto& tank : tanks)
+                        {
+                            buffer.makeCopyOf (input, true);
+                            tank->processBlock (buffer);
+                        }
+                    }
+                    benchmarkSink (buffer.getSample (0, 0));
+                }, "ns/sample", 5);
+            }
+
+            report ("  float16 relative to float32", cost[1] / cost[0], "x");
+        }
+    }
+};
+
+static DelayStorageBenchmarks delayStorageBenchmarks;
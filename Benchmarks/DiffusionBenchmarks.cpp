@@ -0,0 +1,105 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/AllpassFilter.h"
+#include "../Source/DSP/DiffusionCascade.h"
+#include "../Source/DSP/LateReverb.h"
+#include "../Source/Analysis/IRAnalysis.h"
+
+class DiffusionBenchmarks : public Benchmark
+{
+public:
+    DiffusionBenchmarks() : Benchmark ("Diffusion: block cascade cost vs echo density") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 128;
+
+        juce::AudioBuffer<float> input (2, blockSize), buffer (2, blockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        // Reference: the per-sample AllpassFilter chain, 4 stages per channel
+        {
+            std::array<DSP::AllpassFilter, 4> chainL, chainR;
+            const float delays[4] = { 1.3f, 2.3f, 3.7f, 5.3f };
+            for (size_t i = 0; i < 4; ++i)
+            {
+                chainL[i].prepare (sampleRate, 20.0); chainL[i].setDelay (delays[i]); chainL[i].setFeedback (0.5f);
+                chainR[i].prepare (sampleRate, 20.0); chainR[i].setDelay (delays[i] + 0.4f); chainR[i].setFeedback (0.5f);
+            }
+
+            measure ("AllpassFilter::process, 4 stages x 2 ch", blockSize * numBlocks, [&]
+            {
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    buffer.makeCopyOf (input, true);
+                    auto* l = buffer.getWritePointer (0);
+                    auto* r = buffer.getWritePointer (1);
+                    for (int i = 0; i < blockSize; ++i)
+                    {
+                        for (auto& apf : chainL) l[i] = apf.process (l[i]);
+                        for (auto& apf : chainR) r[i] = apf.process (r[i]);
+                    }
+                }
+            });
+        }
+
+        std::printf ("  %-8s %14s %18s %18s\n", "stages", "ns/sample", "NED @ 50 ms", "mixing time (ms)");
+
+        for (int stages = 0; stages <= DSP::DiffusionCascade::maxStages; ++stages)
+        {
+            DSP::DiffusionCascade cascade;
+            cascade.prepare (sampleRate);
+            cascade.setNumStages (stages);
+            cascade.setFeedback (0.5f);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                buffer.makeCopyOf (input, true);
+                cascade.process (buffer.getWritePointer (0), buffer.getWritePointer (1), blockSize);
+            }
+            auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            auto nsPerSample = seconds * 1.0e9 / (double) (blockSize * numBlocks);
+
+            // Density gain: echo density of the late tank's impulse response with this many diffusers
+            auto ir = renderLateImpulse (sampleRate, stages, (int) (sampleRate * 0.3));
+            auto ned50 = Analysis::echoDensityAt (ir, sampleRate, 0.05);
+            auto mixingMs = Analysis::mixingTimeMs (ir, sampleRate);
+
+            std::printf ("  %-8d %14.3f %18.3f %18.1f\n", stages, nsPerSample, ned50, mixingMs);
+        }
+    }
+
+private:
+    static std::vector<float> renderLateImpulse (double sampleRate, int stages, int length)
+    {
+        DSP::LateReverb late;
+        late.prepare (sampleRate);
+        late.setParameters (2.0f, 0.0f, 0.5f, 12000.0f, 20.0f);
+        late.setInputDiffusion (0.7f, stages);
+
+        std::vector<float> ir ((size_t) length);
+        juce::AudioBuffer<float> block (2, 256);
+
+        for (int pos = 0; pos < length; pos += 256)
+        {
+            block.clear();
+            if (pos == 0)
+                block.setSample (0, 0, 1.0f);
+
+            late.processBlock (block);
+
+            for (int i = 0; i < 256 && pos + i < length; ++i)
+                ir[(size_t) (pos + i)] = block.getSample (0, i);
+        }
+
+        return ir;
+    }
+};
+
+static DiffusionBenchmarks diffusionBenchmarks;
@@ -0,0 +1,67 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/LateReverb.h"
+
+/** The late tank once per kernel variant this CPU runs, with both delay storage formats. */
+class DispatchBenchmarks : public Benchmark
+{
+public:
+    DispatchBenchmarks() : Benchmark ("CPU dispatch: LateReverb per kernel variant") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 64;
+
+        juce::AudioBuffer<float> input (2, blockSize), buffer (2, blockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        std::printf ("  selected: %s\n", DSP::CpuDispatch::getName (DSP::CpuDispatch::select()));
+
+        for (auto storage : { DSP::DelayStorage::float32, DSP::DelayStorage::float16 })
+        {
+            double baselineCost = 0.0;
+
+            for (auto isa : { DSP::Isa::baseline, DSP::Isa::avx2, DSP::Isa::avx512 })
+            {
+                if (! DSP::CpuDispatch::isSupported (isa))
+                {
+                    std::printf ("  %s: not supported here\n", DSP::CpuDispatch::getName (isa));
+                    continue;
+                }
+
+                DSP::LateReverb late;
+                late.setDelayStorage (storage);
+                late.setIsa (isa);
+                late.prepare (sampleRate);
+                late.setInputDiffusion (0.0f, 0);
+                late.setParameters (2.0f, 0.5f, 0.5f, 8000.0f, 50.0f);
+                late.setDecayShape (1.5f, 0.5f, 250.0f, 4000.0f);
+
+                const auto label = juce::String ("LateReverb, ") + (storage == DSP::DelayStorage::float16 ? "float16" : "float32")
+                                 + " lines, " + DSP::CpuDispatch::getName (isa);
+
+                const auto cost = measure (label, blockSize * numBlocks, [&]
+                {
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        buffer.makeCopyOf (input, true);
+                        late.processBlock (buffer);
+                    }
+                    benchmarkSink (buffer.getSample (0, 0));
+                });
+
+                if (isa == DSP::Isa::baseline)
+                    baselineCost = cost;
+                else
+                    report ("  relative to baseline", cost / baselineCost, "x");
+            }
+        }
+    }
+};
+
+static DispatchBenchmarks dispatchBenchmarks;
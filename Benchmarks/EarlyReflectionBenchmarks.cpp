@@ -0,0 +1,95 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/EarlyReflections.h"
+#include "../Source/DSP/VelvetEarlyReflections.h"
+#include "../Source/DSP/RoomModel.h"
+
+class EarlyReflectionBenchmarks : public Benchmark
+{
+public:
+    EarlyReflectionBenchmarks() : Benchmark ("Early reflections: allpass + taps, room model taps and velvet noise") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr float sizeMs = 300.0f;
+
+        juce::AudioBuffer<float> input (2, 512), buffer (2, 512);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < 512; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        // 8 reflections per channel, smeared by the modulated diffusers
+        DSP::EarlyReflections allpass;
+        allpass.prepare (sampleRate);
+        allpass.setParameters (sizeMs, 0.1f, 0.8f);
+        allpass.setModulation (0.5f, 1.0f);
+
+        auto allpassCost = measure ("EarlyReflections::processBlock, modulated, 512 block", 512 * 64, [&]
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                buffer.makeCopyOf (input, true);
+                allpass.processBlock (buffer);
+            }
+        });
+
+        // The same field with the image-source taps, 16 per channel instead of 4
+        const auto roomTable = DSP::RoomTapTable::compute({});
+        DSP::EarlyReflections room;
+        room.prepare (sampleRate);
+        room.setParameters (sizeMs, 0.1f, 0.8f);
+        room.setModulation (0.5f, 1.0f);
+        room.setRoomTaps (&roomTable);
+
+        auto roomCost = measure ("EarlyReflections::processBlock, room model taps, 512 block", 512 * 64, [&]
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                buffer.makeCopyOf (input, true);
+                room.processBlock (buffer);
+            }
+        });
+
+        report ("  relative cost vs ratio taps", roomCost / allpassCost, "x");
+
+        for (float density : { 500.0f, 1000.0f, 1500.0f, 2500.0f, 4000.0f })
+        {
+            DSP::VelvetEarlyReflections velvet;
+            velvet.setParameters (sizeMs, 0.1f, density);
+            velvet.prepare (sampleRate);
+
+            auto label = "VelvetEarlyReflections, " + juce::String (velvet.getTable().getNumReflections()) + " reflections / channel";
+            auto velvetCost = measure (label, 512 * 64, [&]
+            {
+                for (int b = 0; b < 64; ++b)
+                {
+                    buffer.makeCopyOf (input, true);
+                    velvet.processBlock (buffer);
+                }
+            });
+
+            report ("  relative cost vs allpass + taps", velvetCost / allpassCost, "x");
+        }
+
+        // Regeneration happens on the worker, this is what a size change costs there
+        DSP::VelvetTable table;
+        int step = 0;
+        measure ("VelvetTable::generate, 1500 / s over 100-500 ms", 1, [&]
+        {
+            table.generate (sampleRate, 100.0f + (float) (++step % 400), 1500.0f, 0.1f);
+            benchmarkSink ((float) table.maxDelay);
+        }, "ns/table");
+
+        // A cache miss on the room model worker
+        DSP::RoomGeometry geometry;
+        measure ("RoomTapTable::compute, 3rd order image sources", 1, [&]
+        {
+            geometry.absorption = 0.1f + 0.001f * (float) (++step % 800);
+            benchmarkSink (DSP::RoomTapTable::compute (geometry).taps[0][0].gain);
+        }, "ns/table");
+    }
+};
+
+static EarlyReflectionBenchmarks earlyReflectionBenchmarks;
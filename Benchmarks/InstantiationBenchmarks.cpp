@@ -0,0 +1,112 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/PluginProcessor.h"
+
+#if JUCE_LINUX
+ #include <unistd.h>
+ #include <fstream>
+#endif
+
+/**
+ * Cold start of a session: N instances are constructed, prepared and asked for their first block.
+ * Memory is the growth of the process's resident set, which is what lazily backed delay memory
+ * saves; where the platform does not report it, only the engines' own byte count is printed.
+ */
+class InstantiationBenchmarks : public Benchmark
+{
+public:
+    InstantiationBenchmarks() : Benchmark ("Instantiation: time-to-first-audio and memory") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+
+        for (int numInstances : { 1, 16, 100 })
+        {
+            std::vector<std::unique_ptr<AntigravReverbAudioProcessor>> instances;
+            instances.reserve ((size_t) numInstances);
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            juce::MidiBuffer midi;
+
+            const auto residentBefore = getResidentBytes();
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numInstances; ++i)
+                instances.push_back (std::make_unique<AntigravReverbAudioProcessor>());
+
+            const auto constructed = juce::Time::getHighResolutionTicks();
+
+            for (auto& p : instances)
+            {
+                p->setPlayConfigDetails (2, 2, sampleRate, blockSize);
+                p->prepareToPlay (sampleRate, blockSize);
+            }
+
+            const auto prepared = juce::Time::getHighResolutionTicks();
+
+            // Hosts feed silence until the transport starts
+            for (auto& p : instances)
+            {
+                buffer.clear();
+                p->processBlock (buffer, midi);
+            }
+
+            const auto firstAudio = juce::Time::getHighResolutionTicks();
+            const auto residentIdle = getResidentBytes();
+
+            // The first real signal, which is when the delay memory gets written
+            juce::Random rng (1);
+            for (auto& p : instances)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+                p->processBlock (buffer, midi);
+                benchmarkSink (buffer.getSample (0, blockSize - 1));
+            }
+
+            const auto firstSound = juce::Time::getHighResolutionTicks();
+            const auto residentPlaying = getResidentBytes();
+
+            size_t engineBytes = 0;
+            for (auto& p : instances)
+                engineBytes += p->getMemoryReport().engineBytes;
+
+            auto ms = [] (juce::int64 ticks) { return juce::Time::highResolutionTicksToSeconds (ticks) * 1000.0; };
+            auto mb = [] (size_t bytes) { return (double) bytes / (1024.0 * 1024.0); };
+            const auto label = juce::String (numInstances) + (numInstances == 1 ? " instance: " : " instances: ");
+            const auto n = (double) numInstances;
+
+            report (label + "construct, per instance", ms (constructed - start) / n, "ms");
+            report (label + "prepareToPlay, per instance", ms (prepared - constructed) / n, "ms");
+            report (label + "time-to-first-audio (total)", ms (firstAudio - start), "ms");
+            report (label + "first non-silent block, per instance", ms (firstSound - firstAudio) / n, "ms");
+            report (label + "engine memory (allocated)", mb (engineBytes), "MB");
+
+            if (residentBefore > 0)
+            {
+                report (label + "resident growth after silence", mb (residentIdle - juce::jmin (residentIdle, residentBefore)), "MB");
+                report (label + "resident growth after first sound", mb (residentPlaying - juce::jmin (residentPlaying, residentBefore)), "MB");
+            }
+        }
+    }
+
+private:
+    /** Resident set size of the process, or 0 where it is not available. */
+    static size_t getResidentBytes()
+    {
+       #if JUCE_LINUX
+        std::ifstream statm ("/proc/self/statm");
+        size_t totalPages = 0, residentPages = 0;
+        if (statm >> totalPages >> residentPages)
+            return residentPages * (size_t) sysconf (_SC_PAGESIZE);
+       #endif
+
+        return 0;
+    }
+};
+
+static InstantiationBenchmarks instantiationBenchmarks;
@@ -0,0 +1,127 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/LFO.h"
+#include "../Source/DSP/ModulationBank.h"
+#include "../Source/DSP/LateReverb.h"
+#include "../Source/DSP/EarlyReflections.h"
+
+class ModulationBenchmarks : public Benchmark
+{
+public:
+    ModulationBenchmarks() : Benchmark ("Modulation: per-sample LFOs vs control-rate bank") {}
+
+    void run() override
+    {
+        constexpr int numSamples = 1 << 16;
+        constexpr double sampleRate = 48000.0;
+
+        // 8 per-sample LFOs, the way LateReverb used to run them
+        std::array<DSP::LFO, 8> lfos;
+        for (size_t i = 0; i < lfos.size(); ++i)
+        {
+            lfos[i].prepare (sampleRate);
+            lfos[i].setFrequency (0.5f * (0.9f + 0.02f * (float) i));
+            lfos[i].setDepth (3.0f);
+        }
+
+        auto perSample = measure ("8 x LFO::process per sample", numSamples, [&]
+        {
+            float acc = 0.0f;
+            for (int n = 0; n < numSamples; ++n)
+                for (auto& lfo : lfos)
+                    acc += lfo.process();
+            benchmarkSink (acc);
+        });
+
+        for (auto shape : { DSP::LFO::Waveform::Sine, DSP::LFO::Waveform::Triangle, DSP::LFO::Waveform::SmoothRandom })
+        {
+            DSP::ModulationBank<8> bank;
+            bank.prepare (sampleRate);
+            bank.setWaveform (shape);
+            for (size_t i = 0; i < 8; ++i)
+            {
+                bank.setFrequency (i, 0.5f * (0.9f + 0.02f * (float) i));
+                bank.setDepth (i, 3.0f);
+            }
+
+            const char* shapeName = shape == DSP::LFO::Waveform::Sine ? "sine"
+                                  : shape == DSP::LFO::Waveform::Triangle ? "triangle" : "smooth random";
+
+            auto bankCost = measure (juce::String ("ModulationBank<8>, interval 16, ") + shapeName, numSamples, [&]
+            {
+                alignas (32) float offsets[8];
+                float acc = 0.0f;
+                int n = 0;
+
+                while (n < numSamples)
+                {
+                    if (bank.getSamplesUntilTick() == 0)
+                        bank.tick();
+
+                    int span = juce::jmin (bank.getSamplesUntilTick(), numSamples - n);
+                    std::copy (bank.getValues(), bank.getValues() + 8, offsets);
+                    auto* inc = bank.getIncrements();
+
+                    for (int k = 0; k < span; ++k)
+                    {
+                        for (int i = 0; i < 8; ++i)
+                        {
+                            acc += offsets[i];
+                            offsets[i] += inc[i];
+                        }
+                    }
+
+                    bank.advance (span);
+                    n += span;
+                }
+
+                benchmarkSink (acc);
+            });
+
+            report ("  relative cost vs per-sample LFOs", bankCost / perSample, "x");
+        }
+
+        // Whole tank with modulation on, for context
+        DSP::LateReverb late;
+        late.prepare (sampleRate);
+        late.setParameters (2.0f, 1.0f, 0.5f, 8000.0f, 50.0f);
+
+        juce::AudioBuffer<float> input (2, 512), buffer (2, 512);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < 512; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        auto lateCost = measure ("LateReverb::processBlock, modulated, 512 block", 512 * 64, [&]
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                buffer.makeCopyOf (input, true);
+                late.processBlock (buffer);
+            }
+        });
+
+        // Early field with and without motion, against the tank it must stay well below
+        for (float depth : { 0.0f, 1.0f })
+        {
+            DSP::EarlyReflections er;
+            er.prepare (sampleRate);
+            er.setParameters (300.0f, 0.1f, 0.8f);
+            er.setModulation (0.5f, depth);
+
+            auto erCost = measure (juce::String ("EarlyReflections::processBlock, depth ") + juce::String (depth, 1) + ", 512 block",
+                                   512 * 64, [&]
+            {
+                for (int b = 0; b < 64; ++b)
+                {
+                    buffer.makeCopyOf (input, true);
+                    er.processBlock (buffer);
+                }
+            });
+
+            report ("  relative cost vs LateReverb", erCost / lateCost, "x");
+        }
+    }
+};
+
+static ModulationBenchmarks modulationBenchmarks;
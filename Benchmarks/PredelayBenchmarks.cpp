@@ -0,0 +1,105 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "../Source/DSP/DelayLine.h"
+#include "../Source/DSP/Predelay.h"
+
+class PredelayBenchmarks : public Benchmark
+{
+public:
+    PredelayBenchmarks() : Benchmark ("Predelay: per-sample DelayLine pair vs copy-based Predelay") {}
+
+    void run() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 64;
+        constexpr float delayMs = 37.0f;
+
+        juce::AudioBuffer<float> input (2, blockSize), early (2, blockSize), late (2, blockSize);
+        juce::Random rng (1);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+
+        const float* inL = input.getReadPointer (0);
+        const float* inR = input.getReadPointer (1);
+        float* eL = early.getWritePointer (0);
+        float* eR = early.getWritePointer (1);
+        float* lL = late.getWritePointer (0);
+        float* lR = late.getWritePointer (1);
+
+        // What the engine did before: push and interpolated read per sample, then a copy for the late path
+        DSP::DelayLine lineL, lineR;
+        lineL.prepare (sampleRate, 1000.0);
+        lineR.prepare (sampleRate, 1000.0);
+
+        auto delayLineCost = measure ("2 x DelayLine push + read, plus late copy", blockSize * numBlocks, [&]
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    lineL.push (inL[i]);
+                    lineR.push (inR[i]);
+                    eL[i] = lineL.read (delayMs);
+                    eR[i] = lineR.read (delayMs);
+                }
+                std::copy (eL, eL + blockSize, lL);
+                std::copy (eR, eR + blockSize, lR);
+            }
+            benchmarkSink (lL[0]);
+        });
+
+        DSP::Predelay predelay;
+        predelay.prepare (sampleRate, 1000.0, blockSize);
+        predelay.setDelayMs (delayMs);
+        predelay.reset();
+
+        auto predelayCost = measure ("Predelay write + 2 reads, at rest", blockSize * numBlocks, [&]
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                predelay.write (inL, inR, blockSize);
+                predelay.read (eL, eR, blockSize);
+                predelay.read (lL, lR, blockSize);
+            }
+            benchmarkSink (lL[0]);
+        });
+
+        report ("  relative cost vs DelayLine pair", predelayCost / delayLineCost, "x");
+
+        // Sweeps between two delays, so every block is part of a glide
+        int step = 0;
+        auto glideCost = measure ("Predelay write + 2 reads, gliding", blockSize * numBlocks, [&]
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                if (! predelay.isGliding())
+                    predelay.setDelayMs ((++step & 1) != 0 ? 120.0f : delayMs);
+
+                predelay.write (inL, inR, blockSize);
+                predelay.read (eL, eR, blockSize);
+                predelay.read (lL, lR, blockSize);
+            }
+            benchmarkSink (lL[0]);
+        });
+
+        report ("  relative cost vs DelayLine pair", glideCost / delayLineCost, "x");
+
+        // The floor: the same three block copies with no ring at all
+        auto copyCost = measure ("3 x stereo block copy (memcpy floor)", blockSize * numBlocks, [&]
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                early.makeCopyOf (input, true);
+                late.makeCopyOf (input, true);
+                late.makeCopyOf (early, true);
+            }
+            benchmarkSink (lL[0]);
+        });
+
+        report ("  Predelay at rest vs memcpy floor", predelayCost / copyCost, "x");
+    }
+};
+
+static PredelayBenchmarks predelayBenchmarks;
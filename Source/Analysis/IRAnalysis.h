@@ -0,0 +1,206 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include <cmath>
+
+/**
+ * @brief Offline impulse-response measurements, shared by the analysis tool and the benchmarks.
+ * Not used on the audio thread: everything here allocates freely and works on whole IRs.
+ */
+namespace Analysis
+{
+    //==============================================================================
+    /**
+     * @brief Normalised echo density (Abel & Huang) in a window of windowS centred on timeS.
+     * The fraction of samples outside one standard deviation, relative to a Gaussian's; 1 = fully mixed.
+     */
+    inline double echoDensityAt(const std::vector<float>& ir, double sampleRate, double timeS, double windowS = 0.02)
+    {
+        const int half = juce::jmax(1, (int)(0.5 * windowS * sampleRate));
+        const int centre = (int)(timeS * sampleRate);
+        const int begin = juce::jmax(0, centre - half);
+        const int end = juce::jmin((int)ir.size(), centre + half);
+
+        if (end <= begin)
+            return 0.0;
+
+        double energy = 0.0;
+        for (int i = begin; i < end; ++i)
+            energy += (double)ir[(size_t)i] * ir[(size_t)i];
+
+        const double sigma = std::sqrt(energy / (end - begin));
+        if (sigma <= 0.0)
+            return 0.0;
+
+        int outside = 0;
+        for (int i = begin; i < end; ++i)
+            if (std::abs(ir[(size_t)i]) > sigma)
+                ++outside;
+
+        return ((double)outside / (end - begin)) / std::erfc(1.0 / std::sqrt(2.0));
+    }
+
+    /** Echo density every stepS seconds, from the start to the end of the IR. */
+    inline std::vector<double> echoDensityProfile(const std::vector<float>& ir, double sampleRate, double stepS = 0.01)
+    {
+        std::vector<double> profile;
+        const double lengthS = (double)ir.size() / sampleRate;
+
+        for (double t = 0.0; t < lengthS; t += stepS)
+            profile.push_back(echoDensityAt(ir, sampleRate, t));
+
+        return profile;
+    }
+
+    /** First time (in ms) the echo density reaches threshold, or the IR length if it never does. */
+    inline double mixingTimeMs(const std::vector<float>& ir, double sampleRate, double threshold = 0.9)
+    {
+        const double lengthS = (double)ir.size() / sampleRate;
+
+        for (double t = 0.01; t < lengthS - 0.01; t += 0.001)
+            if (echoDensityAt(ir, sampleRate, t) >= threshold)
+                return t * 1000.0;
+
+        return lengthS * 1000.0;
+    }
+
+    //==============================================================================
+    /** Schroeder backward-integrated energy decay curve, in dB relative to the total energy. */
+    inline std::vector<float> schroederDecayDb(const std::vector<float>& ir)
+    {
+        std::vector<float> edc(ir.size());
+        double remaining = 0.0;
+
+        for (size_t i = ir.size(); i-- > 0;)
+        {
+            remaining += (double)ir[i] * ir[i];
+            edc[i] = (float)remaining;
+        }
+
+        const double total = juce::jmax(1.0e-30, (double)(edc.empty() ? 0.0f : edc[0]));
+        for (auto& v : edc)
+            v = (float)(10.0 * std::log10(juce::jmax(1.0e-30, (double)v / total)));
+
+        return edc;
+    }
+
+    /**
+     * @brief T60 in seconds from a least-squares line through the decay curve between -5 dB and
+     * -35 dB (T30), or -5 / -25 dB (T20) when the curve does not reach -35 dB. 0 if neither is reached.
+     */
+    inline double t60FromDecay(const std::vector<float>& edcDb, double sampleRate)
+    {
+        for (float endDb : { -35.0f, -25.0f })
+        {
+            int begin = -1, end = -1;
+
+            for (size_t i = 0; i < edcDb.size(); ++i)
+            {
+                if (begin < 0 && edcDb[i] <= -5.0f) begin = (int)i;
+                if (edcDb[i] <= endDb) { end = (int)i; break; }
+            }
+
+            if (begin < 0 || end <= begin + 1)
+                continue;
+
+            // Regression of level (dB) over time (s)
+            double sx = 0, sy = 0, sxx = 0, sxy = 0;
+            const int n = end - begin;
+
+            for (int i = begin; i < end; ++i)
+            {
+                double x = i / sampleRate, y = edcDb[(size_t)i];
+                sx += x; sy += y; sxx += x * x; sxy += x * y;
+            }
+
+            double slope = (n * sxy - sx * sy) / juce::jmax(1.0e-30, n * sxx - sx * sx);
+            return slope < 0.0 ? -60.0 / slope : 0.0;
+        }
+
+        return 0.0;
+    }
+
+    inline double t60(const std::vector<float>& ir, double sampleRate)
+    {
+        return t60FromDecay(schroederDecayDb(ir), sampleRate);
+    }
+
+    //==============================================================================
+    inline constexpr std::array<float, 8> octaveCentres { 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f, 16000.0f };
+
+    /** The IR band-passed around one octave centre (RBJ band-pass, one octave wide, run forwards and backwards). */
+    inline std::vector<float> octaveBand(const std::vector<float>& ir, double sampleRate, float centreHz)
+    {
+        const double w0 = juce::MathConstants<double>::twoPi * centreHz / sampleRate;
+        const double alpha = std::sin(w0) * std::sinh(std::log(2.0) / 2.0 * w0 / std::sin(w0)); // One octave
+        const double a0 = 1.0 + alpha;
+        const double b0 = alpha / a0, b2 = -alpha / a0;
+        const double a1 = -2.0 * std::cos(w0) / a0, a2 = (1.0 - alpha) / a0;
+
+        std::vector<float> band(ir);
+
+        // Zero phase, so the decay start is not smeared by the filter delay
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+
+            for (size_t k = 0; k < band.size(); ++k)
+            {
+                size_t i = pass == 0 ? k : band.size() - 1 - k;
+                double x = band[i];
+                double y = b0 * x + b2 * x2 - a1 * y1 - a2 * y2;
+                x2 = x1; x1 = x; y2 = y1; y1 = y;
+                band[i] = (float)y;
+            }
+        }
+
+        return band;
+    }
+
+    /** T60 per octave band (octaveCentres); bands at or above Nyquist/2 are reported as 0. */
+    inline std::array<double, octaveCentres.size()> octaveT60(const std::vector<float>& ir, double sampleRate)
+    {
+        std::array<double, octaveCentres.size()> result {};
+
+        for (size_t b = 0; b < octaveCentres.size(); ++b)
+            if (octaveCentres[b] < sampleRate * 0.25)
+                result[b] = t60(octaveBand(ir, sampleRate, octaveCentres[b]), sampleRate);
+
+        return result;
+    }
+
+    //==============================================================================
+    /**
+     * @brief Spectral flatness (geometric / arithmetic mean of the power spectrum) between loHz and hiHz.
+     * 1 = white, lower values mean colouration (peaks / notches). Uses at most the first 2^18 samples.
+     */
+    inline double spectralFlatness(const std::vector<float>& ir, double sampleRate, double loHz = 50.0, double hiHz = 15000.0)
+    {
+        int order = 1;
+        while ((1 << order) < (int)ir.size() && order < 18)
+            ++order;
+
+        juce::dsp::FFT fft(order);
+        const int size = fft.getSize();
+        std::vector<float> data((size_t)(2 * size), 0.0f);
+        std::copy_n(ir.begin(), juce::jmin((int)ir.size(), size), data.begin());
+
+        fft.performFrequencyOnlyForwardTransform(data.data(), true);
+
+        const int first = juce::jmax(1, (int)(loHz * size / sampleRate));
+        const int last = juce::jmin(size / 2, (int)(hiHz * size / sampleRate));
+
+        double logSum = 0.0, sum = 0.0;
+        for (int k = first; k <= last; ++k)
+        {
+            double power = juce::jmax(1.0e-20, (double)data[(size_t)k] * data[(size_t)k]);
+            logSum += std::log(power);
+            sum += power;
+        }
+
+        const int n = juce::jmax(1, last - first + 1);
+        return sum > 0.0 ? std::exp(logSum / n) / (sum / n) : 0.0;
+    }
+}
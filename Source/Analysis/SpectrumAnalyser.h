@@ -0,0 +1,135 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../DSP/AnalysisFifo.h"
+#include "../DSP/TripleBuffer.h"
+#include <array>
+#include <cmath>
+
+namespace Analysis
+{
+    /** One analysis result: the spectrum of the newest window and the recent level history. */
+    struct SpectrumFrame
+    {
+        static constexpr int fftOrder = 11;
+        static constexpr int fftSize = 1 << fftOrder;
+        static constexpr int numBins = fftSize / 2;
+        static constexpr int levelHistorySize = 256;    // Hops, about 2.7 s at 48 kHz
+
+        std::array<float, numBins> magnitudeDb {};      // Relative to a full-scale sine
+        std::array<float, levelHistorySize> levelDb {}; // RMS per hop, oldest first
+        double sampleRate = 44100.0;
+        juce::uint32 serial = 0;
+    };
+
+    /**
+     * @brief Live spectrum / decay analysis of the wet output on a background thread.
+     *
+     * Reads the processor's AnalysisFifo, runs a Hann-windowed FFT every hopSize samples and publishes
+     * each frame through a triple buffer, so the display never waits and never sees a torn frame.
+     * The thread lives exactly as long as the analyser, and the FIFO only receives audio meanwhile.
+     * If another analyser already reads the FIFO, this one stays idle and never publishes.
+     */
+    class SpectrumAnalyser : private juce::Thread
+    {
+    public:
+        static constexpr int hopSize = 512;
+        static constexpr float floorDb = -100.0f;
+
+        explicit SpectrumAnalyser(DSP::AnalysisFifo& source)
+            : juce::Thread("Antigrav Spectrum Analyser"), fifo(source), fft(SpectrumFrame::fftOrder)
+        {
+            for (int i = 0; i < SpectrumFrame::fftSize; ++i)
+                window[(size_t)i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)i / (float)SpectrumFrame::fftSize);
+
+            levels.fill(floorDb);
+
+            if (! fifo.claimReader())
+                return;
+
+            // Whatever was queued before this analyser existed is stale (no reader runs yet)
+            fifo.discard();
+            ownsReader = true;
+            startThread(juce::Thread::Priority::low);
+        }
+
+        ~SpectrumAnalyser() override
+        {
+            stopThread(1000);
+
+            if (ownsReader)
+                fifo.releaseReader();
+        }
+
+        bool isRunning() const { return ownsReader; }
+
+        /** Consumer (message thread): newest frame not seen yet, or nullptr. Valid until the next call. */
+        const SpectrumFrame* acquireFrame() { return frames.acquire(); }
+
+        juce::uint32 getNumFramesAnalysed() const { return framesAnalysed.load(std::memory_order_relaxed); }
+
+    private:
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                if (fifo.popMid(hop.data(), hopSize))
+                    analyseHop();
+                else
+                    wait(5);
+            }
+        }
+
+        void analyseHop()
+        {
+            constexpr int size = SpectrumFrame::fftSize;
+
+            // Slide the window by one hop
+            std::copy(history.begin() + hopSize, history.end(), history.begin());
+            std::copy(hop.begin(), hop.end(), history.end() - hopSize);
+
+            for (int i = 0; i < size; ++i)
+                fftData[(size_t)i] = history[(size_t)i] * window[(size_t)i];
+            std::fill(fftData.begin() + size, fftData.end(), 0.0f);
+
+            fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+            double energy = 0.0;
+            for (auto x : hop)
+                energy += (double)x * x;
+
+            std::copy(levels.begin() + 1, levels.end(), levels.begin());
+            levels.back() = toDb((float)std::sqrt(energy / hopSize));
+
+            auto& frame = frames.getWriteSlot();
+
+            // A full-scale sine peaks at size / 4 through the Hann window
+            const float norm = 4.0f / (float)size;
+            for (int k = 0; k < SpectrumFrame::numBins; ++k)
+                frame.magnitudeDb[(size_t)k] = toDb(fftData[(size_t)k] * norm);
+
+            frame.levelDb = levels;
+            frame.sampleRate = fifo.getSampleRate();
+            frame.serial = framesAnalysed.fetch_add(1, std::memory_order_relaxed) + 1;
+            frames.publish();
+        }
+
+        static float toDb(float gain)
+        {
+            return gain > 0.0f ? juce::jmax(floorDb, 20.0f * std::log10(gain)) : floorDb;
+        }
+
+        DSP::AnalysisFifo& fifo;
+        bool ownsReader = false;
+        juce::dsp::FFT fft;
+
+        std::array<float, SpectrumFrame::fftSize> window {};
+        std::array<float, SpectrumFrame::fftSize> history {};
+        std::array<float, 2 * SpectrumFrame::fftSize> fftData {};
+        std::array<float, hopSize> hop {};
+        std::array<float, SpectrumFrame::levelHistorySize> levels {};
+
+        DSP::TripleBuffer<SpectrumFrame> frames;
+        std::atomic<juce::uint32> framesAnalysed { 0 };
+    };
+}
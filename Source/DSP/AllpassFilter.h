@@ -22,6 +22,17 @@ namespace DSP
             this->delayMs = (float)ms;
         }
 
+        /** Changes the delay time without touching the buffer. Must not exceed the prepared maximum. */
+        void setDelay(float ms)
+        {
+            delayMs = ms;
+        }
+
+        void reset()
+        {
+            delay.reset();
+        }
+
         void setFeedback(float g)
         {
             feedback = g;
@@ -44,6 +55,8 @@ namespace DSP
             return output;
         }
 
+        size_t getMemorySize() const { return delay.getMemorySize(); }
+
     private:
         DelayLine delay;
         float delayMs = 0.0f;
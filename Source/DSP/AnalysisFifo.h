@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+namespace DSP
+{
+    /**
+     * @brief Lock-free single-producer / single-consumer stereo sample FIFO from the audio thread
+     * to an analysis thread.
+     *
+     * Storage is allocated once in the constructor and never resized, so the reader may run across
+     * prepareToPlay(). The writer only copies (at most two memcpys per channel) and drops what does
+     * not fit; nothing is copied at all while no reader is active.
+     */
+    class AnalysisFifo
+    {
+    public:
+        static constexpr int defaultCapacity = 1 << 15;
+
+        explicit AnalysisFifo(int capacity = defaultCapacity)
+            : fifo(capacity), buffer(2, capacity)
+        {
+            buffer.clear();
+        }
+
+        /**
+         * Reader side: there is one reader at a time, so a second analyser (another editor of the same
+         * processor) gets false and must not read. The writer skips the copy while nobody holds the FIFO.
+         */
+        bool claimReader() { return ! active.exchange(true, std::memory_order_acq_rel); }
+        void releaseReader() { active.store(false, std::memory_order_release); }
+        bool isActive() const { return active.load(std::memory_order_acquire); }
+
+        void setSampleRate(double sr) { sampleRate.store(sr, std::memory_order_release); }
+        double getSampleRate() const { return sampleRate.load(std::memory_order_acquire); }
+
+        /** Audio thread. Returns the number of frames written; the rest is dropped when the reader lags. */
+        int push(const float* left, const float* right, int numSamples)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+            if (size1 > 0)
+            {
+                std::copy(left, left + size1, buffer.getWritePointer(0, start1));
+                std::copy(right, right + size1, buffer.getWritePointer(1, start1));
+            }
+
+            if (size2 > 0)
+            {
+                std::copy(left + size1, left + size1 + size2, buffer.getWritePointer(0, start2));
+                std::copy(right + size1, right + size1 + size2, buffer.getWritePointer(1, start2));
+            }
+
+            fifo.finishedWrite(size1 + size2);
+            return size1 + size2;
+        }
+
+        int getNumReady() const { return fifo.getNumReady(); }
+
+        /** Analysis thread: reads numSamples (if available) as the mid signal (L + R) / 2. */
+        bool popMid(float* destination, int numSamples)
+        {
+            if (fifo.getNumReady() < numSamples)
+                return false;
+
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+            mix(destination, start1, size1);
+            mix(destination + size1, start2, size2);
+
+            fifo.finishedRead(size1 + size2);
+            return true;
+        }
+
+        /** Analysis thread: throws away everything queued, e.g. stale audio from before a restart. */
+        void discard()
+        {
+            fifo.finishedRead(fifo.getNumReady());
+        }
+
+    private:
+        void mix(float* destination, int start, int numSamples) const
+        {
+            const float* l = buffer.getReadPointer(0, start);
+            const float* r = buffer.getReadPointer(1, start);
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = 0.5f * (l[i] + r[i]);
+        }
+
+        juce::AbstractFifo fifo;
+        juce::AudioBuffer<float> buffer;
+        std::atomic<bool> active { false };
+        std::atomic<double> sampleRate { 44100.0 };
+    };
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterEventQueue.h"
+#include <array>
+
+namespace DSP
+{
+    /**
+     * @brief Splits a block into sub-blocks at parameter change points.
+     *
+     * Step events take effect exactly at their sample offset. Ramp events (block-rate host
+     * automation) are spread linearly over the block in sub-blocks of rampGranularity samples,
+     * so automation resolution no longer depends on the host block size. The render callback
+     * only runs per segment, which is where settings/coefficients should be recomputed.
+     */
+    template <int NumParameters>
+    class AutomationScheduler
+    {
+    public:
+        static constexpr int maxEventsPerBlock = 256;
+        static constexpr int defaultRampGranularity = 64;
+
+        AutomationScheduler() = default;
+
+        /** Sets the current values (e.g. after prepare or a preset load), cancelling ramps and pending events. */
+        void reset(const float* initialValues)
+        {
+            std::copy(initialValues, initialValues + NumParameters, values.begin());
+            ramps.fill({});
+            numEvents = 0;
+            numRamping = 0;
+        }
+
+        void setRampGranularity(int samples) { rampGranularity = juce::jmax(1, samples); }
+
+        /** Queues an event for the next process() call. Returns false if the block is already full of events. */
+        bool addEvent(const ParameterEvent& event)
+        {
+            if (numEvents >= maxEventsPerBlock || ! juce::isPositiveAndBelow(event.index, NumParameters))
+                return false;
+
+            // Insertion keeps the list sorted by offset, and stable for equal offsets
+            int i = numEvents++;
+            while (i > 0 && events[(size_t)(i - 1)].sampleOffset > event.sampleOffset)
+            {
+                events[(size_t)i] = events[(size_t)(i - 1)];
+                --i;
+            }
+            events[(size_t)i] = event;
+            return true;
+        }
+
+        const float* getValues() const { return values.data(); }
+
+        /**
+         * @brief Runs render(const float* values, int startSample, int numSamples) once per segment.
+         * Ramping values are those reached at the end of each segment, so the target is hit on the last one.
+         */
+        template <typename RenderFn>
+        void process(int numSamples, RenderFn&& render)
+        {
+            int pos = 0;
+            int next = 0;
+
+            while (pos < numSamples)
+            {
+                while (next < numEvents && events[(size_t)next].sampleOffset <= pos)
+                    apply(events[(size_t)next++], pos, numSamples);
+
+                int end = numSamples;
+                if (next < numEvents)
+                    end = juce::jmin(end, events[(size_t)next].sampleOffset);
+                if (numRamping > 0)
+                    end = juce::jmin(end, pos + rampGranularity);
+
+                if (numRamping > 0)
+                    advanceRamps(end);
+
+                render(values.data(), pos, end - pos);
+                pos = end;
+            }
+
+            // Events past the end of the block (bad offsets) still land
+            while (next < numEvents)
+                apply(events[(size_t)next++], numSamples, numSamples);
+
+            numEvents = 0;
+        }
+
+    private:
+        struct Ramp
+        {
+            bool active = false;
+            float from = 0.0f, to = 0.0f;
+            int start = 0, end = 0;
+        };
+
+        void apply(const ParameterEvent& e, int pos, int blockEnd)
+        {
+            auto& ramp = ramps[(size_t)e.index];
+
+            if (ramp.active)
+            {
+                ramp.active = false;
+                --numRamping;
+            }
+
+            if (e.ramp && blockEnd > pos && e.value != values[(size_t)e.index])
+            {
+                ramp = { true, values[(size_t)e.index], e.value, pos, blockEnd };
+                ++numRamping;
+            }
+            else
+            {
+                values[(size_t)e.index] = e.value;
+            }
+        }
+
+        void advanceRamps(int segmentEnd)
+        {
+            for (int i = 0; i < NumParameters; ++i)
+            {
+                auto& ramp = ramps[(size_t)i];
+                if (! ramp.active)
+                    continue;
+
+                float t = (float)(segmentEnd - ramp.start) / (float)(ramp.end - ramp.start);
+                values[(size_t)i] = ramp.from + (ramp.to - ramp.from) * t;
+
+                if (segmentEnd >= ramp.end)
+                {
+                    values[(size_t)i] = ramp.to;
+                    ramp.active = false;
+                    --numRamping;
+                }
+            }
+        }
+
+        std::array<float, (size_t)NumParameters> values {};
+        std::array<Ramp, (size_t)NumParameters> ramps {};
+        int numRamping = 0;
+        int rampGranularity = defaultRampGranularity;
+
+        std::array<ParameterEvent, maxEventsPerBlock> events {};
+        int numEvents = 0;
+    };
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LFO.h"
+#include "ModulationBank.h"
+#include "DampingFilterBank.h"
+#include <array>
+#include <vector>
+
+namespace DSP
+{
+    /**
+     * @brief NumVoices independent late reverb tanks (same topology as LateReverb) run side by side.
+     *
+     * Every piece of state is stored structure-of-arrays with the voice as the innermost index:
+     * delay memory is interleaved per time step ([time][voice]), LFO lanes, filter states and
+     * coefficients are [line][voice]. Each step of the FDN is then one loop over the voices,
+     * which the compiler maps onto SIMD lanes (4, 8 or 16 voices per register). Only the
+     * modulated delay reads are gathers, since every voice reads at its own position.
+     *
+     * Voices share the waveform of the modulation, everything else is per voice. Input diffusion
+     * is not part of the batch; run a DiffusionCascade per voice ahead of it where needed.
+     */
+    template <int NumVoices>
+    class BatchedLateReverb
+    {
+    public:
+        static constexpr int numLines = 8;
+        static constexpr int numVoices = NumVoices;
+
+        BatchedLateReverb() = default;
+
+        void prepare(double sr)
+        {
+            sampleRate = sr;
+
+            // Same 200 ms headroom as LateReverb, rounded up so the ring can wrap with a mask
+            int length = juce::nextPowerOfTwo((int)std::ceil(200.0 * sr / 1000.0) + 1);
+            mask = length - 1;
+
+            for (auto& line : delayBuffers)
+                line.assign((size_t)length * NumVoices, 0.0f);
+
+            modulation.prepare(sr);
+
+            for (int v = 0; v < NumVoices; ++v)
+                setParameters(v, 2.0f, 0.0f, 0.5f, 6000.0f, 20.0f);
+
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& line : delayBuffers)
+                std::fill(line.begin(), line.end(), 0.0f);
+
+            for (auto& bank : damping)
+                bank.reset();
+
+            modulation.reset();
+            writeIndex = 0;
+        }
+
+        /** Same mapping as LateReverb::setParameters, for a single voice. */
+        void setParameters(int voice, float decayTimeS, float modDepth, float modRate, float hiCut, float loCut)
+        {
+            jassert(juce::isPositiveAndBelow(voice, NumVoices));
+
+            float avgDelayMs = 60.0f;
+            feedbackGain[(size_t)voice] = std::pow(0.001f, (avgDelayMs / 1000.0f) / decayTimeS);
+
+            DampingResponse response;
+            response.hiCutHz = hiCut;
+            response.loCutHz = loCut;
+            for (auto& bank : damping)
+                bank.setLane(voice, sampleRate, response);
+
+            // The longest line plus 3 ms of swing stays inside the 200 ms ring
+            modDepth = juce::jlimit(0.0f, 1.0f, modDepth);
+
+            for (int i = 0; i < numLines; ++i)
+            {
+                modulation.setFrequency(lane(i, voice), modRate * (0.9f + 0.02f * i));
+                modulation.setDepth(lane(i, voice), modDepth * 3.0f);
+            }
+        }
+
+        void setModulationShape(LFO::Waveform shape) { modulation.setWaveform(shape); }
+
+        /**
+         * @brief Renders numSamples for every voice.
+         * Each argument holds one pointer per voice; outputs may alias the inputs.
+         */
+        void process(const float* const* inL, const float* const* inR,
+                     float* const* outL, float* const* outR, int numSamples)
+        {
+            constexpr int numLanes = numLines * NumVoices;
+            const float msToSamples = (float)sampleRate / 1000.0f;
+            const float size = (float)(mask + 1);
+
+            alignas(64) float modOffsets[numLanes];
+            const float* modIncrements = modulation.getIncrements();
+            int segmentLeft = 0;
+
+            for (int n = 0; n < numSamples; ++n)
+            {
+                if (segmentLeft == 0)
+                {
+                    if (modulation.getSamplesUntilTick() == 0)
+                        modulation.tick();
+
+                    segmentLeft = juce::jmin(modulation.getSamplesUntilTick(), numSamples - n);
+                    std::copy(modulation.getValues(), modulation.getValues() + numLanes, modOffsets);
+                    modulation.advance(segmentLeft);
+                }
+
+                --segmentLeft;
+
+                alignas(64) float injectL[NumVoices], injectR[NumVoices];
+                for (int v = 0; v < NumVoices; ++v)
+                {
+                    injectL[v] = inL[v][n];
+                    injectR[v] = inR[v][n];
+                }
+
+                // Modulated reads, one gather per line
+                alignas(64) float delayOuts[numLines][NumVoices];
+                for (int i = 0; i < numLines; ++i)
+                {
+                    const float* __restrict buf = delayBuffers[(size_t)i].data();
+                    const float* __restrict offsets = modOffsets + i * NumVoices;
+
+                    for (int v = 0; v < NumVoices; ++v)
+                    {
+                        float readPos = (float)writeIndex - (nominalDelayMs[i] + offsets[v]) * msToSamples;
+                        readPos += readPos < 0.0f ? size : 0.0f;
+
+                        // readPos may round up to exactly size, which wraps to 0
+                        const int whole = (int)readPos;
+                        const int index1 = whole & mask;
+                        const int index2 = (whole + 1) & mask;
+                        const float frac = readPos - (float)whole;
+
+                        float a = buf[index1 * NumVoices + v];
+                        float b = buf[index2 * NumVoices + v];
+                        delayOuts[i][v] = a + frac * (b - a);
+                    }
+                }
+
+                for (int i = 0; i < numLanes; ++i)
+                    modOffsets[i] += modIncrements[i];
+
+                // Householder feedback
+                alignas(64) float sum[NumVoices] = {};
+                for (int i = 0; i < numLines; ++i)
+                    for (int v = 0; v < NumVoices; ++v)
+                        sum[v] += delayOuts[i][v];
+
+                for (int v = 0; v < NumVoices; ++v)
+                    sum[v] *= (2.0f / 8.0f);
+
+                for (int i = 0; i < numLines; ++i)
+                {
+                    const float* injection = i < numLines / 2 ? injectL : injectR;
+                    float* __restrict dst = delayBuffers[(size_t)i].data() + writeIndex * NumVoices;
+
+                    for (int v = 0; v < NumVoices; ++v)
+                        dst[v] = injection[v] + (delayOuts[i][v] - sum[v]) * feedbackGain[(size_t)v];
+
+                    // Hi cut and lo cut, the same DampingFilterBank as LateReverb with voices as lanes
+                    damping[(size_t)i].process(dst);
+                }
+
+                writeIndex = (writeIndex + 1) & mask;
+
+                for (int v = 0; v < NumVoices; ++v)
+                {
+                    outL[v][n] = (delayOuts[0][v] + delayOuts[1][v] + delayOuts[2][v] + delayOuts[3][v]) * 0.3f;
+                    outR[v][n] = (delayOuts[4][v] + delayOuts[5][v] + delayOuts[6][v] + delayOuts[7][v]) * 0.3f;
+                }
+            }
+        }
+
+    private:
+        static size_t lane(int line, int voice) { return (size_t)(line * NumVoices + voice); }
+
+        using VoiceArray = std::array<float, (size_t)NumVoices>;
+
+        static constexpr float nominalDelayMs[numLines] = { 29.1f, 37.3f, 44.9f, 53.7f, 61.3f, 79.1f, 88.7f, 97.1f };
+
+        double sampleRate = 44100.0;
+        int mask = 0;
+        int writeIndex = 0;
+
+        std::array<std::vector<float>, numLines> delayBuffers;   // [time][voice] per line
+        ModulationBank<(size_t)(numLines * NumVoices)> modulation; // lane = line * NumVoices + voice
+
+        alignas(64) VoiceArray feedbackGain {};
+        std::array<DampingFilterBank<NumVoices>, numLines> damping; // Lane = voice
+    };
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace DSP
+{
+    /**
+     * @brief Decouples the engine's block size from the host's.
+     *
+     * Input is collected into a fixed internal block; once it is full the render callback runs on
+     * it, and the result is played out over the following host callbacks. The output is delayed
+     * by exactly one internal block, which the processor reports as latency. With tiny host buffers
+     * (16 - 32 samples) the per-block overhead is then paid once per internal block only.
+     */
+    class BlockAdapter
+    {
+    public:
+        BlockAdapter() = default;
+
+        static constexpr int maxBlockSize = 1024;
+
+        /** Allocates for the largest internal block, so setBlockSize() never allocates. */
+        void prepare()
+        {
+            inBuf.setSize(2, maxBlockSize);
+            outBuf.setSize(2, maxBlockSize);
+            reset();
+        }
+
+        void reset()
+        {
+            inBuf.clear();
+            outBuf.clear();
+            position = 0;
+        }
+
+        /** 0 disables the adapter (zero latency, the callback runs on the host blocks). */
+        void setBlockSize(int blockSize)
+        {
+            blockSize = juce::jlimit(0, maxBlockSize, blockSize);
+
+            if (blockSize != internalBlock)
+            {
+                internalBlock = blockSize;
+                reset();
+            }
+        }
+
+        bool isEnabled() const { return internalBlock > 0; }
+        int getLatencySamples() const { return internalBlock; }
+
+        /**
+         * @brief Processes a host block in place; right is nullptr for a mono output.
+         * render(float* left, float* right, int numSamples) is called on whole internal blocks only,
+         * with right nullptr again in mono.
+         */
+        template <typename RenderFn>
+        void process(float* left, float* right, int numSamples, RenderFn&& render)
+        {
+            if (! isEnabled())
+            {
+                render(left, right, numSamples);
+                return;
+            }
+
+            int done = 0;
+            while (done < numSamples)
+            {
+                int n = juce::jmin(numSamples - done, internalBlock - position);
+
+                // Swap in the new input, play out what was rendered one block ago
+                inBuf.copyFrom(0, position, left + done, n);
+                juce::FloatVectorOperations::copy(left + done, outBuf.getReadPointer(0, position), n);
+
+                if (right != nullptr)
+                {
+                    inBuf.copyFrom(1, position, right + done, n);
+                    juce::FloatVectorOperations::copy(right + done, outBuf.getReadPointer(1, position), n);
+                }
+
+                position += n;
+                done += n;
+
+                if (position == internalBlock)
+                {
+                    outBuf.copyFrom(0, 0, inBuf, 0, 0, internalBlock);
+                    if (right != nullptr)
+                        outBuf.copyFrom(1, 0, inBuf, 1, 0, internalBlock);
+
+                    render(outBuf.getWritePointer(0), right != nullptr ? outBuf.getWritePointer(1) : nullptr, internalBlock);
+                    position = 0;
+                }
+            }
+        }
+
+    private:
+        int internalBlock = 0;
+        int position = 0;
+        juce::AudioBuffer<float> inBuf;
+        juce::AudioBuffer<float> outBuf;
+    };
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ * Kernels are compiled once per instruction set in the same translation unit, with the target
+ * attribute of GCC and Clang. The wrappers carry the attribute; the kernel templates they call are
+ * force-inlined, so their bodies are generated for that instruction set too. MSVC and non-x86
+ * builds only have the baseline (SSE2 on x86-64, NEON on AArch64, where it is part of the ABI).
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+ #define ANTIGRAV_X86_DISPATCH 1
+ #define ANTIGRAV_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+ #define ANTIGRAV_TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx512dq,avx512bw,avx2,fma,f16c")))
+#else
+ #define ANTIGRAV_X86_DISPATCH 0
+#endif
+
+namespace DSP
+{
+    /** Kernel variants, in increasing order of what they need from the CPU. */
+    enum class Isa { baseline = 0, avx2, avx512 };
+
+    namespace CpuDispatch
+    {
+        /** "sse2" / "neon" / "generic" for the baseline, depending on the build's architecture. */
+        inline const char* getName(Isa isa)
+        {
+            switch (isa)
+            {
+                case Isa::avx2:   return "avx2";
+                case Isa::avx512: return "avx512";
+                case Isa::baseline: break;
+            }
+
+           #if JUCE_INTEL
+            return "sse2";
+           #elif JUCE_ARM && defined(__aarch64__)
+            return "neon";
+           #else
+            return "generic";
+           #endif
+        }
+
+        /** Accepts any baseline name as well as "avx2" and "avx512"; unknown names give baseline. */
+        inline Isa fromName(const juce::String& name)
+        {
+            const auto n = name.trim().toLowerCase();
+            if (n == "avx512") return Isa::avx512;
+            if (n == "avx2")   return Isa::avx2;
+            return Isa::baseline;
+        }
+
+        /** True if this build has the variant and this CPU can run it (AVX2 always comes with F16C). */
+        inline bool isSupported(Isa isa)
+        {
+            switch (isa)
+            {
+                case Isa::baseline:
+                    return true;
+
+               #if ANTIGRAV_X86_DISPATCH
+                case Isa::avx2:
+                    return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+
+                case Isa::avx512:
+                    return isSupported(Isa::avx2) && juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX512VL()
+                        && juce::SystemStats::hasAVX512DQ() && juce::SystemStats::hasAVX512BW();
+               #else
+                case Isa::avx2:
+                case Isa::avx512:
+                    return false;
+               #endif
+            }
+
+            return false;
+        }
+
+        /** The widest variant this CPU runs. */
+        inline Isa getBestSupported()
+        {
+            for (auto isa : { Isa::avx512, Isa::avx2 })
+                if (isSupported(isa))
+                    return isa;
+
+            return Isa::baseline;
+        }
+
+        /**
+         * The variant for a requested name: the best supported one if the name is empty, otherwise
+         * the named one, or the widest variant below it when the CPU cannot run that.
+         */
+        inline Isa select(const juce::String& requested)
+        {
+            if (requested.isEmpty())
+                return getBestSupported();
+
+            auto isa = fromName(requested);
+            while (! isSupported(isa))
+                isa = (Isa)((int)isa - 1);
+
+            return isa;
+        }
+
+        /**
+         * The variant to run: the best supported one, or whatever the ANTIGRAV_ISA environment
+         * variable asks for (e.g. ANTIGRAV_ISA=sse2 to test the baseline on an AVX-512 machine).
+         */
+        inline Isa select()
+        {
+            return select(juce::SystemStats::getEnvironmentVariable("ANTIGRAV_ISA", {}));
+        }
+    }
+}
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReverbEngine.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+
+namespace DSP
+{
+    /**
+     * @brief Two ReverbEngines with an equal-power crossfade between them.
+     *
+     * Preset switches (beginTransition) copy the running tank into the standby engine and fade to it.
+     * Large jumps of the coefficient/tap parameters (size, decay, cut-offs) and early engine switches
+     * coming in through setSettings() copy it too, so the tail rings on whatever its length; the
+     * standby then runs alongside on the live input for a warm-up (new filter states settle, a new
+     * early generator fills) before it is faded in. Both engines are allocated in prepare().
+     *
+     * The number of simultaneous transitions across all instances is capped; above the cap,
+     * or for small changes, the jump parameters are smoothed instead.
+     */
+    class CrossfadingEngine
+    {
+    public:
+        CrossfadingEngine() = default;
+
+        ~CrossfadingEngine()
+        {
+            releaseTransitionSlot();
+        }
+
+        /** Process-wide cap on instances warming up or fading at the same time. */
+        static void setMaxConcurrentTransitions(int maxTransitions) { maxConcurrent().store(juce::jmax(0, maxTransitions)); }
+        static int getActiveTransitionCount() { return activeTransitions().load(); }
+
+        void prepare(double sr, int maxBlockSize)
+        {
+            releaseTransitionSlot();
+
+            sampleRate = sr;
+            for (auto& e : engines) e.prepare(sr, maxBlockSize);
+            fadeBuf.setSize(2, engines[0].getMaxBlockSize(), false, false, true);
+
+            warmUpLength = juce::jmax(1, (int)(warmUpMs * 0.001 * sr));
+
+            for (auto* s : { &sizeSmoother, &decaySmoother, &hiCutSmoother, &loCutSmoother })
+                s->reset(sr, smoothingSeconds);
+
+            snapSmoothers(engines[(size_t)active].getSettings());
+            state = State::idle;
+            transitionQueued = false;
+        }
+
+        void reset()
+        {
+            releaseTransitionSlot();
+            for (auto& e : engines) e.reset();
+            snapSmoothers(target);
+            engines[(size_t)active].setSettings(target);
+            state = State::idle;
+            transitionQueued = false;
+        }
+
+        int getMaxBlockSize() const { return engines[0].getMaxBlockSize(); }
+
+        /** Sample format of both engines' late tank lines, applied by the next prepare(). */
+        void setDelayStorage(DelayStorage storage) { for (auto& e : engines) e.setDelayStorage(storage); }
+        DelayStorage getDelayStorage() const { return engines[0].getDelayStorage(); }
+
+        void setAdaptiveDetail(bool shouldAdapt) { for (auto& e : engines) e.setAdaptiveDetail(shouldAdapt); }
+        bool getAdaptiveDetail() const { return engines[0].getAdaptiveDetail(); }
+
+        void setIsa(Isa isa) { for (auto& e : engines) e.setIsa(isa); }
+        Isa getIsa() const { return engines[0].getIsa(); }
+
+        size_t getMemorySize() const
+        {
+            return engines[0].getMemorySize() + engines[1].getMemorySize()
+                 + (size_t)(fadeBuf.getNumChannels() * fadeBuf.getNumSamples()) * sizeof(float);
+        }
+
+        /** Applies settings straight away, without transition or smoothing (e.g. after prepare). */
+        void resetSettings(const ReverbSettings& s)
+        {
+            releaseTransitionSlot();
+            for (auto& e : engines) e.setSettings(s);
+            snapSmoothers(s);
+            state = State::idle;
+            transitionQueued = false;
+        }
+
+        /**
+         * @brief New target settings, called once per block.
+         * Jumps beyond the thresholds trigger a warmed-up crossfade, everything else is applied
+         * directly (or ramped, for the coefficient/tap parameters).
+         */
+        void setSettings(const ReverbSettings& s)
+        {
+            // Nothing to recompute when the host sends the same values again
+            if (s == target)
+                return;
+
+            target = s;
+
+            switch (state)
+            {
+                case State::warmingUp:
+                    // Retarget the engine that is being prepared, the audible one keeps going
+                    engines[(size_t)(1 - active)].setSettings(s);
+                    return;
+
+                case State::idle:
+                    if (isJump(engines[(size_t)active].getSettings(), s) && acquireTransitionSlot())
+                    {
+                        auto& next = engines[(size_t)(1 - active)];
+                        next.copyStateFrom(engines[(size_t)active]);
+                        next.setSettings(s);
+                        warmUpLeft = warmUpLength;
+                        state = State::warmingUp;
+                        return;
+                    }
+                    break;
+
+                case State::fading:
+                    break;
+            }
+
+            rampTo(s);
+        }
+
+        const ReverbSettings& getSettings() const { return engines[(size_t)active].getSettings(); }
+
+        /** ReverbEngine::getSettlingSeconds() of the audible engine, or of both during a transition. */
+        double getSettlingSeconds(float belowDb) const
+        {
+            const double settling = engines[(size_t)active].getSettlingSeconds(belowDb);
+
+            if (state == State::idle)
+                return settling;
+
+            return juce::jmax(settling, engines[(size_t)(1 - active)].getSettlingSeconds(belowDb));
+        }
+
+        bool isTransitioning() const { return state != State::idle; }
+
+        /**
+         * @brief Starts an equal-power crossfade from the current tank to a copy of it with newSettings.
+         * Used for preset switches. Falls back to smoothing when the transition cap is reached.
+         * During a fade the new one is queued and starts from the tank the fade ends on, so the
+         * outgoing tail is never cut off mid-fade; a later call replaces a queued target.
+         */
+        void beginTransition(const ReverbSettings& newSettings, float fadeMs = 50.0f)
+        {
+            target = newSettings;
+
+            if (state == State::fading)
+            {
+                transitionQueued = true;
+                queuedFadeMs = fadeMs;
+                return;
+            }
+
+            if (state == State::idle && ! acquireTransitionSlot())
+            {
+                rampTo(newSettings);
+                return;
+            }
+
+            startTransition(fadeMs);
+        }
+
+        /**
+         * Renders the wet signal, numSamples must not exceed the prepared block size.
+         * Mono sources and outputs pass nullptr for the right channel, see ReverbEngine::process().
+         */
+        void process(const float* inL, const float* inR, float* wetL, float* wetR, int numSamples)
+        {
+            jassert(numSamples <= getMaxBlockSize());
+
+            monoOutput = wetR == nullptr;
+
+            if (state == State::idle)
+            {
+                if (sizeSmoother.isSmoothing() || decaySmoother.isSmoothing()
+                     || hiCutSmoother.isSmoothing() || loCutSmoother.isSmoothing())
+                {
+                    for (auto* s : { &sizeSmoother, &decaySmoother, &hiCutSmoother, &loCutSmoother })
+                        s->skip(numSamples);
+
+                    engines[(size_t)active].setSettings(smoothedSettings());
+                }
+
+                engines[(size_t)active].process(inL, inR, wetL, wetR, numSamples);
+                return;
+            }
+
+            auto* bufL = fadeBuf.getWritePointer(0);
+            auto* bufR = monoOutput ? nullptr : fadeBuf.getWritePointer(1);
+
+            if (state == State::warmingUp)
+            {
+                // The standby keeps pace with the input, unheard; first, as wet may alias the input
+                engines[(size_t)(1 - active)].process(inL, inR, bufL, bufR, numSamples);
+                engines[(size_t)active].process(inL, inR, wetL, wetR, numSamples);
+
+                warmUpLeft -= numSamples;
+                if (warmUpLeft <= 0)
+                    startFade(transitionFadeMs);
+
+                return;
+            }
+
+            auto* oldL = bufL;
+            auto* oldR = bufR;
+
+            // Outgoing engine renders into the fade buffer, so wet may alias the input
+            engines[(size_t)(1 - active)].process(inL, inR, oldL, oldR, numSamples);
+            engines[(size_t)active].process(inL, inR, wetL, wetR, numSamples);
+
+            int fadeSamples = juce::jmin(numSamples, fadeRemaining);
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                wetL[i] = wetL[i] * fadeIn + oldL[i] * fadeOut;
+                if (wetR != nullptr)
+                    wetR[i] = wetR[i] * fadeIn + oldR[i] * fadeOut;
+
+                float c = fadeOut * stepCos - fadeIn * stepSin;
+                fadeIn = fadeIn * stepCos + fadeOut * stepSin;
+                fadeOut = c;
+            }
+
+            fadeRemaining -= fadeSamples;
+
+            if (fadeRemaining <= 0)
+            {
+                state = State::idle;
+
+                // The queued transition keeps the slot
+                if (transitionQueued)
+                    startTransition(queuedFadeMs);
+                else
+                    releaseTransitionSlot();
+            }
+        }
+
+    private:
+        enum class State { idle, warmingUp, fading };
+
+        // Jump thresholds: relative change of taps/decay, frequency ratio of the cut-offs
+        static constexpr float sizeJump = 0.15f;
+        static constexpr float decayJump = 0.3f;
+        static constexpr float cutoffJumpRatio = 1.5f;
+
+        static constexpr double warmUpMs = 100.0;
+        static constexpr float transitionFadeMs = 80.0f;
+        static constexpr double smoothingSeconds = 0.05;
+
+        static std::atomic<int>& activeTransitions() { static std::atomic<int> count { 0 }; return count; }
+        static std::atomic<int>& maxConcurrent() { static std::atomic<int> limit { 8 }; return limit; }
+
+        static bool isJump(const ReverbSettings& from, const ReverbSettings& to)
+        {
+            auto relative = [](float a, float b) { return std::abs(b - a) / juce::jmax(1.0e-3f, std::abs(a)); };
+            auto ratio = [](float a, float b) { return juce::jmax(a, b) / juce::jmax(1.0f, juce::jmin(a, b)); };
+
+            return from.earlyEngine != to.earlyEngine
+                || from.earlyRoom != to.earlyRoom
+                || relative(from.earlySizeMs, to.earlySizeMs) > sizeJump
+                || relative(from.decayS, to.decayS) > decayJump
+                || ratio(from.hiCutHz, to.hiCutHz) > cutoffJumpRatio
+                || ratio(from.loCutHz, to.loCutHz) > cutoffJumpRatio;
+        }
+
+        bool acquireTransitionSlot()
+        {
+            if (holdsSlot)
+                return true;
+
+            auto& count = activeTransitions();
+            int current = count.load();
+
+            do
+            {
+                if (current >= maxConcurrent().load())
+                    return false;
+            }
+            while (! count.compare_exchange_weak(current, current + 1));
+
+            holdsSlot = true;
+            return true;
+        }
+
+        void releaseTransitionSlot()
+        {
+            if (holdsSlot)
+            {
+                --activeTransitions();
+                holdsSlot = false;
+            }
+        }
+
+        void snapSmoothers(const ReverbSettings& s)
+        {
+            target = s;
+            sizeSmoother.setCurrentAndTargetValue(s.earlySizeMs);
+            decaySmoother.setCurrentAndTargetValue(s.decayS);
+            hiCutSmoother.setCurrentAndTargetValue(s.hiCutHz);
+            loCutSmoother.setCurrentAndTargetValue(s.loCutHz);
+        }
+
+        void rampTo(const ReverbSettings& s)
+        {
+            sizeSmoother.setTargetValue(s.earlySizeMs);
+            decaySmoother.setTargetValue(s.decayS);
+            hiCutSmoother.setTargetValue(s.hiCutHz);
+            loCutSmoother.setTargetValue(s.loCutHz);
+            engines[(size_t)active].setSettings(smoothedSettings());
+        }
+
+        ReverbSettings smoothedSettings() const
+        {
+            auto s = target;
+            s.earlySizeMs = sizeSmoother.getCurrentValue();
+            s.decayS = decaySmoother.getCurrentValue();
+            s.hiCutHz = hiCutSmoother.getCurrentValue();
+            s.loCutHz = loCutSmoother.getCurrentValue();
+            return s;
+        }
+
+        /** Copies the audible tank into the standby, gives it the target settings and fades to it. */
+        void startTransition(float fadeMs)
+        {
+            transitionQueued = false;
+
+            auto& current = engines[(size_t)active];
+            auto& next = engines[(size_t)(1 - active)];
+
+            next.copyStateFrom(current);
+            next.setSettings(target);
+            startFade(fadeMs);
+        }
+
+        void startFade(float fadeMs)
+        {
+            active = 1 - active;
+            snapSmoothers(engines[(size_t)active].getSettings());
+
+            fadeLength = juce::jmax(1, (int)(fadeMs * 0.001 * sampleRate));
+            fadeRemaining = fadeLength;
+            state = State::fading;
+
+            // Gains follow (cos, sin) of an angle running 0 -> pi/2, advanced by a rotation per sample
+            fadeOut = 1.0f;
+            fadeIn = 0.0f;
+            auto step = juce::MathConstants<double>::halfPi / (double)fadeLength;
+            stepCos = (float)std::cos(step);
+            stepSin = (float)std::sin(step);
+        }
+
+        double sampleRate = 44100.0;
+
+        std::array<ReverbEngine, 2> engines;
+        int active = 0;
+        State state = State::idle;
+        bool holdsSlot = false;
+
+        ReverbSettings target;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> sizeSmoother, decaySmoother, hiCutSmoother, loCutSmoother;
+
+        bool monoOutput = false;
+        int warmUpLength = 0;
+        int warmUpLeft = 0;
+
+        juce::AudioBuffer<float> fadeBuf;
+        int fadeLength = 0;
+        int fadeRemaining = 0;
+        float fadeOut = 1.0f, fadeIn = 0.0f;
+        float stepCos = 1.0f, stepSin = 0.0f;
+
+        bool transitionQueued = false;
+        float queuedFadeMs = 0.0f;
+    };
+}
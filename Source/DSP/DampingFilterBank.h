@@ -0,0 +1,146 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+namespace DSP
+{
+    /**
+     * @brief What one FDN line's damping does to its loop, as plain values.
+     * Lo cut and hi cut are first-order slopes; the band gains are the loop gain below the low
+     * crossover and above the high crossover relative to the mid band, which is where the T60
+     * shelving comes from. Each first-order shelf is centred on its crossover, where it is halfway
+     * in dB. All gains 1 leaves only the hi cut / lo cut pair.
+     */
+    struct DampingResponse
+    {
+        float loCutHz = 20.0f;
+        float hiCutHz = 6000.0f;
+        float lowCrossoverHz = 250.0f;
+        float highCrossoverHz = 4000.0f;
+        float lowGain = 1.0f;
+        float highGain = 1.0f;
+    };
+
+    /**
+     * @brief NumLanes independent damping filters, one sample per lane per call.
+     *
+     * Each lane is two topology-preserving-transform state-variable filters (Zavalishin/Simper)
+     * whose outputs are mixed as c0 * input + c1 * band + c2 * low. With the damping set to two
+     * real poles, one SVF is exactly two first-order sections in series: the first holds the lo cut
+     * and the low shelf, the second the hi cut and the high shelf. There is no per-sample branch on
+     * the filter type, and every coefficient and state is stored [section][lane], so process() is
+     * a handful of straight loops over the lanes that the compiler maps onto SIMD registers.
+     */
+    template <int NumLanes>
+    class DampingFilterBank
+    {
+    public:
+        static constexpr int numLanes = NumLanes;
+        static constexpr int numSections = 2;
+
+        DampingFilterBank() = default;
+
+        void reset()
+        {
+            for (auto& section : ic1) section.fill(0.0f);
+            for (auto& section : ic2) section.fill(0.0f);
+        }
+
+        /** Sets one lane; the other lanes and every state are left alone. */
+        void setLane(int lane, double sampleRate, const DampingResponse& r)
+        {
+            jassert(juce::isPositiveAndBelow(lane, NumLanes));
+
+            // Prewarped pole frequencies, each first-order section mapped on its own
+            auto warp = [sampleRate](float hz)
+            {
+                const double f = juce::jlimit(1.0, 0.45 * sampleRate, (double)hz);
+                return std::tan(juce::MathConstants<double>::pi * f / sampleRate);
+            };
+
+            const double loCut = warp(r.loCutHz), lowX = warp(r.lowCrossoverHz / std::sqrt(juce::jmax(1.0e-3f, r.lowGain)));
+            const double hiCut = warp(r.hiCutHz), highX = warp(r.highCrossoverHz * std::sqrt(juce::jmax(1.0e-3f, r.highGain)));
+
+            // Lo cut s / (s + a) times low shelf (s + lowGain * b) / (s + b)
+            setSection(0, lane, loCut, lowX, [&](double a, double b, double* n)
+            {
+                juce::ignoreUnused(a);
+                n[2] = 1.0;
+                n[1] = r.lowGain * b;
+                n[0] = 0.0;
+            });
+
+            // Hi cut a / (s + a) times high shelf (highGain * s + b) / (s + b)
+            setSection(1, lane, hiCut, highX, [&](double a, double b, double* n)
+            {
+                n[2] = 0.0;
+                n[1] = r.highGain * a;
+                n[0] = a * b;
+            });
+        }
+
+        /** Filters one sample per lane, in place. */
+        void process(float* __restrict x) noexcept
+        {
+            for (int s = 0; s < numSections; ++s)
+            {
+                float* __restrict z1 = ic1[(size_t)s].data();
+                float* __restrict z2 = ic2[(size_t)s].data();
+                const float* __restrict g1 = a1[(size_t)s].data();
+                const float* __restrict g2 = a2[(size_t)s].data();
+                const float* __restrict g3 = a3[(size_t)s].data();
+                const float* __restrict m0 = c0[(size_t)s].data();
+                const float* __restrict m1 = c1[(size_t)s].data();
+                const float* __restrict m2 = c2[(size_t)s].data();
+
+                for (int i = 0; i < NumLanes; ++i)
+                {
+                    const float v0 = x[i];
+                    const float v3 = v0 - z2[i];
+                    const float band = g1[i] * z1[i] + g2[i] * v3;
+                    const float low = z2[i] + g2[i] * z1[i] + g3[i] * v3;
+                    z1[i] = 2.0f * band - z1[i];
+                    z2[i] = 2.0f * low - z2[i];
+                    x[i] = m0[i] * v0 + m1[i] * band + m2[i] * low;
+                }
+            }
+        }
+
+    private:
+        using LaneArray = std::array<float, (size_t)NumLanes>;
+        using SectionArray = std::array<LaneArray, (size_t)numSections>;
+
+        /**
+         * One SVF with real poles at the prewarped frequencies wa and wb. The SVF runs at their
+         * geometric mean with k = a + b (a, b the poles normalised to it), and numerator(a, b, n)
+         * gives the second-order numerator n[2] s^2 + n[1] s + n[0] in the same normalised s.
+         */
+        template <typename Numerator>
+        void setSection(int s, int lane, double wa, double wb, Numerator&& numerator)
+        {
+            const double g = std::sqrt(wa * wb);
+            const double a = wa / g, b = wb / g;
+            const double k = a + b;
+
+            double n[3];
+            numerator(a, b, n);
+
+            const double d = 1.0 / (1.0 + g * (g + k));
+            const auto si = (size_t)s, li = (size_t)lane;
+            a1[si][li] = (float)d;
+            a2[si][li] = (float)(g * d);
+            a3[si][li] = (float)(g * g * d);
+
+            // input = s^2 + k s + 1, band = s, low = 1 (over the same denominator)
+            c0[si][li] = (float)n[2];
+            c1[si][li] = (float)(n[1] - k * n[2]);
+            c2[si][li] = (float)(n[0] - n[2]);
+        }
+
+        alignas(32) SectionArray a1 {}, a2 {}, a3 {};
+        alignas(32) SectionArray c0 {}, c1 {}, c2 {};
+        alignas(32) SectionArray ic1 {}, ic2 {};
+    };
+}
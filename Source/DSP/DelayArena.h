@@ -0,0 +1,227 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayMemory.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if JUCE_MSVC && JUCE_INTEL
+ #include <xmmintrin.h>
+#endif
+
+namespace DSP
+{
+    /** Hint that p is about to be read (or written, with forWrite); never faults, may do nothing. */
+    template <bool forWrite = false>
+    inline void prefetchCacheLine(const void* p)
+    {
+       #if JUCE_GCC || JUCE_CLANG
+        __builtin_prefetch(p, forWrite ? 1 : 0, 3);
+       #elif JUCE_MSVC && JUCE_INTEL
+        _mm_prefetch((const char*)p, _MM_HINT_T0);
+       #else
+        juce::ignoreUnused(p);
+       #endif
+    }
+
+    /**
+     * @brief NumLines float delay lines in one allocation, each a packed region just long enough
+     * for its own longest delay, with the timing and interpolation of DelayLine.
+     *
+     * Separate DelayLines are separate heap blocks sized for a common worst case, so an FDN
+     * touches NumLines unrelated regions (and TLB entries) every sample, most of each never read.
+     * Here the regions sit back to back, every one starting on a cache line, and lines wrap by
+     * compare rather than modulo. The lines keep their own write positions, so some can stand
+     * still while the others run (a folded tank).
+     *
+     * Reads and writes walk forward one sample per sample, 2 * NumLines streams that a hardware
+     * prefetcher follows once it has seen a few misses on each. prefetch() asks for the cache
+     * lines a read and a write will reach samplesAhead from now, for when that history is gone:
+     * the start of a block, after other instances have had the cache.
+     *
+     * The storage is a DelayMemory: untouched (and not backed by the OS) until the first non-silent
+     * sample. The first region starts on a cache line of the block itself, found at allocation, so
+     * copies go region by region rather than as the block's raw bytes.
+     */
+    template <int NumLines>
+    class DelayArena
+    {
+    public:
+        static constexpr int numLines = NumLines;
+        static constexpr int cacheLineFloats = 16;
+
+        DelayArena() = default;
+
+        DelayArena(const DelayArena& other) { *this = other; }
+
+        DelayArena& operator=(const DelayArena& other)
+        {
+            if (this == &other)
+                return *this;
+
+            sampleRate = other.sampleRate;
+            lengths = other.lengths;
+            offsets = other.offsets;
+            writeIndex = other.writeIndex;
+
+            if (other.totalLength != totalLength)
+                allocate(other.totalLength);
+
+            if (other.memory.isUntouched())
+                memory.clear();
+            else
+                std::memcpy(getWritePointer(), other.getReadPointer(), (size_t)totalLength * sizeof(float));
+
+            return *this;
+        }
+
+        /** One region per line, for delays up to maxDelayMs[i]. */
+        void prepare(double sr, const float* maxDelayMs)
+        {
+            sampleRate = sr;
+
+            int total = 0;
+            for (int i = 0; i < NumLines; ++i)
+            {
+                const int needed = (int)std::ceil(maxDelayMs[i] * sr / 1000.0) + 1;
+                lengths[(size_t)i] = (needed + cacheLineFloats - 1) / cacheLineFloats * cacheLineFloats;
+                offsets[(size_t)i] = total;
+                total += lengths[(size_t)i];
+            }
+
+            allocate(total);
+            reset();
+        }
+
+        void reset()
+        {
+            memory.clear();
+            writeIndex.fill(0);
+        }
+
+        /** Frees the storage until the next prepare(). */
+        void release()
+        {
+            memory.release();
+            totalLength = 0;
+            alignOffset = 0;
+        }
+
+        /** Samples in line i's region: delays up to getLength(i) - 1 are whole-sample reads. */
+        int getLength(int line) const { return lengths[(size_t)line]; }
+
+        size_t getMemorySize() const { return memory.getMemorySize(); }
+
+        /** One sample of every line, delayMs[i] behind the last push, as DelayLine::read(). */
+        void read(const float* delayMs, float* out) const
+        {
+            const float* data = getReadPointer();
+
+            for (int i = 0; i < NumLines; ++i)
+            {
+                const int length = lengths[(size_t)i];
+                const float* line = data + offsets[(size_t)i];
+
+                const float delaySamples = juce::jlimit(0.0f, (float)length - 1.01f, delayMs[i] * (float)sampleRate / 1000.0f);
+                float readPos = (float)writeIndex[(size_t)i] - delaySamples;
+                readPos += readPos < 0.0f ? (float)length : 0.0f;
+
+                const int index1 = juce::jmin((int)readPos, length - 1); // readPos may round up to length
+                const int index2 = index1 + 1 < length ? index1 + 1 : 0;
+                const float frac = readPos - (float)index1;
+
+                out[i] = line[index1] + frac * (line[index2] - line[index1]);
+            }
+        }
+
+        /** Appends one sample to every line. */
+        void push(const float* in)
+        {
+            // Silence into lines that never held sound leaves their memory untouched
+            if (! memory.isUntouched() || ! DelayMemory::isSilent(in, NumLines))
+            {
+                float* data = getWritePointer();
+                for (int i = 0; i < NumLines; ++i)
+                    data[offsets[(size_t)i] + writeIndex[(size_t)i]] = in[i];
+            }
+
+            for (int i = 0; i < NumLines; ++i)
+                advance(i);
+        }
+
+        /** Line i read back a whole number of samples, delaySamples in [0, getLength(i)). */
+        float readWhole(int line, int delaySamples) const
+        {
+            jassert(delaySamples >= 0 && delaySamples < lengths[(size_t)line]);
+            const int w = writeIndex[(size_t)line];
+            const int index = w >= delaySamples ? w - delaySamples : w + lengths[(size_t)line] - delaySamples;
+            return getReadPointer()[offsets[(size_t)line] + index];
+        }
+
+        /** Appends one sample to line i only. */
+        void pushLine(int line, float input)
+        {
+            if (input != 0.0f || ! memory.isUntouched())
+                getWritePointer()[offsets[(size_t)line] + writeIndex[(size_t)line]] = input;
+
+            advance(line);
+        }
+
+        /**
+         * Prefetches, for every line, where read(delayMs) and push() will be samplesAhead pushes
+         * from now (the modulation moves a read by far less than a cache line in that time).
+         */
+        void prefetch(const float* delayMs, int samplesAhead) const
+        {
+            if (memory.isUntouched())
+                return;
+
+            const float* data = getReadPointer();
+
+            for (int i = 0; i < NumLines; ++i)
+            {
+                const int length = lengths[(size_t)i];
+                const float* line = data + offsets[(size_t)i];
+                const int w = writeIndex[(size_t)i] + samplesAhead;
+
+                int r = w - (int)(delayMs[i] * (float)sampleRate / 1000.0f) - 1;
+                r += r < 0 ? length : 0;
+                r -= r >= length ? length : 0;
+
+                prefetchCacheLine(line + juce::jlimit(0, length - 1, r));
+                prefetchCacheLine<true>(line + (w < length ? w : w - length));
+            }
+        }
+
+    private:
+        void allocate(int total)
+        {
+            // Room to start the first region on a cache line, wherever the block lands
+            totalLength = total;
+            memory.allocate((size_t)(total + cacheLineFloats));
+
+            const auto address = (std::uintptr_t)memory.getReadPointer();
+            const auto lineBytes = (std::uintptr_t)cacheLineFloats * sizeof(float);
+            alignOffset = (int)(((lineBytes - address % lineBytes) % lineBytes) / sizeof(float));
+        }
+
+        void advance(int line)
+        {
+            auto& w = writeIndex[(size_t)line];
+            w = w + 1 < lengths[(size_t)line] ? w + 1 : 0;
+        }
+
+        const float* getReadPointer() const { return memory.getReadPointer() + alignOffset; }
+        float* getWritePointer() { return memory.getWritePointer() + alignOffset; }
+
+        double sampleRate = 44100.0;
+        DelayMemory memory;
+        int totalLength = 0;
+        int alignOffset = 0;
+        std::array<int, NumLines> lengths {};
+        std::array<int, NumLines> offsets {};
+        std::array<int, NumLines> writeIndex {};
+    };
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include <vector>
+#include "DelayMemory.h"
 #include <cmath>
 
 namespace DSP
@@ -9,6 +9,7 @@ namespace DSP
 
     /**
      * @brief A fractional delay line with linear interpolation.
+     * Storage is a DelayMemory: nothing is written (or backed by the OS) until the first non-silent sample.
      */
     class DelayLine
     {
@@ -18,19 +19,22 @@ namespace DSP
         void prepare(double newSampleRate, double maxDelayMs)
         {
             this->sampleRate = newSampleRate;
-            buffer.resize((size_t)std::ceil(maxDelayMs * sampleRate / 1000.0) + 1);
-            reset();
+            buffer.allocate((size_t)std::ceil(maxDelayMs * sampleRate / 1000.0) + 1);
+            writeIndex = 0;
         }
 
         void reset()
         {
-            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            buffer.clear();
             writeIndex = 0;
         }
 
         void push(float input)
         {
-            buffer[writeIndex] = input;
+            // Silence into a line that never held sound leaves its memory untouched
+            if (input != 0.0f || ! buffer.isUntouched())
+                buffer.getWritePointer()[writeIndex] = input;
+
             writeIndex = (writeIndex + 1) % buffer.size();
         }
 
@@ -58,11 +62,29 @@ namespace DSP
             int index2 = (index1 + 1) % buffer.size();
             float frac = readPos - (float)index1;
 
-            return buffer[index1] + frac * (buffer[index2] - buffer[index1]);
+            const float* data = buffer.getReadPointer();
+            return data[index1] + frac * (data[index2] - data[index1]);
         }
 
+        /**
+         * @brief Reads a whole number of samples back, with no interpolation.
+         * Same timing as read() at a delay of delaySamples, which must be in [0, size).
+         */
+        float readWhole(int delaySamples) const
+        {
+            jassert(delaySamples >= 0 && (size_t)delaySamples < buffer.size());
+            const size_t index = writeIndex >= (size_t)delaySamples ? writeIndex - (size_t)delaySamples
+                                                                     : writeIndex + buffer.size() - (size_t)delaySamples;
+            return buffer.getReadPointer()[index];
+        }
+
+        /** Frees the storage until the next prepare(). */
+        void release() { buffer.release(); }
+
+        size_t getMemorySize() const { return buffer.getMemorySize(); }
+
     private:
-        std::vector<float> buffer;
+        DelayMemory buffer;
         size_t writeIndex = 0;
         double sampleRate = 44100.0;
     };
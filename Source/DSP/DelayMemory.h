@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace DSP
+{
+    /** Process-wide count of delay memory blocks allocated, shared by every sample type. */
+    inline std::atomic<int>& delayMemoryAllocationCount() { static std::atomic<int> count { 0 }; return count; }
+
+    /**
+     * @brief Zero-initialised sample storage for delay lines, cheap to create in bulk and to re-prepare.
+     *
+     * Memory comes from calloc, so large blocks arrive as untouched zero pages that the OS only
+     * backs on first write, and storage that was never written is not cleared again on reset.
+     * Writers ask for getWritePointer() only once there is something other than silence to store,
+     * so the lines of an idle instance cost neither zero-fill time nor resident memory.
+     * The price is a few page faults on the audio thread when the first sound arrives; the
+     * seconds-long buffers of LongDelay use the prefaulted LargeBuffer instead.
+     *
+     * The block is a reservation: allocate() with a size that fits (a re-prepare at the same or a
+     * lower sample rate) keeps it and only clears the part that was written, so hosts that
+     * re-prepare often do not churn the heap. Copying (engine state transfer) is one memcpy.
+     *
+     * SampleType is float, or std::uint16_t holding IEEE half floats (all-zero bits are +0 there
+     * too) for the compact storage of Float16DelayBank.
+     */
+    template <typename SampleType>
+    class BasicDelayMemory
+    {
+    public:
+        BasicDelayMemory() = default;
+
+        BasicDelayMemory(const BasicDelayMemory& other) { *this = other; }
+
+        BasicDelayMemory& operator=(const BasicDelayMemory& other)
+        {
+            if (this == &other)
+                return *this;
+
+            if (other.numElements != numElements)
+                allocate(other.numElements);
+
+            if (other.untouched)
+                clear();
+            else
+                std::memcpy(getWritePointer(), other.block.get(), numElements * sizeof(SampleType));
+
+            return *this;
+        }
+
+        /**
+         * Zeroed storage for numSamples samples. Reuses the block when it is large enough, otherwise
+         * replaces it with one of exactly numSamples (the reservation only ever grows).
+         */
+        void allocate(size_t numSamples)
+        {
+            if (numSamples <= capacity)
+            {
+                clear();
+                numElements = numSamples;
+                return;
+            }
+
+            block.calloc(numSamples);
+            capacity = numElements = numSamples;
+            dirtyElements = 0;
+            untouched = true;
+            delayMemoryAllocationCount().fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /** Gives the reservation back, e.g. when a line switches to the other storage type. */
+        void release()
+        {
+            block.free();
+            capacity = numElements = dirtyElements = 0;
+            untouched = true;
+        }
+
+        /** Zeroes whatever was written since the last clear, which is at most the active region. */
+        void clear()
+        {
+            if (dirtyElements > 0)
+                std::memset(block.get(), 0, dirtyElements * sizeof(SampleType));
+
+            dirtyElements = 0;
+            untouched = true;
+        }
+
+        size_t size() const { return numElements; }
+        size_t getCapacity() const { return capacity; }
+        bool isUntouched() const { return untouched; }
+
+        const SampleType* getReadPointer() const { return block.get(); }
+
+        SampleType* getWritePointer()
+        {
+            untouched = false;
+            dirtyElements = std::max(dirtyElements, numElements);
+            return block.get();
+        }
+
+        /** Heap bytes reserved, which may be more than the active size after a re-prepare at a lower rate. */
+        size_t getMemorySize() const { return capacity * sizeof(SampleType); }
+
+        /** True if the block is all zeros: writing it into untouched memory can be skipped. */
+        static bool isSilent(const float* data, int numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                if (data[i] != 0.0f)
+                    return false;
+
+            return true;
+        }
+
+        /** Process-wide number of blocks allocated so far (message thread), for tests and diagnostics. */
+        static int getNumAllocations() { return delayMemoryAllocationCount().load(std::memory_order_relaxed); }
+
+    private:
+        juce::HeapBlock<SampleType> block;
+        size_t capacity = 0;
+        size_t numElements = 0;
+        size_t dirtyElements = 0;   // Prefix that may hold non-zero samples
+        bool untouched = true;
+    };
+
+    using DelayMemory = BasicDelayMemory<float>;
+}
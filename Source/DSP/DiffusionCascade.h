@@ -0,0 +1,216 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayMemory.h"
+#include <array>
+#include <cmath>
+
+namespace DSP
+{
+    /**
+     * @brief Stereo chain of Schroeder allpasses (same topology as AllpassFilter), processed block-wise.
+     *
+     * The block is run through one stage at a time, in spans no longer than the shorter of that
+     * stage's two delays. Within such a span every delayed value was written before the span
+     * started, so the loop has no sample-to-sample dependency: it vectorises across time and
+     * advances L and R together, two independent streams in one loop body. The vector lanes run
+     * along time rather than across the channels, since L and R read at different delays and two
+     * channels would fill only two lanes. Delays are whole samples, the diffusers are not modulated.
+     */
+    class DiffusionCascade
+    {
+    public:
+        static constexpr int maxStages = 8;
+
+        DiffusionCascade() = default;
+
+        /** Allocates every stage for the given rate. Delay times are fixed, L slightly shorter than R. */
+        void prepare(double sr)
+        {
+            for (int s = 0; s < maxStages; ++s)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    auto& line = stages[(size_t)s].lines[(size_t)ch];
+                    line.delay = juce::jmax(1, (int)(stageDelaysMs[s][ch] * 0.001 * sr));
+                    // At least twice the delay, so a span's read and write regions can never overlap
+                    line.buffer.allocate((size_t)juce::nextPowerOfTwo(2 * line.delay));
+                    line.mask = (int)line.buffer.size() - 1;
+                    line.writeIndex = 0;
+                }
+            }
+        }
+
+        void reset()
+        {
+            for (auto& stage : stages)
+            {
+                for (auto& line : stage.lines)
+                {
+                    line.buffer.clear();
+                    line.writeIndex = 0;
+                }
+            }
+        }
+
+        /** Number of active stages, 0 bypasses the cascade. */
+        void setNumStages(int n) { numStages = juce::jlimit(0, maxStages, n); }
+        int getNumStages() const { return numStages; }
+
+        void setFeedback(float g) { feedback = g; }
+
+        /** Diffuses both channels in place; right may be nullptr for a mono source. */
+        void process(float* left, float* right, int numSamples)
+        {
+            // Silence through stages that never held sound stays silence, and their memory untouched
+            if (isUntouched() && DelayMemory::isSilent(left, numSamples)
+                 && (right == nullptr || DelayMemory::isSilent(right, numSamples)))
+                return;
+
+            for (int s = 0; s < numStages; ++s)
+            {
+                if (right != nullptr)
+                    processStereo(stages[(size_t)s], left, right, numSamples);
+                else
+                    processLine(stages[(size_t)s].lines[0], left, numSamples);
+            }
+        }
+
+        /** Upper bound on how long the active stages ring, in ms, down to belowDb. */
+        float getSettlingMs(float belowDb) const
+        {
+            const float dbPerTrip = -20.0f * std::log10(juce::jlimit(1.0e-6f, 0.999f, std::abs(feedback)));
+            const float trips = juce::jmax(1.0f, belowDb / dbPerTrip);
+
+            float ms = 0.0f;
+            for (int s = 0; s < numStages; ++s)
+                ms += juce::jmax(stageDelaysMs[s][0], stageDelaysMs[s][1]) * trips;
+
+            return ms;
+        }
+
+        size_t getMemorySize() const
+        {
+            size_t bytes = 0;
+            for (auto& stage : stages)
+                for (auto& line : stage.lines)
+                    bytes += line.buffer.getMemorySize();
+            return bytes;
+        }
+
+        /** True while no active stage has held anything but silence since prepare() or reset(). */
+        bool isUntouched() const
+        {
+            for (int s = 0; s < numStages; ++s)
+                for (auto& line : stages[(size_t)s].lines)
+                    if (! line.buffer.isUntouched())
+                        return false;
+
+            return true;
+        }
+
+    private:
+        struct Line
+        {
+            DelayMemory buffer;
+            int mask = 0;
+            int writeIndex = 0;
+            int delay = 1;
+        };
+
+        struct Stage
+        {
+            std::array<Line, 2> lines;
+        };
+
+        void processLine(Line& line, float* data, int numSamples) const
+        {
+            const float g = feedback;
+            float* buf = line.buffer.getWritePointer();
+            const int size = line.mask + 1;
+            int pos = 0;
+
+            while (pos < numSamples)
+            {
+                int readIndex = (line.writeIndex - line.delay) & line.mask;
+
+                // Contiguous and dependency-free: no wrap on either side, never longer than the delay
+                int span = juce::jmin(numSamples - pos, line.delay);
+                span = juce::jmin(span, size - readIndex, size - line.writeIndex);
+
+                const float* __restrict src = buf + readIndex;
+                float* __restrict dst = buf + line.writeIndex;
+                float* __restrict x = data + pos;
+
+                for (int k = 0; k < span; ++k)
+                {
+                    float delayed = src[k];
+                    float w = x[k] + g * delayed;
+                    dst[k] = w;
+                    x[k] = delayed - g * w;
+                }
+
+                line.writeIndex = (line.writeIndex + span) & line.mask;
+                pos += span;
+            }
+        }
+
+        /** Both lines of a stage in one pass, spans limited by whichever line wraps or repeats first. */
+        void processStereo(Stage& stage, float* left, float* right, int numSamples) const
+        {
+            const float g = feedback;
+            auto& lineL = stage.lines[0];
+            auto& lineR = stage.lines[1];
+            float* bufL = lineL.buffer.getWritePointer();
+            float* bufR = lineR.buffer.getWritePointer();
+            const int sizeL = lineL.mask + 1;
+            const int sizeR = lineR.mask + 1;
+            int pos = 0;
+
+            while (pos < numSamples)
+            {
+                const int readL = (lineL.writeIndex - lineL.delay) & lineL.mask;
+                const int readR = (lineR.writeIndex - lineR.delay) & lineR.mask;
+
+                int span = juce::jmin(numSamples - pos, lineL.delay, lineR.delay);
+                span = juce::jmin(span, sizeL - readL, sizeL - lineL.writeIndex);
+                span = juce::jmin(span, sizeR - readR, sizeR - lineR.writeIndex);
+
+                processStereoSpan(bufL + readL, bufR + readR, bufL + lineL.writeIndex, bufR + lineR.writeIndex,
+                                  left + pos, right + pos, g, span);
+
+                lineL.writeIndex = (lineL.writeIndex + span) & lineL.mask;
+                lineR.writeIndex = (lineR.writeIndex + span) & lineR.mask;
+                pos += span;
+            }
+        }
+
+        // A function of its own, so the compiler takes the six streams as not aliasing and vectorises
+        static void processStereoSpan(const float* __restrict srcL, const float* __restrict srcR,
+                                      float* __restrict dstL, float* __restrict dstR,
+                                      float* __restrict xL, float* __restrict xR, float g, int span)
+        {
+            for (int k = 0; k < span; ++k)
+            {
+                const float delayedL = srcL[k];
+                const float delayedR = srcR[k];
+                const float wL = xL[k] + g * delayedL;
+                const float wR = xR[k] + g * delayedR;
+                dstL[k] = wL;
+                dstR[k] = wR;
+                xL[k] = delayedL - g * wL;
+                xR[k] = delayedR - g * wR;
+            }
+        }
+
+        // Mutually prime-ish, spread so each stage roughly doubles the echo count
+        static constexpr float stageDelaysMs[maxStages][2] = {
+            { 1.3f, 1.7f }, { 2.3f, 2.9f }, { 3.7f, 4.3f }, { 5.3f, 6.1f },
+            { 7.1f, 7.9f }, { 8.9f, 9.7f }, { 10.7f, 11.3f }, { 12.7f, 13.1f }
+        };
+
+        std::array<Stage, maxStages> stages;
+        int numStages = 4;
+        float feedback = 0.6f;
+    };
+}
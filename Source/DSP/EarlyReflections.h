@@ -1,129 +1,475 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "DelayLine.h"
-#include "AllpassFilter.h"
+#include "LFO.h"
+#include "ModulationBank.h"
+#include "DelayMemory.h"
+#include "RoomModel.h"
 #include <array>
+#include <cmath>
 
 namespace DSP
 {
     /**
      * @brief Early Reflections engine.
      * Uses input diffusion (series allpasses) followed by a multi-tap delay structure.
+     *
+     * Diffuser delays and tap positions of both channels move with one shared ModulationBank,
+     * whose offsets are generated for the whole block up front. The block is then processed in
+     * spans where no modulated read can reach a sample written in the same span, so the
+     * interpolated reads run as plain loops over time instead of per-sample delay-line calls.
+     *
+     * The taps sit at fixed fractions of the size, unless a RoomTapTable from the image-source room
+     * model is set, in which case each channel reads its own ear's reflections from that table.
      */
     class EarlyReflections
     {
     public:
+        static constexpr int numDiffusers = 3;      // Series allpasses per channel
+        static constexpr int numTaps = 4;           // Output taps per channel
+        static constexpr int maxChunk = 256;        // Samples per modulation block
+
         EarlyReflections() = default;
 
         void prepare(double sr)
         {
             this->sampleRate = sr;
-            
+
             // Initialize diffusers
-            for (auto& apf : diffusersL) apf.prepare(sr, 10.0); // Arbitrary max
-            for (auto& apf : diffusersR) apf.prepare(sr, 10.0);
-            
-            // Initialize main delays
-            delayL.prepare(sr, 500.0); // Max 500ms size
-            delayR.prepare(sr, 500.0);
-            
+            const int maxDiffuserSamples = toSamples(maxDiffuserMs + maxDiffuserModMs) + 2;
+            for (auto& line : diffuserLines)
+                line.allocate(juce::nextPowerOfTwo(2 * maxDiffuserSamples));
+
+            // Initialize main delays: max 500 ms size, plus room for one chunk written ahead of the taps
+            for (auto& line : tapLines)
+                line.allocate(juce::nextPowerOfTwo(toSamples(maxSizeMs + maxTapModMs) + maxChunk + 2));
+
+            modulation.prepare(sr);
+            setModulation(modRate, modDepth);
             reset();
         }
-        
+
         void reset()
         {
-            for (auto& apf : diffusersL) apf.setFeedback(0.0f);
-            for (auto& apf : diffusersR) apf.setFeedback(0.0f);
-            delayL.reset();
-            delayR.reset();
+            for (auto& line : diffuserLines) line.clear();
+            for (auto& line : tapLines) line.clear();
+            modulation.reset();
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                modulation.setPhase(lane, (float)lane / (float)numLanes); // Decorrelate every lane
         }
 
         void setParameters(float sizeMs, float cross, float diffusionAmt)
         {
-            currentSizeMs = sizeMs;
+            currentSizeMs = juce::jmin(sizeMs, (float)maxSizeMs);
             currentCross = cross;
-            
+
             // Update diffusion coefficients
-            float diff = diffusionAmt * 0.6f; // Max correlation
-            for (auto& apf : diffusersL) apf.setFeedback(diff);
-            for (auto& apf : diffusersR) apf.setFeedback(diff);
-            
-            // Update diffuser delay times (scaled by size generally, or fixed for character)
-            // Sticking to fixed decent prime numbers for "smearing" or scaled.
-            // Let's scale them slightly with size to keep density consistent relative to room.
-            // Values: 4.7, 8.3, 11.1 ms etc.
-            static const float baseDelays[] = { 4.3f, 7.1f, 13.7f };
-            for (size_t i = 0; i < 3; ++i)
+            diffuserGain = diffusionAmt * 0.6f; // Max correlation
+        }
+
+        /**
+         * @brief Motion of the early field: rate in Hz, depth 0..1.
+         * Full depth moves the diffusers by maxDiffuserModMs and the taps by maxTapModMs.
+         */
+        void setModulation(float rateHz, float depth)
+        {
+            modRate = rateHz;
+            modDepth = juce::jlimit(0.0f, 1.0f, depth);
+
+            const float diffuserDepth = (float)(maxDiffuserModMs * 0.001 * sampleRate) * modDepth;
+            const float tapDepth = (float)(maxTapModMs * 0.001 * sampleRate) * modDepth;
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
             {
-                // Keeping diffusers relatively short/fixed usually better for ER
-                diffusersL[i].prepare(sampleRate, baseDelays[i]);
-                diffusersR[i].prepare(sampleRate, baseDelays[i] + 2.3f); // Decorrelate L/R
+                modulation.setFrequency(lane, rateHz * (0.85f + 0.03f * (float)lane)); // Spread rates slightly
+                modulation.setDepth(lane, lane < tapLaneStart ? diffuserDepth
+                                        : lane < unusedLaneStart ? tapDepth : 0.0f);
             }
         }
 
-        // Processing stereo block
-        void processBlock(juce::AudioBuffer<float>& buffer)
+        void setModulationShape(LFO::Waveform shape)
+        {
+            modulation.setWaveform(shape);
+        }
+
+        /**
+         * Moves the motion on by numSamples without processing, as if they had been silence. The
+         * LFOs only run while there is depth, so their phase follows the time since reset either way.
+         */
+        void skipModulation(juce::int64 numSamples)
         {
+            if (modDepth > 0.0f)
+                modulation.skip(numSamples);
+        }
+
+        /**
+         * @brief Taps from the room model instead of the size ratios, or nullptr for the ratios.
+         * The table is copied (only when its hash changes), so it need not outlive this call; the
+         * next chunk crossfades from the previous room's taps to the new ones.
+         */
+        void setRoomTaps(const RoomTapTable* table)
+        {
+            if (table == nullptr)
+            {
+                useRoomTaps = false;
+                return;
+            }
+
+            if (useRoomTaps && table->hash == roomTaps.hash)
+                return;
+
+            fadeRoomTaps = useRoomTaps;
+            if (fadeRoomTaps)
+                previousRoomTaps = roomTaps;
+
+            roomTaps = *table;
+            useRoomTaps = true;
+        }
+
+        /**
+         * Processes a block in place. With monoInput only channel 0 holds input: one diffuser chain
+         * and one tap line run, and the taps of both ears read that line. The buffer may then have
+         * one channel (mono out) or two (mono to stereo, the ears still differ in their taps).
+         */
+        void processBlock(juce::AudioBuffer<float>& buffer, bool monoInput = false)
+        {
+            jassert(monoInput || buffer.getNumChannels() > 1);
+
             auto* left = buffer.getWritePointer(0);
-            auto* right = buffer.getWritePointer(1);
+            auto* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
             int numSamples = buffer.getNumSamples();
 
-            for (int i = 0; i < numSamples; ++i)
+            for (int start = 0; start < numSamples; start += maxChunk)
+                processChunk(left + start, right != nullptr ? right + start : nullptr,
+                             juce::jmin(maxChunk, numSamples - start), monoInput);
+        }
+
+        /**
+         * Upper bound on how long an input is heard, in ms, down to belowDb: the longest possible
+         * tap (room taps included) after the diffusers have rung down that far, each a loop of
+         * gain diffuserGain per trip.
+         */
+        float getSettlingMs(float belowDb) const
+        {
+            const float dbPerTrip = -20.0f * std::log10(juce::jlimit(1.0e-6f, 0.999f, diffuserGain));
+            const float trips = juce::jmax(1.0f, belowDb / dbPerTrip);
+
+            float ms = (float)(maxSizeMs + maxTapModMs);
+            for (auto delayMs : diffuserDelaysMs)
+                ms += (delayMs + diffuserOffsetMs + (float)maxDiffuserModMs) * trips;
+
+            return ms;
+        }
+
+        size_t getMemorySize() const
+        {
+            size_t bytes = 0;
+            for (auto& line : diffuserLines) bytes += line.getMemorySize();
+            for (auto& line : tapLines) bytes += line.getMemorySize();
+            return bytes;
+        }
+
+    private:
+        // Lanes: 3 diffusers L, 3 diffusers R, 4 taps L, 4 taps R, padded to a SIMD-friendly 16
+        static constexpr size_t numLanes = 16;
+        static constexpr size_t tapLaneStart = 2 * numDiffusers;
+        static constexpr size_t unusedLaneStart = tapLaneStart + 2 * numTaps;
+
+        static constexpr float diffuserDelaysMs[numDiffusers] = { 4.3f, 7.1f, 13.7f };
+        static constexpr float diffuserOffsetMs = 2.3f; // R diffusers are longer, to decorrelate L/R
+
+        static constexpr double maxDiffuserMs = 20.0;
+        static constexpr double maxSizeMs = 500.0;
+        static constexpr double maxDiffuserModMs = 0.25;
+        static constexpr double maxTapModMs = 1.0;
+
+        /** Power-of-two circular buffer, indexed with a mask. */
+        struct Line
+        {
+            DelayMemory buffer;
+            int mask = 0;
+            int writeIndex = 0;
+
+            void allocate(int size)
+            {
+                buffer.allocate((size_t)size);
+                mask = size - 1;
+                writeIndex = 0;
+            }
+
+            void clear()
             {
-                float inL = left[i];
-                float inR = right[i];
-                
-                // 1. Crossfeed Input
-                float mixedL = inL * (1.0f - currentCross * 0.5f) + inR * (currentCross * 0.5f);
-                float mixedR = inR * (1.0f - currentCross * 0.5f) + inL * (currentCross * 0.5f);
-                
-                // 2. Diffusion
-                float diffL = mixedL;
-                float diffR = mixedR;
-                for (auto& apf : diffusersL) diffL = apf.process(diffL);
-                for (auto& apf : diffusersR) diffR = apf.process(diffR);
-                
-                // 3. Delay Line Input
-                delayL.push(diffL);
-                delayR.push(diffR);
-                
-                // 4. Taps output
-                // Taps at ratios of currentSizeMs.
-                // E.g. 0.1, 0.3, 0.5, 0.8...
-                
-                float outL = 0.0f;
-                float outR = 0.0f;
-                
-                // Simple pattern
-                // L: taps at 0.1, 0.4, 0.7
-                // R: taps at 0.2, 0.5, 0.9
-                
-                outL += delayL.read(currentSizeMs * 0.11f) * 0.6f;
-                outL += delayL.read(currentSizeMs * 0.43f) * 0.4f;
-                outL += delayR.read(currentSizeMs * 0.67f) * 0.3f; // Cross-tap
-                outL += delayL.read(currentSizeMs * 0.91f) * 0.2f;
-
-                outR += delayR.read(currentSizeMs * 0.13f) * 0.6f;
-                outR += delayR.read(currentSizeMs * 0.47f) * 0.4f;
-                outR += delayL.read(currentSizeMs * 0.71f) * 0.3f; // Cross-tap
-                outR += delayR.read(currentSizeMs * 0.97f) * 0.2f;
-                
-                left[i] = outL;
-                right[i] = outR;
+                buffer.clear();
+                writeIndex = 0;
             }
+
+            size_t getMemorySize() const { return buffer.getMemorySize(); }
+        };
+
+        /** Where a tap reads from: source channel, position as a fraction of the size, and gain. */
+        struct Tap
+        {
+            int source;
+            float ratio;
+            float gain;
+        };
+
+        bool isUntouched() const
+        {
+            for (auto& line : diffuserLines) if (! line.buffer.isUntouched()) return false;
+            for (auto& line : tapLines) if (! line.buffer.isUntouched()) return false;
+            return true;
         }
 
-    private:
+        int toSamples(double ms) const { return (int)std::ceil(ms * 0.001 * sampleRate); }
+
+        void processChunk(float* left, float* right, int numSamples, bool monoInput)
+        {
+            const int numInputs = monoInput ? 1 : 2;
+            const int numOutputs = right != nullptr ? 2 : 1;
+
+            // Nothing has sounded yet: silence in is silence out, and the delay memory stays untouched
+            if (isUntouched() && DelayMemory::isSilent(left, numSamples)
+                 && (monoInput || DelayMemory::isSilent(right, numSamples)))
+            {
+                if (monoInput && right != nullptr)
+                    juce::FloatVectorOperations::clear(right, numSamples);
+
+                skipModulation(numSamples);
+                return;
+            }
+
+            // 1. Crossfeed Input (nothing to mix for a single source)
+            if (! monoInput)
+            {
+                const float keep = 1.0f - currentCross * 0.5f;
+                const float feed = currentCross * 0.5f;
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    float inL = left[i];
+                    float inR = right[i];
+                    left[i] = inL * keep + inR * feed;
+                    right[i] = inR * keep + inL * feed;
+                }
+            }
+
+            const float* offsets[numLanes];
+            generateOffsets(offsets, numSamples);
+
+            // 2. Diffusion
+            // Keeping diffusers relatively short/fixed usually better for ER, R is offset to decorrelate L/R.
+            for (int d = 0; d < numDiffusers; ++d)
+            {
+                const float delay = (float)(diffuserDelaysMs[d] * 0.001 * sampleRate);
+                const float delayR = (float)((diffuserDelaysMs[d] + diffuserOffsetMs) * 0.001 * sampleRate);
+                diffuse(diffuserLines[(size_t)d], left, numSamples, delay, offsets[(size_t)d]);
+                if (! monoInput)
+                    diffuse(diffuserLines[(size_t)(numDiffusers + d)], right, numSamples, delayR, offsets[(size_t)(numDiffusers + d)]);
+            }
+
+            // 3. Delay Line Input, the whole chunk before any tap reads it
+            const int writeStart[2] = { tapLines[0].writeIndex, tapLines[1].writeIndex };
+            write(tapLines[0], left, numSamples);
+            if (! monoInput)
+                write(tapLines[1], right, numSamples);
+
+            // A mono source has a single line, which every tap reads
+            auto sourceLine = [numInputs](int source) { return numInputs > 1 ? source : 0; };
+
+            // 4. Taps output
+            // L: taps at 0.11, 0.43, 0.91 plus a cross-tap from R, and the mirror image for R
+            static constexpr Tap taps[2][numTaps] = {
+                { { 0, 0.11f, 0.6f }, { 0, 0.43f, 0.4f }, { 1, 0.67f, 0.3f }, { 0, 0.91f, 0.2f } },
+                { { 1, 0.13f, 0.6f }, { 1, 0.47f, 0.4f }, { 0, 0.71f, 0.3f }, { 1, 0.97f, 0.2f } }
+            };
+
+            const float sizeSamples = currentSizeMs * 0.001f * (float)sampleRate;
+            const float minTapDelay = (float)(maxTapModMs * 0.001 * sampleRate) + 1.0f;
+
+            alignas(32) float tapOut[maxChunk];
+            float* outputs[2] = { left, right };
+
+            if (useRoomTaps)
+            {
+                // Each ear reads its own reflections from its own (crossfed) channel
+                const float msToSamples = 0.001f * (float)sampleRate;
+                auto renderRoom = [&](const RoomTapTable& table, int ch, float* dest)
+                {
+                    juce::FloatVectorOperations::clear(dest, numSamples);
+
+                    const int source = sourceLine(ch);
+                    const auto& line = tapLines[(size_t)source];
+                    for (int t = 0; t < table.numTaps[(size_t)ch]; ++t)
+                    {
+                        const auto& tap = table.taps[(size_t)ch][(size_t)t];
+                        const float delay = juce::jmax(minTapDelay, tap.delayMs * msToSamples);
+
+                        readModulated(line.buffer.getReadPointer(), line.mask, writeStart[source], tapOut, numSamples,
+                                      delay, offsets[tapLaneStart + (size_t)(ch * numTaps + t % numTaps)]);
+                        juce::FloatVectorOperations::addWithMultiply(dest, tapOut, tap.gain, numSamples);
+                    }
+                };
+
+                alignas(32) float previous[maxChunk];
+                for (int ch = 0; ch < numOutputs; ++ch)
+                {
+                    renderRoom(roomTaps, ch, outputs[ch]);
+
+                    // A new room: one chunk of linear crossfade instead of a jump in every tap
+                    if (fadeRoomTaps)
+                    {
+                        renderRoom(previousRoomTaps, ch, previous);
+                        const float step = 1.0f / (float)numSamples;
+                        for (int k = 0; k < numSamples; ++k)
+                            outputs[ch][k] = previous[k] + (outputs[ch][k] - previous[k]) * step * (float)(k + 1);
+                    }
+                }
+
+                fadeRoomTaps = false;
+                return;
+            }
+
+            for (int ch = 0; ch < numOutputs; ++ch)
+            {
+                juce::FloatVectorOperations::clear(outputs[ch], numSamples);
+
+                for (int t = 0; t < numTaps; ++t)
+                {
+                    const auto& tap = taps[ch][t];
+                    const int source = sourceLine(tap.source);
+                    const auto& line = tapLines[(size_t)source];
+                    const float delay = juce::jmax(minTapDelay, sizeSamples * tap.ratio);
+
+                    readModulated(line.buffer.getReadPointer(), line.mask, writeStart[source], tapOut, numSamples,
+                                  delay, offsets[tapLaneStart + (size_t)(ch * numTaps + t)]);
+                    juce::FloatVectorOperations::addWithMultiply(outputs[ch], tapOut, tap.gain, numSamples);
+                }
+            }
+        }
+
+        /** Fills one offset ramp (in samples) per lane for the chunk, or points every lane at zeros. */
+        void generateOffsets(const float** offsets, int numSamples)
+        {
+            if (modDepth <= 0.0f)
+            {
+                for (size_t lane = 0; lane < numLanes; ++lane)
+                    offsets[lane] = zeroOffsets.data();
+                return;
+            }
+
+            int pos = 0;
+            while (pos < numSamples)
+            {
+                if (modulation.getSamplesUntilTick() == 0)
+                    modulation.tick();
+
+                const int span = juce::jmin(modulation.getSamplesUntilTick(), numSamples - pos);
+                const float* values = modulation.getValues();
+                const float* increments = modulation.getIncrements();
+
+                for (size_t lane = 0; lane < unusedLaneStart; ++lane)
+                {
+                    float* __restrict dst = laneOffsets[lane].data() + pos;
+                    const float v = values[lane], inc = increments[lane];
+
+                    for (int k = 0; k < span; ++k)
+                        dst[k] = v + inc * (float)k;
+                }
+
+                modulation.advance(span);
+                pos += span;
+            }
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                offsets[lane] = lane < unusedLaneStart ? laneOffsets[lane].data() : zeroOffsets.data();
+        }
+
+        /**
+         * Schroeder allpass (w = x + g * delayed, y = delayed - g * w) with a modulated fractional delay.
+         * Spans are shorter than the smallest modulated delay and never wrap the write position, so the
+         * reads of a span are a gather from earlier spans and the rest is a plain contiguous loop.
+         */
+        void diffuse(Line& line, float* data, int numSamples, float delay, const float* offsets) const
+        {
+            const float g = diffuserGain;
+            const int maxSpan = juce::jmax(1, (int)(delay - (float)(maxDiffuserModMs * 0.001 * sampleRate)) - 1);
+            const int size = line.mask + 1;
+            float* buf = line.buffer.getWritePointer();
+            int pos = 0;
+
+            alignas(32) float delayed[maxChunk];
+
+            while (pos < numSamples)
+            {
+                const int w = line.writeIndex;
+                const int span = juce::jmin(maxSpan, numSamples - pos, size - w);
+
+                readModulated(buf, line.mask, w, delayed, span, delay, offsets + pos);
+
+                float* __restrict dst = buf + w;
+                float* __restrict x = data + pos;
+
+                for (int k = 0; k < span; ++k)
+                {
+                    const float v = x[k] + g * delayed[k];
+                    dst[k] = v;
+                    x[k] = delayed[k] - g * v;
+                }
+
+                line.writeIndex = (w + span) & line.mask;
+                pos += span;
+            }
+        }
+
+        static void write(Line& line, const float* data, int numSamples)
+        {
+            const int size = line.mask + 1;
+            const int first = juce::jmin(numSamples, size - line.writeIndex);
+
+            float* buf = line.buffer.getWritePointer();
+            std::copy(data, data + first, buf + line.writeIndex);
+            std::copy(data + first, data + numSamples, buf);
+
+            line.writeIndex = (line.writeIndex + numSamples) & line.mask;
+        }
+
+        /**
+         * out[k] = buffer read at delay + offsets[k] behind position writeStart + k (linear interpolation).
+         * No sample-to-sample dependency, so this vectorises as a gather.
+         */
+        static void readModulated(const float* buf, int mask, int writeStart, float* __restrict out, int numSamples,
+                                  float delay, const float* __restrict offsets)
+        {
+            for (int k = 0; k < numSamples; ++k)
+            {
+                const float d = delay + offsets[k];
+                const int di = (int)d;
+                const float frac = d - (float)di;
+                const float a = buf[(writeStart + k - di) & mask];
+                const float b = buf[(writeStart + k - di - 1) & mask];
+                out[k] = a + frac * (b - a);
+            }
+        }
+
+
         double sampleRate = 44100.0;
-        
-        std::array<AllpassFilter, 3> diffusersL;
-        std::array<AllpassFilter, 3> diffusersR; // 3 series allpasses per channel
-        
-        DelayLine delayL;
-        DelayLine delayR;
-        
+
+        std::array<Line, 2 * numDiffusers> diffuserLines; // 3 series allpasses per channel, L then R
+        std::array<Line, 2> tapLines;
+
+        ModulationBank<numLanes> modulation;
+        std::array<std::array<float, maxChunk>, unusedLaneStart> laneOffsets {};
+        std::array<float, maxChunk> zeroOffsets {};
+
         float currentSizeMs = 300.0f;
         float currentCross = 0.1f;
+        float diffuserGain = 0.0f;
+        float modRate = 0.5f;
+        float modDepth = 0.0f;
+
+        RoomTapTable roomTaps, previousRoomTaps;
+        bool useRoomTaps = false;
+        bool fadeRoomTaps = false;
     };
 }
@@ -12,7 +12,7 @@ namespace DSP
 
         OnePoleFilter() = default;
 
-        void reset() { z1 = 0.0f; }
+        void reset() { z1 = 0.0f; x_prev = 0.0f; }
 
         void setCoefficients(double sampleRate, float frequency, Type filterType)
         {
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CpuDispatch.h"
+#include <bit>
+#include <cstdint>
+
+#if defined(__F16C__) || ANTIGRAV_X86_DISPATCH
+ #include <immintrin.h>
+#elif defined(__aarch64__)
+ #include <arm_neon.h>
+#endif
+
+namespace DSP
+{
+    /**
+     * @brief IEEE 754 half-precision conversion for compact delay storage.
+     *
+     * Only storage is 16 bit; everything that is computed stays float. Half floats keep 11
+     * significant bits, a relative error of at most 2^-11 (about -66 dB) per stored sample down to
+     * 6.1e-5 (-84 dBFS), below which the step is a fixed 6e-8. Rounding is to nearest even, the
+     * same as the hardware conversions.
+     *
+     * The block conversions use F16C (x86) or NEON (AArch64) where the build targets them. The
+     * scalar fallback has no branches, so the compiler can still vectorise it with plain SSE2.
+     * The Isa-templated overloads pick F16C at runtime instead, for kernels built per Isa.
+     */
+    namespace Float16
+    {
+        /** Rounds to the nearest half float; out-of-range values become infinity, NaN stays NaN. */
+        inline std::uint16_t fromFloat(float value) noexcept
+        {
+            // Round-to-nearest-even after F. Giesen, "float_to_half_fast3_rtne"
+            const std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+            const std::uint32_t sign = bits & 0x80000000u;
+            const std::uint32_t x = bits ^ sign;
+
+            // Subnormal results: adding the magic number lines the 10 mantissa bits up at the bottom
+            // and the FPU's own rounding does the rest
+            constexpr std::uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+            const float aligned = std::bit_cast<float>(x) + std::bit_cast<float>(denormMagic);
+            const std::uint32_t subnormal = std::bit_cast<std::uint32_t>(aligned) - denormMagic;
+
+            // Normal results: rebias the exponent, round half to even on the 13 dropped bits
+            const std::uint32_t mantissaOdd = (x >> 13) & 1u;
+            const std::uint32_t normal = (x + ((15u - 127u) << 23) + 0xfffu + mantissaOdd) >> 13;
+
+            const std::uint32_t special = x > 0x7f800000u ? 0x7e00u : 0x7c00u;
+            const std::uint32_t half = x >= 0x47800000u ? special : (x < 0x38800000u ? subnormal : normal);
+            return (std::uint16_t)(half | (sign >> 16));
+        }
+
+        /** Exact: every half float is a float. */
+        inline float toFloat(std::uint16_t half) noexcept
+        {
+            constexpr std::uint32_t shiftedExponent = 0x7c00u << 13;
+            constexpr float subnormalMagic = std::bit_cast<float>(113u << 23);
+
+            const std::uint32_t magnitude = ((std::uint32_t)half & 0x7fffu) << 13;
+            const std::uint32_t exponent = magnitude & shiftedExponent;
+            const std::uint32_t rebiased = magnitude + ((127u - 15u) << 23);
+
+            const std::uint32_t infOrNaN = rebiased + ((128u - 16u) << 23);
+            const std::uint32_t subnormal = std::bit_cast<std::uint32_t>(
+                std::bit_cast<float>(rebiased + (1u << 23)) - subnormalMagic);
+
+            const std::uint32_t bits = exponent == shiftedExponent ? infOrNaN : (exponent == 0 ? subnormal : rebiased);
+            return std::bit_cast<float>(bits | (((std::uint32_t)half & 0x8000u) << 16));
+        }
+
+        /** Converts numSamples floats to half floats. */
+        inline void fromFloat(const float* __restrict src, std::uint16_t* __restrict dest, int numSamples) noexcept
+        {
+            int i = 0;
+
+           #if defined(__F16C__)
+            for (; i + 8 <= numSamples; i += 8)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                                 _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+           #elif defined(__aarch64__)
+            for (; i + 4 <= numSamples; i += 4)
+                vst1_u16(dest + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+           #endif
+
+            for (; i < numSamples; ++i)
+                dest[i] = fromFloat(src[i]);
+        }
+
+        /** Converts numSamples half floats to floats. */
+        inline void toFloat(const std::uint16_t* __restrict src, float* __restrict dest, int numSamples) noexcept
+        {
+            int i = 0;
+
+           #if defined(__F16C__)
+            for (; i + 8 <= numSamples; i += 8)
+                _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+           #elif defined(__aarch64__)
+            for (; i + 4 <= numSamples; i += 4)
+                vst1q_f32(dest + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+           #endif
+
+            for (; i < numSamples; ++i)
+                dest[i] = toFloat(src[i]);
+        }
+
+       #if ANTIGRAV_X86_DISPATCH
+        ANTIGRAV_TARGET_AVX2 inline void fromFloatF16C(const float* __restrict src, std::uint16_t* __restrict dest, int numSamples) noexcept
+        {
+            int i = 0;
+            for (; i + 8 <= numSamples; i += 8)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                                 _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+
+            for (; i < numSamples; ++i)
+                dest[i] = fromFloat(src[i]);
+        }
+
+        ANTIGRAV_TARGET_AVX2 inline void toFloatF16C(const std::uint16_t* __restrict src, float* __restrict dest, int numSamples) noexcept
+        {
+            int i = 0;
+            for (; i + 8 <= numSamples; i += 8)
+                _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+
+            for (; i < numSamples; ++i)
+                dest[i] = toFloat(src[i]);
+        }
+       #endif
+
+        /** Block conversion for a kernel built for isa. */
+        template <Isa isa>
+        inline void fromFloat(const float* __restrict src, std::uint16_t* __restrict dest, int numSamples) noexcept
+        {
+           #if ANTIGRAV_X86_DISPATCH
+            if constexpr (isa != Isa::baseline)
+                return fromFloatF16C(src, dest, numSamples);
+           #endif
+
+            fromFloat(src, dest, numSamples);
+        }
+
+        template <Isa isa>
+        inline void toFloat(const std::uint16_t* __restrict src, float* __restrict dest, int numSamples) noexcept
+        {
+           #if ANTIGRAV_X86_DISPATCH
+            if constexpr (isa != Isa::baseline)
+                return toFloatF16C(src, dest, numSamples);
+           #endif
+
+            toFloat(src, dest, numSamples);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayMemory.h"
+#include "Float16.h"
+#include <array>
+#include <cmath>
+
+namespace DSP
+{
+    /**
+     * @brief NumLines delay lines stored as half floats, read and written one sample of every
+     * line per call, with the same timing and interpolation as DelayLine.
+     *
+     * Memory is interleaved per time step ([time][line]), so a push touches one contiguous run.
+     * Writes are staged as float for chunkLength samples and then converted as a single block;
+     * reads gather the two neighbours of every line and convert all of them in one go. The price of
+     * the staging is a minimum delay: anything shorter than chunkLength + 1 samples is lengthened
+     * to it, which an FDN with tens of milliseconds per line never gets near.
+     */
+    template <int NumLines>
+    class Float16DelayBank
+    {
+    public:
+        static constexpr int numLines = NumLines;
+        static constexpr int chunkLength = 16;
+
+        Float16DelayBank() = default;
+
+        void prepare(double sr, double maxDelayMs)
+        {
+            sampleRate = sr;
+
+            // A whole number of chunks, so a flush never wraps (not a power of two: that would give
+            // back most of what the half floats save)
+            const int needed = (int)std::ceil(maxDelayMs * sr / 1000.0) + 1 + chunkLength;
+            length = (needed + chunkLength - 1) / chunkLength * chunkLength;
+            ring.allocate((size_t)length * NumLines);
+            maxDelaySamples = (float)(length - chunkLength) - 1.01f;
+            reset();
+        }
+
+        void reset()
+        {
+            ring.clear();
+            writeIndex = 0;
+            numStaged = 0;
+        }
+
+        /** Frees the storage until the next prepare(). */
+        void release() { ring.release(); }
+
+        /** One sample of every line, delayMs[i] behind the last push. isa picks the conversion. */
+        template <Isa isa = Isa::baseline>
+        void read(const float* delayMs, float* out) const
+        {
+            const float msToSamples = (float)sampleRate / 1000.0f;
+            const float size = (float)length;
+            const std::uint16_t* data = ring.getReadPointer();
+
+            alignas(32) std::uint16_t packed[2 * NumLines];
+            alignas(32) float neighbours[2 * NumLines];
+            float frac[NumLines];
+
+            for (int i = 0; i < NumLines; ++i)
+            {
+                const float delaySamples = juce::jlimit((float)chunkLength + 1.0f, maxDelaySamples, delayMs[i] * msToSamples);
+                float readPos = (float)writeIndex - delaySamples;
+                readPos += readPos < 0.0f ? size : 0.0f;
+
+                const int index1 = juce::jmin((int)readPos, length - 1); // readPos may round up to size
+                const int index2 = index1 + 1 < length ? index1 + 1 : 0;
+                frac[i] = readPos - (float)index1;
+                packed[i] = data[index1 * NumLines + i];
+                packed[NumLines + i] = data[index2 * NumLines + i];
+            }
+
+            Float16::toFloat<isa>(packed, neighbours, 2 * NumLines);
+
+            for (int i = 0; i < NumLines; ++i)
+                out[i] = neighbours[i] + frac[i] * (neighbours[NumLines + i] - neighbours[i]);
+        }
+
+        /** Appends one sample to every line. */
+        template <Isa isa = Isa::baseline>
+        void push(const float* in)
+        {
+            std::copy(in, in + NumLines, staged.data() + numStaged * NumLines);
+            writeIndex = writeIndex + 1 < length ? writeIndex + 1 : 0;
+
+            if (++numStaged == chunkLength)
+                flush<isa>();
+        }
+
+        size_t getMemorySize() const { return ring.getMemorySize(); }
+
+    private:
+        template <Isa isa>
+        void flush()
+        {
+            numStaged = 0;
+            constexpr int numValues = chunkLength * NumLines;
+
+            // Silence into a ring that never held sound leaves its memory untouched
+            if (ring.isUntouched() && DelayMemory::isSilent(staged.data(), numValues))
+                return;
+
+            const int chunkStart = (writeIndex > 0 ? writeIndex : length) - chunkLength;
+            Float16::fromFloat<isa>(staged.data(), ring.getWritePointer() + chunkStart * NumLines, numValues);
+        }
+
+        double sampleRate = 44100.0;
+        BasicDelayMemory<std::uint16_t> ring;
+        int length = 0;
+        int writeIndex = 0;
+        float maxDelaySamples = 0.0f;
+
+        alignas(32) std::array<float, (size_t)(chunkLength * NumLines)> staged {};
+        int numStaged = 0;
+    };
+}
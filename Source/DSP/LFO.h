@@ -8,10 +8,38 @@ namespace DSP
     class LFO
     {
     public:
-        enum class Waveform { Sine, Triangle };
+        enum class Waveform { Sine, Triangle, SmoothRandom };
 
         LFO() = default;
 
+        /**
+         * @brief Shape of a waveform at a normalised phase [0, 1).
+         * SmoothRandom cosine-interpolates between the random values drawn at the start and end of a cycle.
+         */
+        static float evaluate(Waveform shape, float phase01, float randomFrom, float randomTo)
+        {
+            switch (shape)
+            {
+                case Waveform::Triangle:
+                {
+                    // Quarter-cycle shift so it starts at zero and rises, in phase with the sine
+                    float p = phase01 + 0.25f;
+                    p -= (float)(int)p;
+                    return 1.0f - 4.0f * std::abs(p - 0.5f);
+                }
+
+                case Waveform::SmoothRandom:
+                {
+                    float t = 0.5f - 0.5f * std::cos(phase01 * juce::MathConstants<float>::pi);
+                    return randomFrom + t * (randomTo - randomFrom);
+                }
+
+                case Waveform::Sine:
+                default:
+                    return std::sin(phase01 * juce::MathConstants<float>::twoPi);
+            }
+        }
+
         void prepare(double sr)
         {
             this->sampleRate = sr;
@@ -29,14 +57,28 @@ namespace DSP
             depth = d;
         }
 
+        void setWaveform(Waveform w)
+        {
+            waveform = w;
+        }
+
         float process()
         {
-            float out = (float)std::sin(phase) * depth;
-            
+            float out = 0.0f;
+
+            if (waveform == Waveform::Sine)
+                out = (float)std::sin(phase) * depth;
+            else
+                out = evaluate(waveform, (float)(phase / (2.0 * juce::MathConstants<double>::pi)), randomFrom, randomTo) * depth;
+
             phase += phaseIncrement;
             if (phase >= 2.0 * juce::MathConstants<double>::pi)
+            {
                 phase -= 2.0 * juce::MathConstants<double>::pi;
-                
+                randomFrom = randomTo;
+                randomTo = random.nextFloat() * 2.0f - 1.0f;
+            }
+
             return out;
         }
 
@@ -46,5 +88,10 @@ namespace DSP
         double phaseIncrement = 0.0;
         float frequency = 0.5f;
         float depth = 1.0f;
+        Waveform waveform = Waveform::Sine;
+
+        juce::Random random { 0x4c464f }; // Fixed seed keeps renders reproducible
+        float randomFrom = 0.0f;
+        float randomTo = 0.0f;
     };
 }
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #define ANTIGRAV_LARGE_BUFFER_MMAP 1
+#else
+ #define ANTIGRAV_LARGE_BUFFER_MMAP 0
+#endif
+
+namespace DSP
+{
+    /**
+     * @brief Zeroed float storage for delay memory of many megabytes.
+     *
+     * Large allocations are mapped straight from the OS (asking for transparent huge pages where
+     * available) instead of coming from the heap, and every page is touched in allocate(), so the
+     * audio thread never takes a page fault on first use. Small ones use a plain heap block.
+     * allocate() and release() belong on the message thread / in prepareToPlay().
+     */
+    class LargeBuffer
+    {
+    public:
+        /** Below this a heap block is used, mapping would only round it up to whole pages. */
+        static constexpr size_t mappedThresholdBytes = 1 << 20;
+
+        LargeBuffer() = default;
+        ~LargeBuffer() { release(); }
+
+        LargeBuffer(const LargeBuffer&) = delete;
+        LargeBuffer& operator=(const LargeBuffer&) = delete;
+
+        /** (Re)allocates numFloats zeroed and prefaulted samples. Keeps the memory if the size is unchanged. */
+        void allocate(size_t numFloats)
+        {
+            if (numFloats == numElements)
+            {
+                clear();
+                return;
+            }
+
+            release();
+
+            if (numFloats == 0)
+                return;
+
+            const size_t bytes = numFloats * sizeof(float);
+
+           #if ANTIGRAV_LARGE_BUFFER_MMAP
+            if (bytes >= mappedThresholdBytes)
+            {
+                mappedBytes = roundUp(bytes, hugePageSize);
+                void* p = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+
+                if (p != MAP_FAILED)
+                {
+                   #ifdef MADV_HUGEPAGE
+                    hugePages = madvise(p, mappedBytes, MADV_HUGEPAGE) == 0;
+                   #endif
+                    mapped = static_cast<float*>(p);
+                    elements = mapped;
+                }
+                else
+                {
+                    mappedBytes = 0;
+                }
+            }
+           #endif
+
+            if (elements == nullptr)
+            {
+                heap.calloc(numFloats);
+                elements = heap.get();
+            }
+
+            numElements = numFloats;
+            prefault();
+        }
+
+        void release()
+        {
+           #if ANTIGRAV_LARGE_BUFFER_MMAP
+            if (mapped != nullptr)
+                munmap(mapped, mappedBytes);
+           #endif
+
+            mapped = nullptr;
+            mappedBytes = 0;
+            hugePages = false;
+            heap.free();
+            elements = nullptr;
+            numElements = 0;
+        }
+
+        void clear()
+        {
+            if (elements != nullptr)
+                std::fill(elements, elements + numElements, 0.0f);
+        }
+
+        float* data() { return elements; }
+        const float* data() const { return elements; }
+        size_t size() const { return numElements; }
+
+        float& operator[](size_t i) { return elements[i]; }
+        float operator[](size_t i) const { return elements[i]; }
+
+        bool isMapped() const { return mapped != nullptr; }
+
+        /** True if the OS accepted the huge page hint (it may still back parts with small pages). */
+        bool usesHugePages() const { return hugePages; }
+
+        /** Bytes reserved for this buffer, including the rounding of mapped regions. */
+        size_t getAllocatedBytes() const { return mapped != nullptr ? mappedBytes : numElements * sizeof(float); }
+
+        /**
+         * @brief Bytes of this buffer currently held in physical memory.
+         * Asks the OS for mapped regions (mincore), heap blocks count as fully resident.
+         */
+        size_t getResidentBytes() const
+        {
+           #if ANTIGRAV_LARGE_BUFFER_MMAP
+            if (mapped != nullptr)
+            {
+                const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+                const size_t numPages = (mappedBytes + pageSize - 1) / pageSize;
+
+               #if JUCE_MAC
+                std::vector<char> residency(numPages);
+               #else
+                std::vector<unsigned char> residency(numPages);
+               #endif
+
+                if (mincore(mapped, mappedBytes, residency.data()) != 0)
+                    return mappedBytes;
+
+                size_t resident = 0;
+                for (auto r : residency)
+                    resident += (r & 1) ? pageSize : 0;
+
+                return resident;
+            }
+           #endif
+
+            return numElements * sizeof(float);
+        }
+
+    private:
+        static constexpr size_t hugePageSize = 2 << 20;
+
+        static size_t roundUp(size_t value, size_t multiple) { return (value + multiple - 1) / multiple * multiple; }
+
+        /** Writes to every page, so they are all backed before the audio thread gets here. */
+        void prefault()
+        {
+            constexpr size_t floatsPerPage = 4096 / sizeof(float);
+
+            for (size_t i = 0; i < numElements; i += floatsPerPage)
+                elements[i] = 0.0f;
+
+            if (numElements > 0)
+                elements[numElements - 1] = 0.0f;
+        }
+
+        float* elements = nullptr;
+        size_t numElements = 0;
+
+        float* mapped = nullptr;
+        size_t mappedBytes = 0;
+        bool hugePages = false;
+        juce::HeapBlock<float> heap;
+    };
+}
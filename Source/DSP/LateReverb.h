@@ -1,16 +1,55 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "DelayLine.h"
-#include "AllpassFilter.h"
-#include "Filters.h"
+#include "DelayArena.h"
+#include "Float16DelayBank.h"
+#include "CpuDispatch.h"
+#include "DampingFilterBank.h"
 #include "LFO.h"
+#include "ModulationBank.h"
+#include "DiffusionCascade.h"
+#include <algorithm>
 #include <array>
+#include <limits>
 
 namespace DSP
 {
+    /** Sample format of the FDN delay memory. */
+    enum class DelayStorage { float32 = 0, float16 };
+
+    /** Level of detail of an adaptive LateReverb, cheapest last. */
+    enum class TankDetail { full = 0, held, folded };
+
     /**
      * @brief Late Reverb engine using 8-channel FDN.
+     * The damping of all 8 lines (hi cut, lo cut and the optional low/high T60 shelves) runs as
+     * one DampingFilterBank, a sample of every line per call.
+     *
+     * The lines are float by default, packed into one DelayArena with each line only as long as
+     * its delay plus the modulation needs, and the first cache lines of every block prefetched.
+     * DelayStorage::float16 keeps them as half floats in a Float16DelayBank instead: half the
+     * memory and memory traffic, all arithmetic still float.
+     * Each stored sample is then off by up to 2^-11 relative, re-rounded on every trip around the
+     * loop; a 2 s tail stays about 70 dB below the signal away from the float version, well inside
+     * the 0.5 dB envelope tolerance of the golden files but not their 1e-4 sample tolerance.
+     *
+     * The per-sample tank (delay reads and writes, Householder mixing, damping, stereo mix-down)
+     * is built for every Isa; setIsa() picks the one that runs. Variants differ only in rounding,
+     * since the wider ones contract multiply-adds into FMAs.
+     *
+     * With adaptive detail on, the tank meters the energy of its lines every block and sheds cost
+     * as the tail decays, the thresholds relative to the recent peak of its input and lines. Below
+     * holdBelowDb (TankDetail::held) the modulation holds still and the lines are read at whole
+     * samples, the reads crossfading there over detailFadeMs. Below foldBelowDb
+     * (TankDetail::folded) half the lines drain into the other half, pairwise summed so their
+     * energy stays in the tank, while the output crossfades to the four-line mix; from then on
+     * four lines recirculate through a 4x4 Householder matrix. The kept lines, two per side,
+     * average the same length as all eight, so the loop and damping gains per second and with them
+     * the decay stay as they were. Input above foldBelowDb brings back full detail at the start of
+     * its block, with the LFOs skipped on by the time they were held, so the new input sees the
+     * modulation it would have at full detail; the reads crossfade back over detailFadeMs, less
+     * than the shortest line, so until the input comes round they only read what the tank held.
+     * The quiet steps run the baseline build whatever the Isa.
      */
     class LateReverb
     {
@@ -24,75 +63,349 @@ namespace DSP
             // FDN Delays: Prime numbers around 30-100ms
             const float baseDelays[8] = { 29.1f, 37.3f, 44.9f, 53.7f, 61.3f, 79.1f, 88.7f, 97.1f };
             
+            modulation.prepare(sampleRate);
+            
+            float lineMaxMs[8];
             for (int i = 0; i < 8; ++i)
             {
-                delayLines[i].prepare(sampleRate, 200.0); // Alloc enough buffer
                 nominalDelayTimes[i] = baseDelays[i];
+                lineMaxMs[i] = baseDelays[i] + maxModulationMs;
                 
-                lfos[i].prepare(sampleRate);
-                lfos[i].setFrequency(0.5f + (float)i * 0.05f); // Spread LFO rates slightly
-                lfos[i].setDepth(0.0f);
-                
-                hiCutFilters[i].reset();
-                loCutFilters[i].reset();
+                modulation.setFrequency((size_t)i, 0.5f + (float)i * 0.05f); // Spread LFO rates slightly
+                modulation.setDepth((size_t)i, 0.0f);
+            }
+
+            // Only the storage in use holds memory
+            preparedStorage = delayStorage;
+            if (preparedStorage == DelayStorage::float16)
+            {
+                compactLines.prepare(sampleRate, *std::max_element(std::begin(lineMaxMs), std::end(lineMaxMs)));
+                lines.release();
+            }
+            else
+            {
+                lines.prepare(sampleRate, lineMaxMs);
+                compactLines.release();
             }
+
+            updateDamping();
             
             // Input diffusers
-            for (auto& apf : inputDiffusersL) apf.prepare(sampleRate, 13.0);
-            for (auto& apf : inputDiffusersR) apf.prepare(sampleRate, 13.0);
+            inputDiffusion.prepare(sampleRate);
             
             reset();
         }
         
         void reset()
         {
-            for (auto& d : delayLines) d.reset();
+            lines.reset();
+            compactLines.reset();
+            inputDiffusion.reset();
+            modulation.reset();
+            damping.reset();
             std::fill(std::begin(outputs), std::end(outputs), 0.0f);
+
+            detail = TankDetail::full;
+            lineEnergy.fill(0.0f);
+            tankPower = 0.0f;
+            drainLeft = 0;
+            heldSamples = 0;
+            heldMix = 0.0f;
+            heldMixStep = 0.0f;
+            referenceLevel = 0.0f;
         }
 
         void setParameters(float decayTimeS, float modDepth, float modRate, float hiCut, float loCut)
         {
             // Calculate feedback gain from decay time (T60)
-            float avgDelayMs = 60.0f; // Approx
+            decayTime = decayTimeS;
             feedbackGain = std::pow(0.001f, (avgDelayMs / 1000.0f) / decayTimeS);
+            foldedFeedbackGain = std::pow(0.001f, (foldedDelayMs / 1000.0f) / decayTimeS);
             
-            // Modulation
+            // Modulation, within the maxModulationMs the lines are sized for
+            modDepth = juce::jlimit(0.0f, 1.0f, modDepth);
             for (int i = 0; i < 8; ++i)
             {
-                lfos[i].setFrequency(modRate * (0.9f + 0.02f * i)); // Slight variation
-                lfos[i].setDepth(modDepth * 3.0f); // Max 3 samples shift
-                
-                hiCutFilters[i].setCoefficients(sampleRate, hiCut, OnePoleFilter::Type::LowPass);
-                loCutFilters[i].setCoefficients(sampleRate, loCut, OnePoleFilter::Type::HighPass);
+                modulation.setFrequency((size_t)i, modRate * (0.9f + 0.02f * i)); // Slight variation
+                modulation.setDepth((size_t)i, modDepth * maxModulationMs);
+            }
+
+            dampingResponse.hiCutHz = hiCut;
+            dampingResponse.loCutHz = loCut;
+            updateDamping();
+        }
+
+        /**
+         * Frequency-dependent decay: the T60 below lowCrossoverHz and above highCrossoverHz is the
+         * decay time times the multiplier. Both multipliers at 1 leave only the hi and lo cut.
+         */
+        void setDecayShape(float lowMultiplier, float highMultiplier, float lowCrossoverHz, float highCrossoverHz)
+        {
+            lowDecayMultiplier = juce::jmax(0.01f, lowMultiplier);
+            highDecayMultiplier = juce::jmax(0.01f, highMultiplier);
+            dampingResponse.lowCrossoverHz = lowCrossoverHz;
+            dampingResponse.highCrossoverHz = highCrossoverHz;
+            updateDamping();
+        }
+
+        /** Input diffusion ahead of the FDN: amount 0..1 scales the allpass gain, stages 0 bypasses. */
+        void setInputDiffusion(float amount, int numStages)
+        {
+            inputDiffusion.setFeedback(amount * 0.75f);
+            inputDiffusion.setNumStages(numStages);
+        }
+
+        /** Kernel variant, normally CpuDispatch::select(); it must be supported by this CPU. */
+        void setIsa(Isa newIsa)
+        {
+            jassert(CpuDispatch::isSupported(newIsa));
+            isa = newIsa;
+        }
+
+        Isa getIsa() const { return isa; }
+
+        /** Takes effect at the next prepare(), which (re)allocates the lines. */
+        void setDelayStorage(DelayStorage storage) { delayStorage = storage; }
+        DelayStorage getDelayStorage() const { return preparedStorage; }
+
+        /**
+         * Line levels (RMS of the eight lines together) below which an adaptive tank steps down,
+         * relative to the recent peak of the input and the lines. That reference falls by
+         * referenceReleaseDbPerS, slower than all but the longest tails, and stops at
+         * referenceFloorDb, so silence from the start still steps down.
+         */
+        static constexpr float holdBelowDb = -60.0f;
+        static constexpr float foldBelowDb = -80.0f;
+        static constexpr float referenceReleaseDbPerS = 6.0f;
+        static constexpr float referenceFloorDb = -100.0f;
+
+        /** Length of the crossfade between modulated and held reads, either way. */
+        static constexpr float detailFadeMs = 10.0f;
+
+        /**
+         * Adaptive detail, see above. Float lines only: with half-float lines, and while frozen,
+         * the tank runs at full detail.
+         */
+        void setAdaptiveDetail(bool shouldAdapt) { adaptive = shouldAdapt; }
+        bool getAdaptiveDetail() const { return adaptive; }
+
+        /** Detail the last block ran at. */
+        TankDetail getDetail() const { return detail; }
+
+        void setModulationShape(LFO::Waveform shape)
+        {
+            modulation.setWaveform(shape);
+        }
+
+        /**
+         * Upper bound on how long an input is heard, in ms, down to belowDb (infinite while frozen).
+         * Every line loses the same gain per trip and the Householder matrix only moves energy
+         * between lines, so no mode decays slower than the longest line on its own; the input
+         * diffusion rings ahead of that.
+         */
+        float getSettlingMs(float belowDb) const
+        {
+            if (frozen)
+                return std::numeric_limits<float>::infinity();
+
+            const float longestLineMs = *std::max_element(std::begin(nominalDelayTimes), std::end(nominalDelayTimes)) + maxModulationMs;
+            const float longestDecayS = decayTime * (longestLineMs / avgDelayMs)
+                                      * juce::jmax(1.0f, lowDecayMultiplier, highDecayMultiplier);
+
+            return inputDiffusion.getSettlingMs(belowDb) + longestDecayS * 1000.0f * belowDb / 60.0f;
+        }
+
+        /** Moves the line modulation on by numSamples without processing. */
+        void skipModulation(juce::int64 numSamples)
+        {
+            modulation.skip(numSamples);
+        }
+
+        /**
+         * Infinite hold: the tank stops taking input and recirculates losslessly
+         * (unity Householder feedback, damping filters bypassed). The modulation holds still and
+         * the lines are read at the nearest whole sample to where it left them, so no interpolation
+         * dulls the tail trip after trip; it resumes from there on release.
+         */
+        void setFreeze(bool shouldFreeze)
+        {
+            if (shouldFreeze && ! frozen)
+            {
+                const float msToSamples = (float)sampleRate / 1000.0f;
+                const float* offsets = modulation.getValues();
+
+                for (int i = 0; i < 8; ++i)
+                    frozenOffsets[i] = (float)std::lround((nominalDelayTimes[i] + offsets[i]) * msToSamples) / msToSamples
+                                     - nominalDelayTimes[i];
             }
+
+            frozen = shouldFreeze;
         }
 
-        void processBlock(juce::AudioBuffer<float>& buffer)
+        size_t getMemorySize() const
         {
+            return inputDiffusion.getMemorySize() + lines.getMemorySize() + compactLines.getMemorySize();
+        }
+
+        /**
+         * Processes a block in place. With monoInput only channel 0 holds input: one diffusion
+         * chain runs and the source is injected into all eight lines. The buffer may then have one
+         * channel (mono out, the left sum) or two (mono to stereo).
+         */
+        void processBlock(juce::AudioBuffer<float>& buffer, bool monoInput = false)
+        {
+            jassert(monoInput || buffer.getNumChannels() > 1);
+
             auto* left = buffer.getWritePointer(0);
-            auto* right = buffer.getWritePointer(1);
+            auto* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
             int numSamples = buffer.getNumSamples();
 
+            // Diffuse Input, the whole block at once before it enters the tank
+            inputDiffusion.process(left, monoInput ? nullptr : right, numSamples);
+
+            // Mono to stereo: both halves of the tank take the one source
+            if (monoInput && right != nullptr)
+                juce::FloatVectorOperations::copy(right, left, numSamples);
+
+            updateDetail(left, right, numSamples);
+
+            if (detail != TankDetail::full)
+            {
+                processQuietTank(left, right, numSamples);
+            }
+            else if (heldMixStep != 0.0f)
+            {
+                processDetailFade(left, right, numSamples);
+            }
+            else
+            {
+                switch (isa)
+                {
+                   #if ANTIGRAV_X86_DISPATCH
+                    case Isa::avx512: processTankAvx512(left, right, numSamples); break;
+                    case Isa::avx2:   processTankAvx2(left, right, numSamples); break;
+                   #endif
+                    default:          processTankFor<Isa::baseline>(left, right, numSamples); break;
+                }
+            }
+
+            if (numSamples > 0)
+            {
+                tankPower = 0.0f;
+                for (auto e : lineEnergy) tankPower += e;
+                tankPower /= (float)numSamples;
+                lineEnergy.fill(0.0f);
+            }
+        }
+
+    private:
+       #if ANTIGRAV_X86_DISPATCH
+        ANTIGRAV_TARGET_AVX2 void processTankAvx2(float* left, float* right, int numSamples)
+        {
+            processTankFor<Isa::avx2>(left, right, numSamples);
+        }
+
+        ANTIGRAV_TARGET_AVX512 void processTankAvx512(float* left, float* right, int numSamples)
+        {
+            processTankFor<Isa::avx512>(left, right, numSamples);
+        }
+       #endif
+
+        template <Isa kernelIsa>
+        JUCE_FORCEDINLINE void processTankFor(float* left, float* right, int numSamples)
+        {
+            if (preparedStorage == DelayStorage::float16)
+            {
+                processTank(left, right, numSamples,
+                            [this](const float* delayMs, float* out) { compactLines.template read<kernelIsa>(delayMs, out); },
+                            [this](const float* in) { compactLines.template push<kernelIsa>(in); },
+                            [](const float*, int) {});
+            }
+            else
+            {
+                processTank(left, right, numSamples,
+                            [this](const float* delayMs, float* out) { lines.read(delayMs, out); },
+                            [this](const float* in) { lines.push(in); },
+                            [this](const float* delayMs, int samplesAhead) { lines.prefetch(delayMs, samplesAhead); });
+            }
+        }
+
+        /**
+         * The FDN itself; readLines(delayMs, out) and pushLines(in) handle all 8 lines at once, and
+         * prefetchLines(delayMs, samplesAhead) is told at the start of the block where they go first.
+         * A nullptr right channel runs it mono: left feeds both halves and only the left sum comes out.
+         * Force-inlined, so each Isa wrapper gets its own copy built for its instruction set.
+         */
+        template <typename ReadLines, typename PushLines, typename PrefetchLines>
+        JUCE_FORCEDINLINE void processTank(float* left, float* right, int numSamples,
+                                           ReadLines&& readLines, PushLines&& pushLines, PrefetchLines&& prefetchLines)
+        {
+
+            // Modulation runs at control rate: the LFOs are evaluated once per segment
+            // and the delay offsets ramp linearly across it.
+            const float loopGain = frozen ? 1.0f : feedbackGain;
+            const float inputGain = frozen ? 0.0f : 1.0f;
+
+            alignas(32) float modOffsets[8];
+            alignas(32) float energy[8] = {};
+            static constexpr float stillIncrements[8] = {};
+            const float* modIncrements = frozen ? stillIncrements : modulation.getIncrements();
+            int segmentLeft = 0;
+
             for (int n = 0; n < numSamples; ++n)
             {
-                float inL = left[n];
-                float inR = right[n];
-                
-                // Diffuse Input
-                // ... (simplified loop for brevity)
+                if (segmentLeft == 0)
+                {
+                    if (frozen)
+                    {
+                        segmentLeft = numSamples - n;
+                        std::copy(frozenOffsets, frozenOffsets + 8, modOffsets);
+                    }
+                    else
+                    {
+                        if (modulation.getSamplesUntilTick() == 0)
+                            modulation.tick();
+
+                        segmentLeft = juce::jmin(modulation.getSamplesUntilTick(), numSamples - n);
+                        std::copy(modulation.getValues(), modulation.getValues() + 8, modOffsets);
+                        modulation.advance(segmentLeft);
+                    }
+
+                    // Other instances may have had the cache since the last block: ask for the
+                    // start of every stream before the hardware prefetcher has seen it again
+                    if (n == 0)
+                    {
+                        float segmentMs[8];
+                        for (int i = 0; i < 8; ++i)
+                            segmentMs[i] = nominalDelayTimes[i] + modOffsets[i];
+
+                        for (int ahead = 0; ahead < prefetchSamples; ahead += DelayArena<8>::cacheLineFloats)
+                            prefetchLines(segmentMs, ahead);
+                    }
+                }
+
+                --segmentLeft;
+
+                float inL = left[n] * inputGain;
+                float inR = (right != nullptr ? right[n] : left[n]) * inputGain;
                 
                 // FDN mixing (Hadamard-like or Householder)
                 // New inputs to delays = Input + Matrix * DelayedValues
                 // Simple Householder: y = x - 2/N * sum(x)
                 
                 // Read from all delays first
-                float delayOuts[8];
+                float delayMs[8], delayOuts[8];
                 for (int i = 0; i < 8; ++i)
-                {
-                   float mod = lfos[i].process();
-                   delayOuts[i] = delayLines[i].read(nominalDelayTimes[i] + mod);
-                   outputs[i] = delayOuts[i]; // Store filter state if needed
-                }
+                    delayMs[i] = nominalDelayTimes[i] + modOffsets[i];
+
+                readLines(delayMs, delayOuts);
+                std::copy(delayOuts, delayOuts + 8, outputs); // Store filter state if needed
+
+                for (int i = 0; i < 8; ++i)
+                    energy[i] += delayOuts[i] * delayOuts[i];
+                
+                for (int i = 0; i < 8; ++i)
+                    modOffsets[i] += modIncrements[i];
                 
                 // Matrix (Householder)
                 // input vector 'x' is delayOuts scaled by feedback + new input
@@ -101,25 +414,21 @@ namespace DSP
                 for (int i = 0; i < 8; ++i) sum += delayOuts[i];
                 sum *= (2.0f / 8.0f);
                 
-                float feedbackOuts[8];
+                alignas(32) float feedbackOuts[8];
                 for (int i = 0; i < 8; ++i)
                 {
                     float matrixOut = delayOuts[i] - sum; // Householder
                     // Add input (distribute to channels)
                     // L -> 0,1,2,3. R -> 4,5,6,7
                     float injection = (i < 4) ? inL : inR;
-                    feedbackOuts[i] = injection + matrixOut * feedbackGain;
+                    feedbackOuts[i] = injection + matrixOut * loopGain;
                 }
                 
                 // Filter and Push
-                for (int i = 0; i < 8; ++i)
-                {
-                    float processed = feedbackOuts[i];
-                    processed = hiCutFilters[i].process(processed);
-                    processed = loCutFilters[i].process(processed);
-                    
-                    delayLines[i].push(processed);
-                }
+                if (! frozen)
+                    damping.process(feedbackOuts);
+
+                pushLines(feedbackOuts);
                 
                 // Output Mix
                 // Sum stereo groups
@@ -127,24 +436,296 @@ namespace DSP
                 float outR = delayOuts[4] + delayOuts[5] + delayOuts[6] + delayOuts[7];
                 
                 left[n] = outL * 0.3f; // Scaling
-                right[n] = outR * 0.3f;
+                if (right != nullptr)
+                    right[n] = outR * 0.3f;
             }
+
+            for (int i = 0; i < 8; ++i)
+                lineEnergy[(size_t)i] += energy[i];
         }
 
-    private:
+        /** Picks the block's detail from its input and the energy the last block left in the lines. */
+        void updateDetail(const float* left, const float* right, int numSamples)
+        {
+            if (! adaptive || frozen || preparedStorage != DelayStorage::float32)
+            {
+                unhold();
+                return;
+            }
+
+            auto peak = [numSamples](const float* x)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(x, numSamples);
+                return juce::jmax(-range.getStart(), range.getEnd());
+            };
+
+            const float inputPeak = juce::jmax(peak(left), right != nullptr ? peak(right) : 0.0f);
+            const float tankLevel = std::sqrt(tankPower);
+            const float reference = juce::jmax(referenceLevel, juce::Decibels::decibelsToGain(referenceFloorDb));
+            const float holdLevel = reference * juce::Decibels::decibelsToGain(holdBelowDb);
+            const float foldLevel = reference * juce::Decibels::decibelsToGain(foldBelowDb);
+
+            const float release = juce::Decibels::decibelsToGain(-referenceReleaseDbPerS * (float)numSamples / (float)sampleRate);
+            referenceLevel = juce::jmax(referenceLevel * release, inputPeak, tankLevel);
+
+            if (inputPeak > foldLevel)
+                unhold();
+            else if (detail == TankDetail::full && heldMix == 0.0f && tankLevel < holdLevel)
+                hold();
+            else if (detail == TankDetail::held && tankLevel < foldLevel)
+                fold();
+        }
+
+        /**
+         * Freezes the line delays where the modulation is now, rounded to whole samples. The reads
+         * fade over to them at full detail first, the modulation still running.
+         */
+        void hold()
+        {
+            const float msToSamples = (float)sampleRate / 1000.0f;
+            const float* offsets = modulation.getValues();
+
+            for (int i = 0; i < 8; ++i)
+                wholeDelays[i] = juce::jlimit(1, lines.getLength(i) - 1, (int)std::lround((nominalDelayTimes[i] + offsets[i]) * msToSamples));
+
+            heldMixStep = 1.0f / getDetailFadeSamples();
+        }
+
+        /**
+         * Back to full detail, the modulation where it would be had it never held, the reads fading
+         * back from the held ones (or from wherever a fade towards them had got to).
+         */
+        void unhold()
+        {
+            if (detail != TankDetail::full)
+            {
+                modulation.skip(heldSamples);
+                heldSamples = 0;
+                detail = TankDetail::full;
+                heldMix = 1.0f;
+            }
+
+            heldMixStep = heldMix > 0.0f ? -1.0f / getDetailFadeSamples() : 0.0f;
+        }
+
+        float getDetailFadeSamples() const
+        {
+            return juce::jmax(1.0f, detailFadeMs * (float)sampleRate / 1000.0f);
+        }
+
+        /**
+         * Starts draining the lines a fold drops. They are fed silence for as far back as a
+         * full-detail read could reach, so a later unfold finds them holding only what was not
+         * drained yet.
+         */
+        void fold()
+        {
+            float longestMs = 0.0f;
+            for (int i : droppedLines)
+                longestMs = juce::jmax(longestMs, nominalDelayTimes[i] + maxModulationMs);
+
+            drainLength = (int)std::ceil(longestMs * sampleRate / 1000.0) + 2;
+            drainLeft = drainLength;
+            detail = TankDetail::folded;
+        }
+
+        /**
+         * Full detail with every read blended towards its held, whole-sample one by heldMix, which
+         * moves by heldMixStep a sample; a fade that reaches the held reads leaves the tank held.
+         * Float lines only, baseline build.
+         */
+        void processDetailFade(float* left, float* right, int numSamples)
+        {
+            processTank(left, right, numSamples,
+                        [this](const float* delayMs, float* out)
+                        {
+                            lines.read(delayMs, out);
+                            heldMix = juce::jlimit(0.0f, 1.0f, heldMix + heldMixStep);
+
+                            for (int i = 0; i < 8; ++i)
+                                out[i] += heldMix * (lines.readWhole(i, wholeDelays[i]) - out[i]);
+                        },
+                        [this](const float* in) { lines.push(in); },
+                        [this](const float* delayMs, int samplesAhead) { lines.prefetch(delayMs, samplesAhead); });
+
+            if (heldMix == 1.0f)
+                detail = TankDetail::held;
+
+            if (heldMix == 1.0f || heldMix == 0.0f)
+                heldMixStep = 0.0f;
+        }
+
+        enum class QuietStep { held, draining, folded };
+
+        void processQuietTank(float* left, float* right, int numSamples)
+        {
+            heldSamples += numSamples;
+            int n = 0;
+
+            if (detail == TankDetail::folded && drainLeft > 0)
+            {
+                n = juce::jmin(numSamples, drainLeft);
+                processQuietSpan<QuietStep::draining>(left, right, 0, n);
+                drainLeft -= n;
+            }
+
+            if (detail == TankDetail::held)
+                processQuietSpan<QuietStep::held>(left, right, n, numSamples);
+            else
+                processQuietSpan<QuietStep::folded>(left, right, n, numSamples);
+        }
+
+        /** The tank at reduced detail over [start, end): held modulation and whole-sample reads. */
+        template <QuietStep step>
+        void processQuietSpan(float* left, float* right, int start, int end)
+        {
+            const float loopGain = step == QuietStep::held ? feedbackGain : foldedFeedbackGain;
+            const float fadeStep = 1.0f / (float)drainLength;
+            const int drained = drainLength - drainLeft;
+
+            for (int n = start; n < end; ++n)
+            {
+                const float inL = left[n];
+                const float inR = right != nullptr ? right[n] : left[n];
+
+                alignas(32) float delayOuts[8] = {};
+                if constexpr (step == QuietStep::folded)
+                {
+                    for (int i : keptLines)
+                        delayOuts[i] = lines.readWhole(i, wholeDelays[i]);
+                }
+                else
+                {
+                    for (int i = 0; i < 8; ++i)
+                        delayOuts[i] = lines.readWhole(i, wholeDelays[i]);
+                }
+
+                for (int i = 0; i < 8; ++i)
+                    lineEnergy[(size_t)i] += delayOuts[i] * delayOuts[i];
+
+                alignas(32) float feedbackOuts[8] = {};
+                float outL = delayOuts[0] + delayOuts[1] + delayOuts[2] + delayOuts[3];
+                float outR = delayOuts[4] + delayOuts[5] + delayOuts[6] + delayOuts[7];
+
+                if constexpr (step == QuietStep::held)
+                {
+                    float sum = 0.0f;
+                    for (int i = 0; i < 8; ++i) sum += delayOuts[i];
+                    sum *= (2.0f / 8.0f);
+
+                    for (int i = 0; i < 8; ++i)
+                        feedbackOuts[i] = (i < 4 ? inL : inR) + (delayOuts[i] - sum) * loopGain;
+                }
+                else
+                {
+                    // Each dropped line (silent once drained) adds to its kept partner, then a 4x4 Householder
+                    float paired[4];
+                    float sum = 0.0f;
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        paired[k] = delayOuts[keptLines[k]] + delayOuts[droppedLines[k]];
+                        sum += paired[k];
+                    }
+                    sum *= (2.0f / 4.0f);
+
+                    for (int k = 0; k < 4; ++k)
+                        feedbackOuts[keptLines[k]] = (k < 2 ? inL : inR) + (paired[k] - sum) * loopGain;
+
+                    // Each kept line carries twice the energy, so two per side match the eight-line mix
+                    const float foldedL = delayOuts[keptLines[0]] + delayOuts[keptLines[1]];
+                    const float foldedR = delayOuts[keptLines[2]] + delayOuts[keptLines[3]];
+
+                    if constexpr (step == QuietStep::draining)
+                    {
+                        const float fade = (float)(drained + n - start + 1) * fadeStep;
+                        outL += fade * (foldedL - outL);
+                        outR += fade * (foldedR - outR);
+                    }
+                    else
+                    {
+                        outL = foldedL;
+                        outR = foldedR;
+                    }
+                }
+
+                damping.process(feedbackOuts);
+
+                if constexpr (step == QuietStep::held)
+                {
+                    lines.push(feedbackOuts);
+                }
+                else
+                {
+                    for (int i : keptLines)
+                        lines.pushLine(i, feedbackOuts[i]);
+
+                    if constexpr (step == QuietStep::draining)
+                        for (int i : droppedLines)
+                            lines.pushLine(i, 0.0f);
+                }
+
+                left[n] = outL * 0.3f;
+                if (right != nullptr)
+                    right[n] = outR * 0.3f;
+            }
+        }
+
+        /**
+         * Band gains relative to the mid loop gain, over the same average delay as feedbackGain,
+         * so the loop gain of every band stays below 1 whatever the multipliers.
+         */
+        void updateDamping()
+        {
+            const float midExponent = (avgDelayMs / 1000.0f) / decayTime;
+            dampingResponse.lowGain = std::pow(0.001f, midExponent * (1.0f / lowDecayMultiplier - 1.0f));
+            dampingResponse.highGain = std::pow(0.001f, midExponent * (1.0f / highDecayMultiplier - 1.0f));
+
+            for (int i = 0; i < 8; ++i)
+                damping.setLane(i, sampleRate, dampingResponse);
+        }
+
+        static constexpr float avgDelayMs = 60.0f; // Approx
+        // A fold keeps two lines per side, averaging about avgDelayMs, and drains each dropped one into its partner
+        static constexpr int keptLines[4] = { 1, 3, 4, 6 };
+        static constexpr int droppedLines[4] = { 0, 2, 5, 7 };
+        static constexpr float foldedDelayMs = (37.3f + 53.7f + 61.3f + 88.7f) / 4.0f;
+        static constexpr float maxModulationMs = 3.0f; // Line shift at full depth
+        static constexpr int prefetchSamples = 64;      // Prefetched at block start, per read and write
+
         double sampleRate = 44100.0;
         
-        std::array<DelayLine, 8> delayLines;
-        std::array<LFO, 8> lfos;
+        DelayArena<8> lines;
+        Float16DelayBank<8> compactLines;
+        DelayStorage delayStorage = DelayStorage::float32;
+        DelayStorage preparedStorage = DelayStorage::float32;
+        Isa isa = Isa::baseline;
+        ModulationBank<8> modulation;
         float nominalDelayTimes[8];
         float outputs[8];
         
-        std::array<AllpassFilter, 2> inputDiffusersL;
-        std::array<AllpassFilter, 2> inputDiffusersR;
+        DiffusionCascade inputDiffusion;
 
-        std::array<OnePoleFilter, 8> hiCutFilters;
-        std::array<OnePoleFilter, 8> loCutFilters;
+        DampingFilterBank<8> damping;
+        DampingResponse dampingResponse;
+        float lowDecayMultiplier = 1.0f;
+        float highDecayMultiplier = 1.0f;
 
+        float decayTime = 2.0f;
         float feedbackGain = 0.5f;
+        float foldedFeedbackGain = 0.5f;
+        bool frozen = false;
+        float frozenOffsets[8] = {};         // Held modulation, the reads on whole samples
+
+        bool adaptive = false;
+        TankDetail detail = TankDetail::full;
+        std::array<float, 8> lineEnergy {};  // Squared line outputs, summed over the block so far
+        float tankPower = 0.0f;              // Last block's mean square, summed over the lines
+        int wholeDelays[8] = {};
+        int drainLength = 1;
+        int drainLeft = 0;
+        juce::int64 heldSamples = 0;         // Modulation time that passed while held
+        float heldMix = 0.0f;                // Share of the held reads at full detail, 1 once held
+        float heldMixStep = 0.0f;            // Per sample, while fading either way
+        float referenceLevel = 0.0f;         // Recent peak of the input and the lines, released
     };
 }
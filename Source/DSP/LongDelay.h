@@ -0,0 +1,152 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LargeBuffer.h"
+
+namespace DSP
+{
+    /**
+     * @brief Stereo delay of up to tens of seconds, used as long predelay / pre-echo ahead of the engine.
+     *
+     * Whole-sample delay, the block is copied in and out of the ring in at most two spans per
+     * channel. Changing the delay time crossfades between the old and new read positions instead
+     * of sweeping (which would pitch-shift seconds of audio). Storage is a LargeBuffer, so it is
+     * mapped and prefaulted in prepare(), and only replaced when the capacity or a higher rate needs it.
+     */
+    class LongDelay
+    {
+    public:
+        LongDelay() = default;
+
+        /** maxSeconds 0 releases the memory and turns the delay into a plain copy. */
+        void prepare(double sr, double maxSeconds, int maxBlockSize)
+        {
+            sampleRate = sr;
+            maxDelay = juce::jmax(0, (int)std::ceil(maxSeconds * sr));
+            length = maxDelay > 0 ? maxDelay + juce::jmax(1, maxBlockSize) + 1 : 0;
+
+            // A re-prepare at the same or a lower rate keeps the (already prefaulted) line
+            const size_t needed = (size_t)length * 2;
+            if (needed == 0 || needed > buffer.size() || maxSeconds != preparedSeconds)
+                buffer.allocate(needed);
+
+            preparedSeconds = maxSeconds;
+            fadeLength = juce::jmax(1, (int)(crossfadeMs * 0.001 * sr));
+            targetDelay = juce::jmin(targetDelay, maxDelay);
+            reset();
+        }
+
+        void reset()
+        {
+            // Only the part in use, the line may be larger after a rate change
+            if (length > 0)
+                std::fill(buffer.data(), buffer.data() + (size_t)length * 2, 0.0f);
+
+            writeIndex = 0;
+            delay = targetDelay;
+            fadeFrom = targetDelay;
+            fadePosition = fadeLength;
+        }
+
+        void setDelaySeconds(float seconds)
+        {
+            targetDelay = juce::jlimit(0, maxDelay, (int)std::lround(seconds * sampleRate));
+        }
+
+        double getMaxDelaySeconds() const { return maxDelay / sampleRate; }
+        bool isEnabled() const { return length > 0; }
+
+        const LargeBuffer& getStorage() const { return buffer; }
+
+        /**
+         * numSamples must not exceed the prepared block size. Outputs may alias the inputs.
+         * A mono source passes nullptr for both inR and outR.
+         */
+        void process(const float* inL, const float* inR, float* outL, float* outR, int numSamples)
+        {
+            jassert((inR == nullptr) == (outR == nullptr));
+
+            if (length == 0)
+            {
+                if (outL != inL) juce::FloatVectorOperations::copy(outL, inL, numSamples);
+                if (outR != inR) juce::FloatVectorOperations::copy(outR, inR, numSamples);
+                return;
+            }
+
+            const int blockStart = writeIndex;
+            write(channel(0), inL, numSamples);
+            if (inR != nullptr)
+                write(channel(1), inR, numSamples);
+            writeIndex = wrap(writeIndex + numSamples);
+
+            // A new time only starts once the previous crossfade has finished
+            if (fadePosition >= fadeLength && targetDelay != delay)
+            {
+                fadeFrom = delay;
+                delay = targetDelay;
+                fadePosition = 0;
+            }
+
+            if (fadePosition >= fadeLength)
+            {
+                read(channel(0), wrap(blockStart - delay), outL, numSamples);
+                if (outR != nullptr)
+                    read(channel(1), wrap(blockStart - delay), outR, numSamples);
+                return;
+            }
+
+            const float step = 1.0f / (float)fadeLength;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float t = fadePosition < fadeLength ? (float)fadePosition * step : 1.0f;
+                int oldIndex = wrap(blockStart + i - fadeFrom);
+                int newIndex = wrap(blockStart + i - delay);
+
+                outL[i] = channel(0)[oldIndex] * (1.0f - t) + channel(0)[newIndex] * t;
+                if (outR != nullptr)
+                    outR[i] = channel(1)[oldIndex] * (1.0f - t) + channel(1)[newIndex] * t;
+
+                fadePosition = juce::jmin(fadePosition + 1, fadeLength);
+            }
+        }
+
+    private:
+        static constexpr double crossfadeMs = 20.0;
+
+        float* channel(int ch) { return buffer.data() + (size_t)ch * (size_t)length; }
+
+        int wrap(int index) const
+        {
+            index %= length;
+            return index < 0 ? index + length : index;
+        }
+
+        void write(float* ring, const float* src, int numSamples)
+        {
+            int first = juce::jmin(numSamples, length - writeIndex);
+            juce::FloatVectorOperations::copy(ring + writeIndex, src, first);
+            juce::FloatVectorOperations::copy(ring, src + first, numSamples - first);
+        }
+
+        void read(const float* ring, int start, float* dest, int numSamples) const
+        {
+            int first = juce::jmin(numSamples, length - start);
+            juce::FloatVectorOperations::copy(dest, ring + start, first);
+            juce::FloatVectorOperations::copy(dest + first, ring, numSamples - first);
+        }
+
+        double sampleRate = 44100.0;
+        LargeBuffer buffer;         // L then R, length samples each
+        int length = 0;
+        int maxDelay = 0;
+        double preparedSeconds = 0.0;
+        int writeIndex = 0;
+
+        int delay = 0;
+        int targetDelay = 0;
+        int fadeFrom = 0;
+        int fadeLength = 1;
+        int fadePosition = 1;
+    };
+}
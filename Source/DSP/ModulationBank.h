@@ -0,0 +1,158 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LFO.h"
+#include <array>
+
+namespace DSP
+{
+    /**
+     * @brief A bank of N LFOs evaluated at a decimated control rate.
+     *
+     * Every controlInterval samples the waveforms are evaluated once per lane and a per-sample
+     * increment is derived, so the caller only has to ramp the offsets linearly in between
+     * (one vectorisable add per sample for all lanes). At 0.1 - 5 Hz the linear segments
+     * are indistinguishable from the per-sample LFO.
+     */
+    template <size_t NumLanes>
+    class ModulationBank
+    {
+    public:
+        static constexpr int defaultControlInterval = 16;
+
+        ModulationBank() = default;
+
+        void prepare(double sr, int interval = defaultControlInterval)
+        {
+            sampleRate = sr;
+            controlInterval = juce::jmax(1, interval);
+            reset();
+        }
+
+        void reset()
+        {
+            phases.fill(0.0f);
+            values.fill(0.0f);
+            increments.fill(0.0f);
+            samplesUntilTick = 0;
+
+            for (size_t i = 0; i < NumLanes; ++i)
+            {
+                randomFrom[i] = 0.0f;
+                randomTo[i] = random.nextFloat() * 2.0f - 1.0f;
+            }
+        }
+
+        void setFrequency(size_t lane, float hz) { phaseIncrements[lane] = hz / (float)sampleRate; }
+        void setDepth(size_t lane, float d) { depths[lane] = d; }
+        void setWaveform(LFO::Waveform w) { waveform = w; }
+
+        int getControlInterval() const { return controlInterval; }
+
+        /** Lets the bank start at a given phase (in cycles) per lane, e.g. to decorrelate lanes. */
+        void setPhase(size_t lane, float phase01) { phases[lane] = phase01 - (float)(int)phase01; }
+
+        /**
+         * @brief Number of samples the current linear segment is still valid for.
+         * When it reaches zero, call tick() before processing more samples.
+         */
+        int getSamplesUntilTick() const { return samplesUntilTick; }
+
+        /**
+         * @brief Evaluates the LFOs at the end of the next control period and computes the ramp towards it.
+         * After this, getValues() holds the current offsets and getIncrements() the per-sample step.
+         */
+        void tick()
+        {
+            const float periodSamples = (float)controlInterval;
+            const float invPeriod = 1.0f / periodSamples;
+
+            for (size_t i = 0; i < NumLanes; ++i)
+            {
+                stepPhase(i, periodSamples);
+                float next = LFO::evaluate(waveform, phases[i], randomFrom[i], randomTo[i]) * depths[i];
+                increments[i] = (next - values[i]) * invPeriod;
+            }
+
+            samplesUntilTick = controlInterval;
+        }
+
+        /**
+         * @brief Moves the bank on by numSamples as if they had been ticked and advanced.
+         * Whole control periods only step the phases (and draw the random targets), with the same
+         * arithmetic as tick(), so phases and random sequence come out exactly as after running;
+         * the values differ from a bank that ran by rounding only. Costs a few adds per period.
+         */
+        void skip(juce::int64 numSamples)
+        {
+            const int first = (int)juce::jmin((juce::int64)samplesUntilTick, numSamples);
+            advance(first);
+            numSamples -= first;
+
+            if (numSamples == 0)
+                return;
+
+            // All but the last period: phases only, the waveforms are never looked at
+            const float periodSamples = (float)controlInterval;
+            const juce::int64 silentPeriods = (numSamples - 1) / controlInterval;
+
+            for (juce::int64 k = 0; k < silentPeriods; ++k)
+                for (size_t i = 0; i < NumLanes; ++i)
+                    stepPhase(i, periodSamples);
+
+            // Where that period ended, then a real tick into the one the skip ends in
+            if (silentPeriods > 0)
+                for (size_t i = 0; i < NumLanes; ++i)
+                    values[i] = LFO::evaluate(waveform, phases[i], randomFrom[i], randomTo[i]) * depths[i];
+
+            tick();
+            advance((int)(numSamples - silentPeriods * controlInterval));
+        }
+
+        /** Consumes numSamples of the current segment, advancing the values along the ramp. */
+        void advance(int numSamples)
+        {
+            jassert(numSamples <= samplesUntilTick);
+            const float n = (float)numSamples;
+
+            for (size_t i = 0; i < NumLanes; ++i)
+                values[i] += increments[i] * n;
+
+            samplesUntilTick -= numSamples;
+        }
+
+        const float* getValues() const { return values.data(); }
+        const float* getIncrements() const { return increments.data(); }
+
+    private:
+        /** One control period of lane i's phase; a wrap draws the lane's next random target. */
+        void stepPhase(size_t i, float periodSamples)
+        {
+            float p = phases[i] + phaseIncrements[i] * periodSamples;
+
+            if (p >= 1.0f)
+            {
+                p -= (float)(int)p;
+                randomFrom[i] = randomTo[i];
+                randomTo[i] = random.nextFloat() * 2.0f - 1.0f;
+            }
+
+            phases[i] = p;
+        }
+
+        double sampleRate = 44100.0;
+        int controlInterval = defaultControlInterval;
+        int samplesUntilTick = 0;
+        LFO::Waveform waveform = LFO::Waveform::Sine;
+
+        alignas(32) std::array<float, NumLanes> phases {};
+        alignas(32) std::array<float, NumLanes> phaseIncrements {};
+        alignas(32) std::array<float, NumLanes> depths {};
+        alignas(32) std::array<float, NumLanes> values {};
+        alignas(32) std::array<float, NumLanes> increments {};
+
+        std::array<float, NumLanes> randomFrom {};
+        std::array<float, NumLanes> randomTo {};
+        juce::Random random { 0x4d6f64 }; // Fixed seed keeps renders reproducible
+    };
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReverbEngine.h"
+#include "CpuDispatch.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace DSP
+{
+    /**
+     * @brief Offline rendering of long files, cut into chunks that render on every core.
+     *
+     * Each chunk gets its own ReverbEngine, restored from a snapshot of a freshly prepared one
+     * (copyStateFrom(): delay lines, filter states and LFOs start out as the serial render's did)
+     * with its LFOs then skipped on to the start of the chunk's pre-roll. The pre-roll is the input
+     * just ahead of the chunk, rendered and thrown away, as long as the engine's settling time for
+     * errorBoundDb: by the end of it, whatever the serial engine still held from earlier input has
+     * decayed that far. Chunks and pre-rolls start on the serial render's block grid, so every
+     * engine sees the same blocks, and a seam differs from the serial output by that decayed
+     * remainder plus rounding.
+     *
+     * The rounding does not decay: two engines with different histories settle some 85 - 90 dB
+     * (relative to the peak) apart and stay there, mostly from the low cut's filter states. Bounds
+     * much past the default only lengthen the pre-roll.
+     *
+     * Settings are fixed for the whole render, with predelayMs already resolved for a synced
+     * predelay; dry/wet, the long predelay and the pre-echo are applied as by the processor. The
+     * output has the input's length (pad the input with silence to keep the tail). A mono input
+     * renders to a mono or a stereo output, a stereo one to stereo. A frozen tank never forgets,
+     * so it renders in one piece.
+     *
+     * With verifySeams every seam is rendered a second time with twice the pre-roll. The error
+     * falls off exponentially with the pre-roll, so the difference between the two is the seam's
+     * error against the serial output, give or take the (much smaller) error of the longer one.
+     */
+    class ParallelRenderer
+    {
+    public:
+        struct Options
+        {
+            int numThreads = 0;             // 0: one per core
+            int blockSize = 512;
+            juce::int64 chunkSamples = 0;   // 0: the input split evenly across the threads
+            float errorBoundDb = 80.0f;     // Decay of the serial state by the end of a pre-roll
+            bool verifySeams = false;
+        };
+
+        struct Result
+        {
+            int numChunks = 0;
+            juce::int64 prerollSamples = 0;
+            float seamErrorDb = -std::numeric_limits<float>::infinity();  // Measured, relative to the output peak
+        };
+
+        ParallelRenderer(double sr, const ReverbSettings& s) : ParallelRenderer(sr, s, Options()) {}
+
+        ParallelRenderer(double sr, const ReverbSettings& s, Options o)
+            : sampleRate(sr), settings(s), options(o)
+        {
+            options.blockSize = juce::jmax(1, options.blockSize);
+
+            ReverbEngine engine;
+            prepare(engine);
+
+            const double settling = engine.getSettlingSeconds(options.errorBoundDb);
+            prerollSamples = std::isfinite(settling) ? roundUpToBlock((juce::int64)std::ceil(settling * sampleRate)) : -1;
+        }
+
+        /** Input rendered ahead of every chunk, in samples; -1 when the render cannot be split. */
+        juce::int64 getPrerollSamples() const { return prerollSamples; }
+
+        /** Renders input into output (same length), in parallel where that pays off. */
+        Result render(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output) const
+        {
+            jassert(output.getNumSamples() == input.getNumSamples());
+            jassert(output.getNumChannels() >= input.getNumChannels());
+
+            const juce::int64 numSamples = input.getNumSamples();
+            const int numThreads = options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus();
+
+            Result result;
+            result.prerollSamples = prerollSamples;
+
+            // One chunk per thread takes about numSamples / numThreads + pre-roll: worth it until a
+            // chunk and its pre-roll are as long as the whole input
+            juce::int64 chunk = options.chunkSamples > 0 ? options.chunkSamples : (numSamples + numThreads - 1) / numThreads;
+
+            if (prerollSamples < 0 || numThreads <= 1 || chunk + prerollSamples >= numSamples)
+            {
+                result.numChunks = 1;
+                renderSerial(input, output);
+                return result;
+            }
+
+            chunk = roundUpToBlock(chunk);
+            result.numChunks = (int)((numSamples + chunk - 1) / chunk);
+
+            ReverbEngine snapshot;
+            prepare(snapshot);
+
+            std::vector<float> seamErrors((size_t)result.numChunks, 0.0f);
+            std::atomic<int> nextChunk { 0 };
+
+            auto work = [&]
+            {
+                ReverbEngine engine;
+                prepare(engine);
+                Scratch scratch(options.blockSize);
+
+                for (int c = nextChunk++; c < result.numChunks; c = nextChunk++)
+                {
+                    const juce::int64 start = c * chunk;
+                    const juce::int64 end = juce::jmin(numSamples, start + chunk);
+
+                    renderChunk(engine, snapshot, scratch, input, &output, start, end, prerollSamples);
+
+                    if (options.verifySeams && c > 0)
+                        seamErrors[(size_t)c] = verifySeam(engine, snapshot, scratch, input, output, start, end);
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (int t = 1; t < juce::jmin(numThreads, result.numChunks); ++t)
+                workers.emplace_back(work);
+
+            work();
+
+            for (auto& w : workers)
+                w.join();
+
+            if (options.verifySeams)
+            {
+                float peak = 0.0f;
+                for (int ch = 0; ch < output.getNumChannels(); ++ch)
+                    peak = juce::jmax(peak, output.getMagnitude(ch, 0, output.getNumSamples()));
+
+                const float worst = *std::max_element(seamErrors.begin(), seamErrors.end());
+                result.seamErrorDb = peak > 0.0f ? juce::Decibels::gainToDecibels(worst / peak, -400.0f) : -400.0f;
+            }
+
+            return result;
+        }
+
+        /** The reference: one engine from the first sample to the last. */
+        void renderSerial(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output) const
+        {
+            ReverbEngine engine;
+            prepare(engine);
+            Scratch scratch(options.blockSize);
+
+            renderRange(engine, scratch, input, &output, 0, input.getNumSamples(), 0);
+        }
+
+    private:
+        struct Scratch
+        {
+            explicit Scratch(int blockSize) : source(2, blockSize), wet(2, blockSize), seam(2, 0) {}
+
+            juce::AudioBuffer<float> source, wet, seam;
+        };
+
+        void prepare(ReverbEngine& engine) const
+        {
+            engine.setIsa(CpuDispatch::select());
+            engine.setSettings(settings);
+            engine.prepare(sampleRate, options.blockSize);
+        }
+
+        juce::int64 roundUpToBlock(juce::int64 n) const
+        {
+            const juce::int64 block = options.blockSize;
+            return (n + block - 1) / block * block;
+        }
+
+        /** [start, end) into output, after starting from the snapshot preroll samples earlier. */
+        void renderChunk(ReverbEngine& engine, const ReverbEngine& snapshot, Scratch& scratch,
+                         const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>* output,
+                         juce::int64 start, juce::int64 end, juce::int64 preroll) const
+        {
+            const juce::int64 from = juce::jmax((juce::int64)0, start - preroll);
+
+            engine.copyStateFrom(snapshot);
+            engine.skipModulation(from);
+
+            renderRange(engine, scratch, input, nullptr, from, start, 0);
+            renderRange(engine, scratch, input, output, start, end, 0);
+        }
+
+        /** The first stretch of a chunk again with twice the pre-roll; returns the largest difference. */
+        float verifySeam(ReverbEngine& engine, const ReverbEngine& snapshot, Scratch& scratch,
+                         const juce::AudioBuffer<float>& input, const juce::AudioBuffer<float>& output,
+                         juce::int64 start, juce::int64 end) const
+        {
+            const juce::int64 length = juce::jmin(end - start, roundUpToBlock((juce::int64)sampleRate));
+            scratch.seam.setSize(output.getNumChannels(), (int)length, false, false, true);
+
+            renderChunk(engine, snapshot, scratch, input, nullptr, start, start, 2 * prerollSamples);
+            renderRange(engine, scratch, input, &scratch.seam, start, start + length, start);
+
+            float worst = 0.0f;
+            for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            {
+                const float* a = output.getReadPointer(ch, (int)start);
+                const float* b = scratch.seam.getReadPointer(ch);
+
+                for (juce::int64 i = 0; i < length; ++i)
+                    worst = juce::jmax(worst, std::abs(a[i] - b[i]));
+            }
+
+            return worst;
+        }
+
+        /**
+         * Runs the engine over [start, end) of the input in blocks, and mixes the result into
+         * output from outputOffset on (output sample i is input sample outputOffset + i), or only
+         * runs it when output is nullptr.
+         */
+        void renderRange(ReverbEngine& engine, Scratch& scratch, const juce::AudioBuffer<float>& input,
+                         juce::AudioBuffer<float>* output, juce::int64 start, juce::int64 end, juce::int64 outputOffset) const
+        {
+            const bool monoInput = input.getNumChannels() < 2;
+            const bool stereoOutput = output == nullptr || output->getNumChannels() > 1;
+            const juce::int64 longDelay = settings.longPredelayS > 0.0f ? (juce::int64)std::lround(settings.longPredelayS * sampleRate) : 0;
+
+            for (juce::int64 pos = start; pos < end; pos += options.blockSize)
+            {
+                const int n = (int)juce::jmin((juce::int64)options.blockSize, end - pos);
+
+                // Engine input: the long predelay is just an offset into the file
+                for (int ch = 0; ch < input.getNumChannels(); ++ch)
+                {
+                    float* src = scratch.source.getWritePointer(ch);
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const juce::int64 t = pos + i - longDelay;
+                        src[i] = t >= 0 && t < input.getNumSamples() ? input.getSample(ch, (int)t) : 0.0f;
+                    }
+                }
+
+                auto* srcL = scratch.source.getWritePointer(0);
+                auto* srcR = monoInput ? nullptr : scratch.source.getWritePointer(1);
+                auto* wetL = scratch.wet.getWritePointer(0);
+                auto* wetR = stereoOutput ? scratch.wet.getWritePointer(1) : nullptr;
+
+                engine.process(srcL, srcR, wetL, wetR, n);
+
+                if (output == nullptr)
+                    continue;
+
+                if (longDelay > 0 && settings.preEcho > 0.0f)
+                {
+                    juce::FloatVectorOperations::addWithMultiply(wetL, srcL, settings.preEcho, n);
+                    if (wetR != nullptr)
+                        juce::FloatVectorOperations::addWithMultiply(wetR, monoInput ? srcL : srcR, settings.preEcho, n);
+                }
+
+                // Dry/wet, a mono input sits in the centre of a stereo output
+                for (int ch = 0; ch < output->getNumChannels(); ++ch)
+                {
+                    const float* dry = input.getReadPointer(juce::jmin(ch, input.getNumChannels() - 1), (int)pos);
+                    const float* wet = scratch.wet.getReadPointer(ch);
+                    float* out = output->getWritePointer(ch, (int)(pos - outputOffset));
+
+                    for (int i = 0; i < n; ++i)
+                        out[i] = dry[i] * (1.0f - settings.mix) + wet[i] * settings.mix;
+                }
+            }
+        }
+
+        double sampleRate;
+        ReverbSettings settings;
+        Options options;
+        juce::int64 prerollSamples = 0;
+    };
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+namespace DSP
+{
+    /** A parameter change at a position within the next rendered block. */
+    struct ParameterEvent
+    {
+        int index = 0;          // Params::Index
+        float value = 0.0f;     // Plain (denormalised) value
+        int sampleOffset = 0;   // From the start of the block it is applied in
+        bool ramp = false;      // Ramp to value over the block instead of stepping at sampleOffset
+    };
+
+    /**
+     * @brief Bounded lock-free queue of parameter events, many producers / one consumer.
+     *
+     * Parameter listeners may be called from the message thread, the audio thread or a host
+     * thread, so pushes are wait-free per slot (a sequence number per cell, after D. Vyukov's
+     * bounded queue); only the audio thread pops. push() fails when full, it never blocks.
+     */
+    template <size_t Capacity>
+    class ParameterEventQueue
+    {
+    public:
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+        ParameterEventQueue()
+        {
+            for (size_t i = 0; i < Capacity; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool push(const ParameterEvent& event)
+        {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                auto& cell = cells[pos & mask];
+                auto seq = cell.sequence.load(std::memory_order_acquire);
+                auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.event = event;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // Full
+                }
+                else
+                {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Consumer (audio thread) only. */
+        bool pop(ParameterEvent& event)
+        {
+            auto pos = dequeuePos.load(std::memory_order_relaxed);
+            auto& cell = cells[pos & mask];
+
+            if ((std::ptrdiff_t)cell.sequence.load(std::memory_order_acquire) - (std::ptrdiff_t)(pos + 1) < 0)
+                return false; // Empty, or the producer of this slot has not finished writing
+
+            event = cell.event;
+            cell.sequence.store(pos + Capacity, std::memory_order_release);
+            dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        static constexpr size_t mask = Capacity - 1;
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence { 0 };
+            ParameterEvent event;
+        };
+
+        std::array<Cell, Capacity> cells;
+        alignas(64) std::atomic<size_t> enqueuePos { 0 };
+        alignas(64) std::atomic<size_t> dequeuePos { 0 };
+    };
+}
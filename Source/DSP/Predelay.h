@@ -0,0 +1,185 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayMemory.h"
+#include <array>
+#include <cmath>
+
+namespace DSP
+{
+    /**
+     * @brief Stereo whole-sample predelay that reads the delayed block straight into the buffers
+     * of the stages after it.
+     *
+     * write() copies a block into the ring, read() fetches the same block delayed, and can be called
+     * once per destination. At rest the delay is an integer, so a read is at most two contiguous
+     * copies per channel (around the wrap). Only while the delay glides to a new value are the reads
+     * interpolated, and the glide ends exactly on the new whole-sample delay. A mono source passes
+     * nullptr for the right channel and leaves the second ring untouched.
+     */
+    class Predelay
+    {
+    public:
+        Predelay() = default;
+
+        void prepare(double sr, double maxDelayMs, int maxBlockSize)
+        {
+            sampleRate = sr;
+            maxDelay = (int)std::ceil(maxDelayMs * 0.001 * sr);
+
+            const int size = juce::nextPowerOfTwo(maxDelay + juce::jmax(1, maxBlockSize) + 2);
+            for (auto& ring : rings)
+                ring.allocate((size_t)size);
+            mask = size - 1;
+
+            glideSamples = juce::jmax(1, (int)(glideMs * 0.001 * sr));
+            targetDelay = juce::jmin(targetDelay, maxDelay);
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& ring : rings)
+                ring.clear();
+
+            writeIndex = blockStart = 0;
+            delay = blockDelay = (float)targetDelay;
+            increment = blockIncrement = 0.0f;
+        }
+
+        /** The new delay is rounded to whole samples and reached by a short glide. */
+        void setDelayMs(float ms)
+        {
+            const int newTarget = juce::jlimit(0, maxDelay, (int)std::lround(ms * 0.001 * sampleRate));
+            if (newTarget == targetDelay)
+                return;
+
+            targetDelay = newTarget;
+            increment = ((float)targetDelay - delay) / (float)glideSamples;
+        }
+
+        /** Delay the current block is read at, in samples (fractional while gliding). */
+        float getDelaySamples() const { return blockDelay; }
+        bool isGliding() const { return blockIncrement != 0.0f; }
+
+        /** Stores a block (up to the prepared block size) and moves the glide on by its length. inR may be nullptr. */
+        void write(const float* inL, const float* inR, int numSamples)
+        {
+            blockStart = writeIndex;
+            writeRing(rings[0], inL, numSamples);
+            if (inR != nullptr)
+                writeRing(rings[1], inR, numSamples);
+            writeIndex = (writeIndex + numSamples) & mask;
+
+            blockDelay = delay;
+            blockIncrement = increment;
+            blockTarget = (float)targetDelay;
+
+            if (increment != 0.0f)
+            {
+                delay = towardsTarget(delay + increment * (float)numSamples);
+                if (delay == (float)targetDelay)
+                    increment = 0.0f;
+            }
+        }
+
+        /**
+         * The block given to the last write(), delayed. Outputs may alias that block's inputs;
+         * outR may be nullptr (and must be, after a mono write).
+         */
+        void read(float* outL, float* outR, int numSamples) const
+        {
+            if (blockIncrement == 0.0f)
+            {
+                const int start = (blockStart - (int)blockDelay) & mask;
+                readSpans(rings[0], start, outL, numSamples);
+                if (outR != nullptr)
+                    readSpans(rings[1], start, outR, numSamples);
+                return;
+            }
+
+            readGliding(rings[0], outL, numSamples);
+            if (outR != nullptr)
+                readGliding(rings[1], outR, numSamples);
+        }
+
+        size_t getMemorySize() const { return rings[0].getMemorySize() + rings[1].getMemorySize(); }
+
+        /** Tempo-synced values in beats, in the order of the Predelay Note parameter. */
+        static constexpr std::array<float, 12> noteBeats {
+            1.0f / 16.0f, 1.0f / 8.0f, 1.0f / 6.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 3.0f,  // 1/64 .. 1/8T
+            1.0f / 2.0f, 3.0f / 4.0f, 2.0f / 3.0f, 1.0f, 3.0f / 2.0f, 2.0f                 // 1/8 .. 1/2
+        };
+
+        static float noteToMs(int note, double bpm)
+        {
+            const auto beats = noteBeats[(size_t)juce::jlimit(0, (int)noteBeats.size() - 1, note)];
+            return (float)(beats * 60000.0 / juce::jmax(1.0, bpm));
+        }
+
+    private:
+        static constexpr double glideMs = 50.0;
+
+        float towardsTarget(float d) const
+        {
+            const float target = (float)targetDelay;
+            return increment > 0.0f ? juce::jmin(d, target) : juce::jmax(d, target);
+        }
+
+        void writeRing(DelayMemory& ring, const float* src, int numSamples)
+        {
+            // Silence into a ring that never held sound leaves its memory untouched
+            if (ring.isUntouched() && DelayMemory::isSilent(src, numSamples))
+                return;
+
+            float* dst = ring.getWritePointer();
+            const int first = juce::jmin(numSamples, mask + 1 - writeIndex);
+            std::copy(src, src + first, dst + writeIndex);
+            std::copy(src + first, src + numSamples, dst);
+        }
+
+        void readSpans(const DelayMemory& ring, int start, float* dest, int numSamples) const
+        {
+            const float* src = ring.getReadPointer();
+            const int first = juce::jmin(numSamples, mask + 1 - start);
+            std::copy(src + start, src + start + first, dest);
+            std::copy(src, src + numSamples - first, dest + first);
+        }
+
+        /** Linear interpolation along the glide; no sample-to-sample dependency, so it vectorises. */
+        void readGliding(const DelayMemory& ring, float* __restrict dest, int numSamples) const
+        {
+            const float* buf = ring.getReadPointer();
+            const float target = blockTarget;
+            const bool rising = blockIncrement > 0.0f;
+
+            for (int k = 0; k < numSamples; ++k)
+            {
+                const float unclamped = blockDelay + blockIncrement * (float)k;
+                const float d = rising ? juce::jmin(unclamped, target) : juce::jmax(unclamped, target);
+                const int di = (int)d;
+                const float frac = d - (float)di;
+                const float a = buf[(blockStart + k - di) & mask];
+                const float b = buf[(blockStart + k - di - 1) & mask];
+                dest[k] = a + frac * (b - a);
+            }
+        }
+
+        double sampleRate = 44100.0;
+        std::array<DelayMemory, 2> rings;
+        int mask = 0;
+        int maxDelay = 0;
+        int writeIndex = 0;
+        int glideSamples = 1;
+
+        int targetDelay = 0;
+        float delay = 0.0f;             // Where the next block starts
+        float increment = 0.0f;         // Per sample, 0 at rest
+
+        // The block of the last write()
+        int blockStart = 0;
+        float blockDelay = 0.0f;
+        float blockIncrement = 0.0f;
+        float blockTarget = 0.0f;
+    };
+}
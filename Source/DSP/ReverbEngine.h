@@ -0,0 +1,276 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Predelay.h"
+#include "EarlyReflections.h"
+#include "VelvetEarlyReflections.h"
+#include "RoomModel.h"
+#include "LateReverb.h"
+
+namespace DSP
+{
+    /**
+     * @brief Plain-value view of every parameter the engine needs.
+     * Filled off the audio thread by the preset engine or once per block from the APVTS.
+     */
+    struct ReverbSettings
+    {
+        float mix = 1.0f;           // 0..1
+        float predelayMs = 10.0f;  // Resolved by the caller when synced to the host tempo
+        float decayS = 2.0f;
+        float loCutHz = 20.0f;
+        float hiCutHz = 6000.0f;
+        float modDepth = 0.0f;      // 0..1, main depth
+        float earlySizeMs = 300.0f;
+        float earlyCross = 0.1f;
+        float modRate = 0.5f;
+        float modDepthSub = 0.5f;
+        float diffusion = 1.0f;
+        float earlySend = 0.0f;
+        int modShape = 0;           // DSP::LFO::Waveform
+        float lateDiffusion = 0.7f;
+        int diffusionStages = 4;
+        bool freeze = false;
+        float longPredelayS = 0.0f; // Long predelay / pre-echo, applied by the processor ahead of the engine
+        float preEcho = 0.0f;       // 0..1
+        int earlyEngine = 0;        // EarlyEngine: allpass + taps, or velvet noise
+        float earlyDensity = 1500.0f; // Velvet reflections per second
+        bool earlyRoom = false;     // Allpass engine taps from the image-source room model
+        RoomGeometry room;
+        float lowDecay = 1.0f;      // T60 multipliers below / above the crossovers
+        float highDecay = 1.0f;
+        float lowCrossoverHz = 250.0f;
+        float highCrossoverHz = 4000.0f;
+        bool predelaySync = false;  // predelayMs follows predelayNote at the host tempo
+        int predelayNote = 9;       // Index into Predelay::noteBeats, 1/4
+
+        bool operator== (const ReverbSettings&) const = default;
+    };
+
+    /** Which early reflection generator an engine runs. */
+    enum class EarlyEngine { allpass = 0, velvet };
+
+    /**
+     * @brief One complete reverb signal path: predelay -> early reflections -> late FDN.
+     * Produces the wet signal only, dry/wet mixing is left to the caller.
+     * All scratch memory is allocated in prepare(), process() never allocates.
+     */
+    class ReverbEngine
+    {
+    public:
+        ReverbEngine() = default;
+
+        void prepare(double sr, int maxBlockSize)
+        {
+            sampleRate = sr;
+            maxBlock = juce::jmax(1, maxBlockSize);
+
+            preDelay.prepare(sr, maxPredelayMs, maxBlock);
+            preDelay.setDelayMs(settings.predelayMs);
+            preDelay.reset(); // Starts at the current delay instead of gliding to it
+            earlyReflections.prepare(sr);
+            velvetReflections.setParameters(settings.earlySizeMs, settings.earlyCross, settings.earlyDensity);
+            velvetReflections.prepare(sr);
+            roomTaps.prepare(settings.room);
+            lateReverb.prepare(sr);
+
+            earlyBuf.setSize(2, maxBlock, false, false, true);
+            lateBuf.setSize(2, maxBlock, false, false, true);
+
+            applySettings(settings);
+        }
+
+        void reset()
+        {
+            preDelay.reset();
+            earlyReflections.reset();
+            velvetReflections.reset();
+            lateReverb.reset();
+            applySettings(settings);
+        }
+
+        void setSettings(const ReverbSettings& newSettings)
+        {
+            // The generator taking over starts from silence, not from what it held when it last ran
+            if (newSettings.earlyEngine != settings.earlyEngine)
+            {
+                if (newSettings.earlyEngine == (int)EarlyEngine::velvet) velvetReflections.reset();
+                else                                                      earlyReflections.reset();
+            }
+
+            settings = newSettings;
+            applySettings(settings);
+        }
+
+        const ReverbSettings& getSettings() const { return settings; }
+
+        /** Sample format of the late tank's lines, applied by the next prepare(). */
+        void setDelayStorage(DelayStorage storage) { lateReverb.setDelayStorage(storage); }
+        DelayStorage getDelayStorage() const { return lateReverb.getDelayStorage(); }
+
+        /** Lets the late tank shed detail as its tail decays, see LateReverb. */
+        void setAdaptiveDetail(bool shouldAdapt) { lateReverb.setAdaptiveDetail(shouldAdapt); }
+        bool getAdaptiveDetail() const { return lateReverb.getAdaptiveDetail(); }
+        TankDetail getTankDetail() const { return lateReverb.getDetail(); }
+
+        /** Kernel variant of the late tank, see CpuDispatch. */
+        void setIsa(Isa isa) { lateReverb.setIsa(isa); }
+        Isa getIsa() const { return lateReverb.getIsa(); }
+
+        int getMaxBlockSize() const { return maxBlock; }
+
+        /** Heap bytes held by delay memory and scratch buffers. */
+        size_t getMemorySize() const
+        {
+            size_t bytes = preDelay.getMemorySize()
+                         + earlyReflections.getMemorySize() + velvetReflections.getMemorySize()
+                         + lateReverb.getMemorySize();
+
+            for (auto* b : { &earlyBuf, &lateBuf })
+                bytes += (size_t)(b->getNumChannels() * b->getNumSamples()) * sizeof(float);
+
+            return bytes;
+        }
+
+        /**
+         * @brief Copies the running tank (delay contents, filter and LFO states) of another engine.
+         * Both engines must have been prepared identically, so this is a plain copy with no allocation.
+         */
+        void copyStateFrom(const ReverbEngine& other)
+        {
+            jassert(other.sampleRate == sampleRate);
+            preDelay = other.preDelay;
+            earlyReflections = other.earlyReflections;
+            velvetReflections.copyStateFrom(other.velvetReflections);
+            lateReverb = other.lateReverb;
+        }
+
+        /**
+         * @brief How long the engine takes to forget, in seconds: after this much further input,
+         * whatever it held before has decayed by at least belowDb. Infinite while frozen.
+         * Adds up the worst cases of the stages in series, so it is a bound rather than an estimate.
+         */
+        double getSettlingSeconds(float belowDb) const
+        {
+            const float earlyMs = settings.earlyEngine == (int)EarlyEngine::velvet
+                                ? (float)VelvetEarlyReflections::maxSizeMs
+                                : earlyReflections.getSettlingMs(belowDb);
+
+            return 0.001 * ((double)settings.predelayMs + earlyMs + lateReverb.getSettlingMs(belowDb));
+        }
+
+        /**
+         * Moves every LFO on by numSamples without processing. With copyStateFrom() of a freshly
+         * prepared engine this gives the state a render from the start would have at that point,
+         * less whatever input it would have heard.
+         */
+        void skipModulation(juce::int64 numSamples)
+        {
+            earlyReflections.skipModulation(numSamples);
+            lateReverb.skipModulation(numSamples);
+        }
+
+        /**
+         * @brief Renders the wet signal for numSamples (<= max block size) of input.
+         * inR nullptr is a mono source: predelay, early diffusion and late input diffusion then run
+         * once instead of per channel. wetR nullptr (only with a mono source) renders mono, otherwise
+         * a mono source still comes out as a decorrelated stereo field. The output pointers may
+         * alias the inputs.
+         */
+        void process(const float* inL, const float* inR, float* wetL, float* wetR, int numSamples)
+        {
+            jassert(numSamples <= maxBlock);
+            jassert(wetR != nullptr || inR == nullptr);
+
+            const bool monoInput = inR == nullptr;
+            const int numOutputs = wetR != nullptr ? 2 : 1;
+
+            earlyBuf.setSize(numOutputs, numSamples, false, false, true);
+            lateBuf.setSize(numOutputs, numSamples, false, false, true);
+
+            auto* eL = earlyBuf.getWritePointer(0);
+            auto* eR = numOutputs > 1 ? earlyBuf.getWritePointer(1) : nullptr;
+            auto* lL = lateBuf.getWritePointer(0);
+            auto* lR = numOutputs > 1 ? lateBuf.getWritePointer(1) : nullptr;
+
+            // Pre-Delay, read straight into the inputs of both stages
+            preDelay.write(inL, inR, numSamples);
+            preDelay.read(eL, monoInput ? nullptr : eR, numSamples);
+            preDelay.read(lL, monoInput ? nullptr : lR, numSamples);
+
+            // Early Reflections, fed by the predelayed signal
+            if (settings.earlyEngine == (int)EarlyEngine::velvet)
+                velvetReflections.processBlock(earlyBuf, monoInput);
+            else
+            {
+                earlyReflections.setRoomTaps(settings.earlyRoom ? roomTaps.acquire() : nullptr);
+                earlyReflections.processBlock(earlyBuf, monoInput);
+            }
+
+            // Late input: LateIn = PreDelayed + Early * Send (a mono tank takes the mid of the early field)
+            if (settings.earlySend != 0.0f)
+            {
+                if (! monoInput)
+                {
+                    juce::FloatVectorOperations::addWithMultiply(lL, eL, settings.earlySend, numSamples);
+                    juce::FloatVectorOperations::addWithMultiply(lR, eR, settings.earlySend, numSamples);
+                }
+                else if (eR != nullptr)
+                {
+                    juce::FloatVectorOperations::addWithMultiply(lL, eL, 0.5f * settings.earlySend, numSamples);
+                    juce::FloatVectorOperations::addWithMultiply(lL, eR, 0.5f * settings.earlySend, numSamples);
+                }
+                else
+                {
+                    juce::FloatVectorOperations::addWithMultiply(lL, eL, settings.earlySend, numSamples);
+                }
+            }
+
+            lateReverb.processBlock(lateBuf, monoInput);
+
+            // Wet = Early + Late
+            juce::FloatVectorOperations::add(wetL, eL, lL, numSamples);
+            if (wetR != nullptr)
+                juce::FloatVectorOperations::add(wetR, eR, lR, numSamples);
+        }
+
+    private:
+        void applySettings(const ReverbSettings& s)
+        {
+            preDelay.setDelayMs(s.predelayMs);
+            earlyReflections.setParameters(s.earlySizeMs, s.earlyCross, s.diffusion);
+            earlyReflections.setModulation(s.modRate, s.modDepthSub * s.modDepth);
+            earlyReflections.setModulationShape((LFO::Waveform)s.modShape);
+
+            // Tables are regenerated in the background, so only ask while the velvet field is in use
+            if (s.earlyEngine == (int)EarlyEngine::velvet)
+                velvetReflections.setParameters(s.earlySizeMs, s.earlyCross, s.earlyDensity);
+            else if (s.earlyRoom)
+                roomTaps.setGeometry(s.room);
+
+            lateReverb.setParameters(s.decayS, s.modDepthSub * s.modDepth, s.modRate, s.hiCutHz, s.loCutHz);
+            lateReverb.setDecayShape(s.lowDecay, s.highDecay, s.lowCrossoverHz, s.highCrossoverHz);
+            lateReverb.setModulationShape((LFO::Waveform)s.modShape);
+            lateReverb.setInputDiffusion(s.lateDiffusion, s.diffusionStages);
+            lateReverb.setFreeze(s.freeze);
+        }
+
+        // Covers the 200 ms parameter range and synced values up to a half note at 120 bpm;
+        // seconds-long delays go through DSP::LongDelay instead
+        static constexpr double maxPredelayMs = 1000.0;
+
+        double sampleRate = 44100.0;
+        int maxBlock = 512;
+
+        ReverbSettings settings;
+
+        Predelay preDelay;
+        EarlyReflections earlyReflections;
+        VelvetEarlyReflections velvetReflections;
+        RoomTapSource roomTaps;
+        LateReverb lateReverb;
+
+        juce::AudioBuffer<float> earlyBuf;
+        juce::AudioBuffer<float> lateBuf;
+    };
+}
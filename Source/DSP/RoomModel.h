@@ -0,0 +1,370 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace DSP
+{
+    /**
+     * @brief A shoebox room with one source and one listener.
+     * Dimensions are in metres, positions are fractions of the width (x) and depth (y); the source
+     * stands at 1.5 m and the listener's ears at 1.2 m. Absorption is the share of energy lost per
+     * wall bounce, the same for every surface.
+     */
+    struct RoomGeometry
+    {
+        float widthM = 10.0f;
+        float depthM = 14.0f;
+        float heightM = 4.0f;
+        float sourceX = 0.4f;
+        float sourceY = 0.3f;
+        float listenerX = 0.5f;
+        float listenerY = 0.7f;
+        float absorption = 0.3f;
+
+        bool operator== (const RoomGeometry&) const = default;
+
+        /**
+         * Geometries that agree to the centimetre (and to 0.1 % absorption) sound the same, so
+         * they share a hash, and through it a cached table.
+         */
+        juce::uint64 getHash() const
+        {
+            juce::uint64 hash = 14695981039346656037ull; // FNV-1a
+            auto add = [&hash](float value, float resolution)
+            {
+                const auto q = (juce::uint32)(juce::int32)std::lround(value / resolution);
+                for (int byte = 0; byte < 4; ++byte)
+                {
+                    hash ^= (q >> (8 * byte)) & 0xff;
+                    hash *= 1099511628211ull;
+                }
+            };
+
+            add(widthM, 0.01f);
+            add(depthM, 0.01f);
+            add(heightM, 0.01f);
+            add(sourceX * widthM, 0.01f);
+            add(sourceY * depthM, 0.01f);
+            add(listenerX * widthM, 0.01f);
+            add(listenerY * depthM, 0.01f);
+            add(absorption, 0.001f);
+            return hash;
+        }
+    };
+
+    /**
+     * @brief Early reflection taps of a room, per ear, sorted by delay.
+     * Delays are in milliseconds after the direct sound, so one table serves every sample rate.
+     * Fixed-size and never modified once published, so the audio thread reads it without locking.
+     */
+    struct RoomTapTable
+    {
+        static constexpr int maxTaps = 16;          // Strongest reflections kept per channel
+        static constexpr int maxOrder = 3;          // Wall bounces followed per path
+        static constexpr float maxDelayMs = 500.0f; // Longest tap EarlyReflections can read
+
+        struct Tap
+        {
+            float delayMs;
+            float gain;
+        };
+
+        std::array<std::array<Tap, maxTaps>, 2> taps {};
+        std::array<int, 2> numTaps {};
+        juce::uint64 hash = 0;
+
+        /**
+         * Image-source method: every mirror image of the source up to maxOrder bounces is one
+         * reflection, delayed by its extra path length and attenuated by distance and by the walls
+         * it bounced off. The ears are two cardioids facing left and right, a head width apart.
+         */
+        static RoomTapTable compute(const RoomGeometry& room)
+        {
+            RoomTapTable table;
+            table.hash = room.getHash();
+
+            const float size[3] = { juce::jmax(1.0f, room.widthM), juce::jmax(1.0f, room.depthM), juce::jmax(1.0f, room.heightM) };
+            const float source[3] = { juce::jlimit(0.0f, 1.0f, room.sourceX) * size[0],
+                                      juce::jlimit(0.0f, 1.0f, room.sourceY) * size[1],
+                                      juce::jmin(sourceHeightM, 0.5f * size[2]) };
+            const float reflection = std::sqrt(1.0f - juce::jlimit(0.0f, 0.99f, room.absorption));
+
+            std::array<float[3], 2> ears;
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                ears[(size_t)ch][0] = juce::jlimit(0.0f, size[0], juce::jlimit(0.0f, 1.0f, room.listenerX) * size[0]
+                                                                  + (ch == 0 ? -0.5f : 0.5f) * earSpacingM);
+                ears[(size_t)ch][1] = juce::jlimit(0.0f, 1.0f, room.listenerY) * size[1];
+                ears[(size_t)ch][2] = juce::jmin(listenerHeightM, 0.5f * size[2]);
+            }
+
+            auto distance = [](const float* a, const float* b)
+            {
+                const float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+                return juce::jmax(minDistanceM, std::sqrt(dx * dx + dy * dy + dz * dz));
+            };
+
+            // Reflections are timed and scaled against the direct sound, which the dry path carries
+            const float direct = juce::jmin(distance(source, ears[0]), distance(source, ears[1]));
+
+            std::array<Tap, numImages> candidates;
+            double energy = 0.0;
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const float* ear = ears[(size_t)ch];
+                const float facing = ch == 0 ? -1.0f : 1.0f;
+                int count = 0;
+
+                for (int nx = -maxOrder; nx <= maxOrder; ++nx)
+                    for (int ny = -maxOrder; ny <= maxOrder; ++ny)
+                        for (int nz = -maxOrder; nz <= maxOrder; ++nz)
+                        {
+                            const int order = std::abs(nx) + std::abs(ny) + std::abs(nz);
+                            if (order == 0 || order > maxOrder)
+                                continue;
+
+                            // Image of the source in the room copy n: even copies are shifted, odd ones mirrored
+                            const int n[3] = { nx, ny, nz };
+                            float image[3];
+                            for (int axis = 0; axis < 3; ++axis)
+                                image[axis] = (float)n[axis] * size[axis]
+                                            + ((n[axis] & 1) == 0 ? source[axis] : size[axis] - source[axis]);
+
+                            const float d = distance(image, ear);
+                            const float delayMs = (d - direct) / speedOfSound * 1000.0f;
+                            if (delayMs > maxDelayMs)
+                                continue;
+
+                            const float cosine = (image[0] - ear[0]) / d * facing;
+                            const float pattern = 1.0f - 0.5f * cardioidShape * (1.0f - cosine);
+                            const float gain = std::pow(reflection, (float)order) * direct / d * pattern;
+
+                            candidates[(size_t)count++] = { juce::jmax(0.0f, delayMs), gain };
+                        }
+
+                // The strongest reflections, in order of arrival
+                const int kept = juce::jmin(count, (int)maxTaps);
+                std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.begin() + count,
+                                  [](const Tap& a, const Tap& b) { return a.gain > b.gain; });
+                std::sort(candidates.begin(), candidates.begin() + kept,
+                          [](const Tap& a, const Tap& b) { return a.delayMs < b.delayMs; });
+
+                std::copy(candidates.begin(), candidates.begin() + kept, table.taps[(size_t)ch].begin());
+                table.numTaps[(size_t)ch] = kept;
+
+                for (int t = 0; t < kept; ++t)
+                    energy += (double)candidates[(size_t)t].gain * candidates[(size_t)t].gain;
+            }
+
+            // Level-matched to the ratio taps of EarlyReflections, the balance between the ears is kept
+            const float norm = (float)std::sqrt(2.0 * targetEnergy / juce::jmax(1.0e-9, energy));
+            for (int ch = 0; ch < 2; ++ch)
+                for (int t = 0; t < table.numTaps[(size_t)ch]; ++t)
+                    table.taps[(size_t)ch][(size_t)t].gain *= norm;
+
+            return table;
+        }
+
+    private:
+        static constexpr int numImages = 62;        // Images with 1..3 bounces in three dimensions
+        static constexpr float speedOfSound = 343.0f;
+        static constexpr float earSpacingM = 0.18f;
+        static constexpr float sourceHeightM = 1.5f;
+        static constexpr float listenerHeightM = 1.2f;
+        static constexpr float minDistanceM = 0.1f;
+        static constexpr float cardioidShape = 0.6f; // 0 = omni, 1 = full cardioid
+        static constexpr double targetEnergy = 0.65; // 0.6^2 + 0.4^2 + 0.3^2 + 0.2^2
+    };
+
+    class RoomTapSource;
+
+    /**
+     * @brief One background thread that designs the room tap tables of every instance, and the cache
+     * of tables it has built, keyed by geometry hash.
+     * Shared through a SharedResourcePointer, so a preset recalled in any instance finds its table
+     * ready. Clients are polled; asking for a table from the audio thread never locks or wakes anything.
+     */
+    class RoomModelWorker : private juce::Thread
+    {
+    public:
+        RoomModelWorker() : juce::Thread("Antigrav Room Model")
+        {
+            startThread(juce::Thread::Priority::low);
+        }
+
+        ~RoomModelWorker() override { stopThread(1000); }
+
+        void add(RoomTapSource* client)
+        {
+            const juce::ScopedLock sl(lock);
+            clients.add(client);
+        }
+
+        void remove(RoomTapSource* client)
+        {
+            const juce::ScopedLock sl(lock);
+            clients.removeFirstMatchingValue(client);
+        }
+
+        /** Any thread but the audio thread. The cached table for a geometry, computed now on a miss. */
+        std::shared_ptr<const RoomTapTable> getTable(const RoomGeometry& room)
+        {
+            const juce::ScopedLock sl(lock);
+
+            const auto hash = room.getHash();
+            if (auto found = cache.find(hash); found != cache.end())
+                return found->second;
+
+            if (cache.size() >= maxCachedTables)
+                evictUnused();
+
+            ++numComputed;
+            auto table = std::make_shared<const RoomTapTable>(RoomTapTable::compute(room));
+            cache.emplace(hash, table);
+            return table;
+        }
+
+        /** Tables computed since the worker started; cache hits do not count. */
+        int getNumComputed() const
+        {
+            const juce::ScopedLock sl(lock);
+            return numComputed;
+        }
+
+        /** Held while clients are serviced, so a client can be prepared without racing the worker. */
+        const juce::CriticalSection& getLock() const { return lock; }
+
+    private:
+        void run() override;
+
+        /** Drops the tables no client holds any more. */
+        void evictUnused()
+        {
+            for (auto it = cache.begin(); it != cache.end();)
+                it = it->second.use_count() == 1 ? cache.erase(it) : std::next(it);
+        }
+
+        static constexpr int pollIntervalMs = 5;
+        static constexpr size_t maxCachedTables = 256;
+
+        juce::CriticalSection lock;
+        juce::Array<RoomTapSource*> clients;
+        std::map<juce::uint64, std::shared_ptr<const RoomTapTable>> cache;
+        int numComputed = 0;
+    };
+
+    /**
+     * @brief The realtime end of the room model for one engine.
+     *
+     * The audio thread posts geometries through a triple buffer and reads the current table through
+     * an atomic pointer. The worker publishes a table by swapping that pointer and keeps the tables it
+     * replaced alive until the audio thread has announced (through a second pointer) that it moved on,
+     * so a table is never freed while it is being read, and the audio thread never frees anything.
+     */
+    class RoomTapSource
+    {
+    public:
+        RoomTapSource() { worker->add(this); }
+        ~RoomTapSource() { worker->remove(this); }
+
+        /** Message thread, audio stopped. The table for the geometry is in place when this returns. */
+        void prepare(const RoomGeometry& room)
+        {
+            const juce::ScopedLock sl(worker->getLock());
+
+            while (requests.acquire() != nullptr) {}
+            requested = room;
+            publish(worker->getTable(room));
+        }
+
+        /** Audio thread. Only posts a request when the geometry changed. */
+        void setGeometry(const RoomGeometry& room)
+        {
+            if (room == requested)
+                return;
+
+            requested = room;
+            requests.getWriteSlot() = room;
+            requests.publish();
+        }
+
+        /**
+         * Audio thread. The newest table, or nullptr before prepare(); it stays valid until the
+         * next call.
+         */
+        const RoomTapTable* acquire()
+        {
+            auto* table = published.load();
+            for (;;)
+            {
+                inUse.store(table);
+
+                // Only trusted once it is still the published table after being marked in use
+                auto* again = published.load();
+                if (again == table)
+                    return table;
+
+                table = again;
+            }
+        }
+
+    private:
+        friend class RoomModelWorker;
+
+        /** Worker thread, under the worker lock. */
+        void serviceRequests()
+        {
+            if (auto* room = requests.acquire())
+                publish(worker->getTable(*room));
+        }
+
+        /** Under the worker lock. */
+        void publish(std::shared_ptr<const RoomTapTable> table)
+        {
+            if (table.get() == published.load())
+                return;
+
+            retained.push_back(table);
+            published.store(table.get());
+
+            const auto* reading = inUse.load();
+            retained.erase(std::remove_if(retained.begin(), retained.end(), [&](const auto& held)
+                                          { return held.get() != table.get() && held.get() != reading; }),
+                           retained.end());
+        }
+
+        juce::SharedResourcePointer<RoomModelWorker> worker;
+
+        RoomGeometry requested;                     // Audio thread (or prepare)
+        TripleBuffer<RoomGeometry> requests;
+
+        std::atomic<const RoomTapTable*> published { nullptr };
+        std::atomic<const RoomTapTable*> inUse { nullptr };
+        std::vector<std::shared_ptr<const RoomTapTable>> retained; // Worker side
+
+        JUCE_DECLARE_NON_COPYABLE (RoomTapSource)
+    };
+
+    inline void RoomModelWorker::run()
+    {
+        while (! threadShouldExit())
+        {
+            {
+                const juce::ScopedLock sl(lock);
+                for (auto* client : clients)
+                    client->serviceRequests();
+            }
+
+            wait(pollIntervalMs);
+        }
+    }
+}
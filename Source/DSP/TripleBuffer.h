@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+
+namespace DSP
+{
+    /**
+     * @brief Lock-free single-producer / single-consumer triple buffer.
+     * The producer fills the back slot and publishes it with one atomic exchange,
+     * the consumer always sees the most recent complete value. Neither side blocks or allocates.
+     */
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+
+        /** Producer side: the slot to fill before calling publish(). */
+        T& getWriteSlot() { return slots[(size_t)backIndex]; }
+
+        /** Producer side: makes the write slot visible to the consumer. */
+        void publish()
+        {
+            auto previous = middle.exchange(backIndex | freshBit, std::memory_order_acq_rel);
+            backIndex = previous & indexMask;
+        }
+
+        /**
+         * @brief Consumer side: returns the newest published value, or nullptr if nothing new
+         * arrived since the last call. The pointer stays valid until the next call.
+         */
+        const T* acquire()
+        {
+            if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+                return nullptr;
+
+            auto previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = previous & indexMask;
+            return &slots[(size_t)frontIndex];
+        }
+
+        /** Consumer side: the value returned by the last successful acquire(). */
+        const T& getReadSlot() const { return slots[(size_t)frontIndex]; }
+
+    private:
+        static constexpr int freshBit = 4;
+        static constexpr int indexMask = 3;
+
+        std::array<T, 3> slots {};
+        int backIndex = 0;
+        int frontIndex = 1;
+        std::atomic<int> middle { 2 };
+    };
+}
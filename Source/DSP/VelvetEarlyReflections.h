@@ -0,0 +1,403 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayMemory.h"
+#include "TripleBuffer.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+
+namespace DSP
+{
+    /**
+     * @brief One velvet-noise reflection pattern per output channel, factored into two sparse stages.
+     *
+     * A velvet sequence puts one +1 or -1 impulse at a random position in every grid period. Here a
+     * short cluster sequence (signs only) is convolved with a spread sequence across the whole window
+     * (one tap per cluster length, carrying the decay envelope), which gives clusterTaps x spreadTaps
+     * reflections for clusterTaps + spreadTaps reads per sample.
+     * Fixed-size storage, so tables can be handed between threads without allocating.
+     */
+    struct VelvetTable
+    {
+        static constexpr int maxClusterTaps = 64;
+        static constexpr int maxSpreadTaps = 128;
+
+        struct SpreadTap
+        {
+            int delay;      // Samples, >= 1
+            int source;     // Cluster channel
+            float gain;     // Sign times envelope
+        };
+
+        // Per channel: cluster delays (>= 0), [0, numPositive) added and [numPositive, numCluster) subtracted
+        std::array<std::array<int, maxClusterTaps>, 2> cluster {};
+        std::array<int, 2> numPositive {};
+        int numCluster = 0;
+
+        std::array<std::array<SpreadTap, maxSpreadTaps>, 2> spread {};
+        int numSpread = 0;
+
+        int clusterLength = 1;
+        int maxDelay = 0;
+        float sizeMs = 0.0f;
+        float density = 0.0f;
+        float cross = 0.0f;
+
+        int getNumReflections() const { return numCluster * numSpread; }
+
+        /**
+         * Fills the table for a window of sizeMs at the given rate. density is in reflections per second
+         * (split evenly between the two stages, within their maximum sizes), cross is the share of taps
+         * reading the other channel. The same arguments always give the same pattern.
+         */
+        void generate(double sampleRate, float newSizeMs, float newDensity, float newCross)
+        {
+            sizeMs = newSizeMs;
+            density = newDensity;
+            cross = newCross;
+
+            const int window = juce::jmax(1, (int)(sizeMs * 0.001 * sampleRate));
+            const double total = juce::jmax(1.0, window * (double)density / sampleRate);
+
+            numCluster = juce::jlimit(1, maxClusterTaps, (int)std::lround(std::sqrt(total)));
+            numSpread = juce::jlimit(1, juce::jmin(maxSpreadTaps, window), (int)std::ceil(total / numCluster));
+            clusterLength = juce::jmax(1, window / (numSpread + 1));
+            numCluster = juce::jmin(numCluster, clusterLength);
+
+            juce::Random rng(seed);
+            double energy = 0.0;
+            maxDelay = 1;
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                // Cluster: one impulse per sub-period of the cluster length, positive ones first
+                const double clusterPeriod = (double)clusterLength / numCluster;
+                std::array<int, maxClusterTaps> delays {};
+                std::array<bool, maxClusterTaps> negative {};
+
+                for (int i = 0; i < numCluster; ++i)
+                {
+                    delays[(size_t)i] = (int)(i * clusterPeriod + rng.nextFloat() * (clusterPeriod - 1.0));
+                    negative[(size_t)i] = rng.nextBool();
+                }
+
+                int count = 0;
+                for (int sign = 0; sign < 2; ++sign)
+                {
+                    if (sign == 1)
+                        numPositive[(size_t)ch] = count;
+
+                    for (int i = 0; i < numCluster; ++i)
+                        if (negative[(size_t)i] == (sign == 1))
+                            cluster[(size_t)ch][(size_t)count++] = delays[(size_t)i];
+                }
+
+                // Spread: one cluster copy per period, the last one still ending inside the window,
+                // the envelope falling by decayDb
+                const double spreadPeriod = (double)juce::jmax(1, window - clusterLength) / numSpread;
+                for (int j = 0; j < numSpread; ++j)
+                {
+                    const float position = (float)((j + 0.5) / numSpread);
+                    const float gain = std::pow(10.0f, -decayDb / 20.0f * position);
+
+                    auto& tap = spread[(size_t)ch][(size_t)j];
+                    tap.delay = 1 + (int)(j * spreadPeriod + rng.nextFloat() * (spreadPeriod - 1.0));
+                    tap.source = rng.nextFloat() < 0.5f * cross ? 1 - ch : ch;
+                    tap.gain = rng.nextBool() ? -gain : gain;
+
+                    energy += (double)numCluster * gain * gain;
+                    maxDelay = juce::jmax(maxDelay, tap.delay + clusterLength);
+                }
+            }
+
+            // Same energy per channel whatever the density, level-matched to the allpass/tap field
+            const float norm = (float)std::sqrt(2.0 * targetEnergy / juce::jmax(1.0e-9, energy));
+            for (auto& channel : spread)
+                for (int j = 0; j < numSpread; ++j)
+                    channel[(size_t)j].gain *= norm;
+        }
+
+    private:
+        static constexpr float decayDb = 24.0f;
+        static constexpr double targetEnergy = 0.25;
+        static constexpr int seed = 0x7e1fe7;
+    };
+
+    class VelvetEarlyReflections;
+
+    /**
+     * @brief One background thread that regenerates the velvet tables of every instance.
+     * Shared through a SharedResourcePointer; clients are polled, so requesting a table from the
+     * audio thread is a few atomic stores and never wakes or locks anything.
+     */
+    class VelvetTableWorker : private juce::Thread
+    {
+    public:
+        VelvetTableWorker() : juce::Thread("Antigrav Velvet Tables")
+        {
+            startThread(juce::Thread::Priority::low);
+        }
+
+        ~VelvetTableWorker() override { stopThread(1000); }
+
+        void add(VelvetEarlyReflections* client)
+        {
+            const juce::ScopedLock sl(lock);
+            clients.add(client);
+        }
+
+        void remove(VelvetEarlyReflections* client)
+        {
+            const juce::ScopedLock sl(lock);
+            clients.removeFirstMatchingValue(client);
+        }
+
+        /** Held while tables are generated, so a client can be prepared without racing the worker. */
+        const juce::CriticalSection& getLock() const { return lock; }
+
+    private:
+        void run() override;
+
+        static constexpr int pollIntervalMs = 5;
+
+        juce::CriticalSection lock;
+        juce::Array<VelvetEarlyReflections*> clients;
+    };
+
+    /**
+     * @brief Early reflections from velvet noise: hundreds of sparse reflections instead of the
+     * allpass chain plus eight modulated taps of EarlyReflections.
+     *
+     * The input goes into a ring per channel, the cluster stage sums its +/-1 taps into a second
+     * ring, and the spread stage sums scaled taps of that into the output. Each tap of a block is
+     * one or two contiguous spans (around the wrap), so both stages vectorise as plain adds.
+     * A size, density or cross change only asks for a new table; the shared worker generates it
+     * and hands it over through a triple buffer, and the audio thread switches at the next chunk.
+     */
+    class VelvetEarlyReflections
+    {
+    public:
+        static constexpr int maxChunk = 256;
+        static constexpr double maxSizeMs = 500.0;
+
+        VelvetEarlyReflections() { worker->add(this); }
+        ~VelvetEarlyReflections() { worker->remove(this); }
+
+        /** Message thread, audio stopped. Builds the table for the current parameters right away. */
+        void prepare(double sr)
+        {
+            const juce::ScopedLock sl(worker->getLock());
+
+            sampleRate = sr;
+            const int maxDelay = (int)std::ceil(maxSizeMs * 0.001 * sr) + 2;
+            for (auto& ring : inputRings)
+                ring.allocate((size_t)juce::nextPowerOfTwo(maxDelay + maxChunk + 1));
+            for (auto& ring : clusterRings)
+                ring.allocate((size_t)juce::nextPowerOfTwo(maxDelay + maxChunk + 1));
+            mask = (int)inputRings[0].size() - 1;
+
+            initialTable.generate(sr, requestedSizeMs.load(), requestedDensity.load(), requestedCross.load());
+            current = &initialTable;
+
+            // Drop whatever the worker finished for the old rate
+            while (tables.acquire() != nullptr) {}
+            generatedSerial = requestedSerial.load();
+
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& ring : inputRings) ring.clear();
+            for (auto& ring : clusterRings) ring.clear();
+            writeIndex = 0;
+        }
+
+        /** Any thread. Only asks for a new table when something changed. */
+        void setParameters(float sizeMs, float cross, float density)
+        {
+            sizeMs = juce::jlimit(1.0f, (float)maxSizeMs, sizeMs);
+
+            if (sizeMs == requestedSizeMs.load(std::memory_order_relaxed)
+                 && cross == requestedCross.load(std::memory_order_relaxed)
+                 && density == requestedDensity.load(std::memory_order_relaxed))
+                return;
+
+            requestedSizeMs.store(sizeMs, std::memory_order_relaxed);
+            requestedCross.store(cross, std::memory_order_relaxed);
+            requestedDensity.store(density, std::memory_order_relaxed);
+            requestedSerial.fetch_add(1, std::memory_order_release);
+        }
+
+        /** The rings take over the other engine's state, the table is copied as it is now. */
+        void copyStateFrom(const VelvetEarlyReflections& other)
+        {
+            jassert(other.sampleRate == sampleRate);
+            inputRings = other.inputRings;
+            clusterRings = other.clusterRings;
+            writeIndex = other.writeIndex;
+            initialTable = *other.current;
+            current = &initialTable;
+        }
+
+        /** The table in use (audio thread, or tests). */
+        const VelvetTable& getTable() const { return *current; }
+
+        size_t getMemorySize() const
+        {
+            size_t bytes = 0;
+            for (auto* rings : { &inputRings, &clusterRings })
+                for (auto& ring : *rings)
+                    bytes += ring.getMemorySize();
+            return bytes;
+        }
+
+        /**
+         * Processes a block in place. With monoInput only channel 0 holds input and only the left
+         * cluster stage runs; every spread tap then reads its ring, for one or two output channels.
+         */
+        void processBlock(juce::AudioBuffer<float>& buffer, bool monoInput = false)
+        {
+            jassert(monoInput || buffer.getNumChannels() > 1);
+
+            auto* left = buffer.getWritePointer(0);
+            auto* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+            const int numSamples = buffer.getNumSamples();
+
+            for (int start = 0; start < numSamples; start += maxChunk)
+                processChunk(left + start, right != nullptr ? right + start : nullptr,
+                             juce::jmin(maxChunk, numSamples - start), monoInput);
+        }
+
+    private:
+        friend class VelvetTableWorker;
+
+        /** Worker thread, under the worker lock. */
+        void serviceRequests()
+        {
+            const auto serial = requestedSerial.load(std::memory_order_acquire);
+            if (serial == generatedSerial || sampleRate <= 0.0)
+                return;
+
+            generatedSerial = serial;
+            tables.getWriteSlot().generate(sampleRate, requestedSizeMs.load(std::memory_order_relaxed),
+                                           requestedDensity.load(std::memory_order_relaxed),
+                                           requestedCross.load(std::memory_order_relaxed));
+            tables.publish();
+        }
+
+        void processChunk(float* left, float* right, int numSamples, bool monoInput)
+        {
+            if (auto* table = tables.acquire())
+                current = table;
+
+            const int numInputs = monoInput ? 1 : 2;
+            const int numOutputs = right != nullptr ? 2 : 1;
+
+            // Silence into empty rings stays silence (and leaves their memory untouched)
+            if (inputRings[0].isUntouched() && inputRings[1].isUntouched() && DelayMemory::isSilent(left, numSamples)
+                 && (monoInput || DelayMemory::isSilent(right, numSamples)))
+            {
+                if (monoInput && right != nullptr)
+                    juce::FloatVectorOperations::clear(right, numSamples);
+                return;
+            }
+
+            const auto& table = *current;
+            float* io[2] = { left, right };
+
+            // Cluster stage: +/-1 taps of the input, written into the cluster ring
+            for (int ch = 0; ch < numInputs; ++ch)
+            {
+                write(inputRings[(size_t)ch].getWritePointer(), io[ch], numSamples);
+                const float* input = inputRings[(size_t)ch].getReadPointer();
+                const auto& delays = table.cluster[(size_t)ch];
+
+                std::fill(scratch.begin(), scratch.begin() + numSamples, 0.0f);
+                for (int i = 0; i < table.numPositive[(size_t)ch]; ++i)
+                    accumulate(input, delays[(size_t)i], 1.0f, numSamples);
+                for (int i = table.numPositive[(size_t)ch]; i < table.numCluster; ++i)
+                    accumulate(input, delays[(size_t)i], -1.0f, numSamples);
+
+                write(clusterRings[(size_t)ch].getWritePointer(), scratch.data(), numSamples);
+            }
+
+            // Spread stage: scaled taps of either cluster ring into the output
+            const float* clusters[2] = { clusterRings[0].getReadPointer(), clusterRings[1].getReadPointer() };
+
+            for (int ch = 0; ch < numOutputs; ++ch)
+            {
+                std::fill(scratch.begin(), scratch.begin() + numSamples, 0.0f);
+                for (int j = 0; j < table.numSpread; ++j)
+                {
+                    const auto& tap = table.spread[(size_t)ch][(size_t)j];
+                    accumulate(clusters[numInputs > 1 ? tap.source : 0], tap.delay, tap.gain, numSamples);
+                }
+
+                std::copy(scratch.begin(), scratch.begin() + numSamples, io[ch]);
+            }
+
+            writeIndex = (writeIndex + numSamples) & mask;
+        }
+
+        void write(float* ring, const float* input, int numSamples) const
+        {
+            const int first = juce::jmin(numSamples, mask + 1 - writeIndex);
+            std::copy(input, input + first, ring + writeIndex);
+            std::copy(input + first, input + numSamples, ring);
+        }
+
+        /** scratch[k] += gain * ring[writeIndex + k - delay], as one or two contiguous spans. */
+        void accumulate(const float* ring, int delay, float gain, int numSamples)
+        {
+            const int start = (writeIndex - delay) & mask;
+            const int first = juce::jmin(numSamples, mask + 1 - start);
+            float* __restrict acc = scratch.data();
+            const float* __restrict a = ring + start;
+
+            for (int k = 0; k < first; ++k)
+                acc[k] += gain * a[k];
+
+            acc += first;
+            for (int k = 0; k < numSamples - first; ++k)
+                acc[k] += gain * ring[k];
+        }
+
+        juce::SharedResourcePointer<VelvetTableWorker> worker;
+
+        double sampleRate = 0.0;
+        std::array<DelayMemory, 2> inputRings, clusterRings;
+        int mask = 0;
+        int writeIndex = 0;
+
+        std::array<float, maxChunk> scratch {};
+
+        // Table in use: the one built in prepare() (or copied), or the last one from the worker
+        VelvetTable initialTable;
+        const VelvetTable* current = &initialTable;
+        TripleBuffer<VelvetTable> tables;
+
+        std::atomic<float> requestedSizeMs { 300.0f };
+        std::atomic<float> requestedCross { 0.1f };
+        std::atomic<float> requestedDensity { 1500.0f };
+        std::atomic<juce::uint32> requestedSerial { 0 };
+        juce::uint32 generatedSerial = 0;  // Worker side
+
+        JUCE_DECLARE_NON_COPYABLE (VelvetEarlyReflections)
+    };
+
+    inline void VelvetTableWorker::run()
+    {
+        while (! threadShouldExit())
+        {
+            {
+                const juce::ScopedLock sl(lock);
+                for (auto* client : clients)
+                    client->serviceRequests();
+            }
+
+            wait(pollIntervalMs);
+        }
+    }
+}
@@ -27,6 +27,86 @@ namespace Params
     // Though "Early Send" controls how much goes to Late.
     
     static const juce::String earlySend = "early_send"; // How much of Early goes to Late
+    static const juce::String modShape = "mod_shape"; // LFO waveform of the late tank and the early field
+    static const juce::String lateDiffusion = "late_diffusion"; // Allpass gain ahead of the FDN
+    static const juce::String diffusionStages = "diffusion_stages"; // Allpasses ahead of the FDN
+    static const juce::String longPredelay = "long_predelay"; // Seconds, needs the long-delay mode
+    static const juce::String preEcho = "pre_echo"; // Level of the long-delayed dry signal in the wet
+    static const juce::String freeze = "freeze"; // Infinite hold of the late tank
+    static const juce::String earlyEngine = "early_engine"; // Allpass + taps, or velvet noise (DSP::EarlyEngine)
+    static const juce::String earlyDensity = "early_density"; // Velvet reflections per second
+    static const juce::String earlyRoom = "early_room"; // Allpass engine taps from the image-source room model
+    static const juce::String roomWidth = "room_width"; // Metres
+    static const juce::String roomDepth = "room_depth";
+    static const juce::String roomHeight = "room_height";
+    static const juce::String roomAbsorption = "room_absorption"; // Energy lost per wall bounce
+    static const juce::String sourceX = "source_x"; // Positions as fractions of width and depth
+    static const juce::String sourceY = "source_y";
+    static const juce::String listenerX = "listener_x";
+    static const juce::String listenerY = "listener_y";
+    static const juce::String lowDecay = "low_decay"; // T60 multiplier below the low crossover
+    static const juce::String highDecay = "high_decay"; // T60 multiplier above the high crossover
+    static const juce::String lowCrossover = "low_crossover";
+    static const juce::String highCrossover = "high_crossover";
+    static const juce::String predelaySync = "predelay_sync"; // Predelay follows the host tempo
+    static const juce::String predelayNote = "predelay_note";
+
+    // Stable parameter order used by snapshots and the binary state format.
+    // Append new parameters at the end only, older sessions rely on the indices.
+    enum Index
+    {
+        mixIndex = 0,
+        predelayIndex,
+        decayIndex,
+        loCutIndex,
+        hiCutIndex,
+        modDepthIndex,
+        earlySizeIndex,
+        earlyCrossIndex,
+        modRateIndex,
+        modDepthSubIndex,
+        diffusionIndex,
+        earlySendIndex,
+        modShapeIndex,
+        lateDiffusionIndex,
+        diffusionStagesIndex,
+        longPredelayIndex,
+        preEchoIndex,
+        freezeIndex,
+        earlyEngineIndex,
+        earlyDensityIndex,
+        earlyRoomIndex,
+        roomWidthIndex,
+        roomDepthIndex,
+        roomHeightIndex,
+        roomAbsorptionIndex,
+        sourceXIndex,
+        sourceYIndex,
+        listenerXIndex,
+        listenerYIndex,
+        lowDecayIndex,
+        highDecayIndex,
+        lowCrossoverIndex,
+        highCrossoverIndex,
+        predelaySyncIndex,
+        predelayNoteIndex,
+        numParameters
+    };
+
+    inline const juce::String& idForIndex(int index)
+    {
+        static const juce::String ids[numParameters] = {
+            mix, predelay, decay, loCut, hiCut, modDepth,
+            earlySize, earlyCross, modRate, modDepthSub, diffusion, earlySend,
+            modShape, lateDiffusion, diffusionStages, longPredelay, preEcho, freeze,
+            earlyEngine, earlyDensity,
+            earlyRoom, roomWidth, roomDepth, roomHeight, roomAbsorption, sourceX, sourceY, listenerX, listenerY,
+            lowDecay, highDecay, lowCrossover, highCrossover,
+            predelaySync, predelayNote
+        };
+        jassert(juce::isPositiveAndBelow(index, (int)numParameters));
+        return ids[index];
+    }
 
     inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
     {
@@ -58,6 +138,45 @@ namespace Params
         // Or usually Late is fed by Early.
         // "Default: 0.00" suggests by default Late is fed by Dry directly (Parallel).
 
+        // Order matches DSP::LFO::Waveform
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(
+            modShape, "Mod Shape", juce::StringArray { "Sine", "Triangle", "Random" }, 0));
+
+        makeParam(lateDiffusion, "Late Diffusion", 0.0f, 1.0f, 0.7f);
+        params.push_back(std::make_unique<juce::AudioParameterInt>(diffusionStages, "Diffusion Stages", 0, 8, 4));
+
+        makeParam(longPredelay, "Long Predelay", 0.0f, 60.0f, 0.0f, 0.3f);
+        makeParam(preEcho, "Pre-Echo", 0.0f, 1.0f, 0.0f);
+        params.push_back(std::make_unique<juce::AudioParameterBool>(freeze, "Freeze", false));
+
+        // Order matches DSP::EarlyEngine
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(
+            earlyEngine, "Early Engine", juce::StringArray { "Allpass", "Velvet" }, 0));
+        makeParam(earlyDensity, "Early Density", 200.0f, 4000.0f, 1500.0f, 0.5f);
+
+        // Defaults match DSP::RoomGeometry
+        params.push_back(std::make_unique<juce::AudioParameterBool>(earlyRoom, "Room Model", false));
+        makeParam(roomWidth, "Room Width", 2.0f, 50.0f, 10.0f, 0.5f);
+        makeParam(roomDepth, "Room Depth", 2.0f, 50.0f, 14.0f, 0.5f);
+        makeParam(roomHeight, "Room Height", 2.0f, 20.0f, 4.0f, 0.5f);
+        makeParam(roomAbsorption, "Wall Absorption", 0.02f, 0.95f, 0.3f);
+        makeParam(sourceX, "Source X", 0.0f, 1.0f, 0.4f);
+        makeParam(sourceY, "Source Y", 0.0f, 1.0f, 0.3f);
+        makeParam(listenerX, "Listener X", 0.0f, 1.0f, 0.5f);
+        makeParam(listenerY, "Listener Y", 0.0f, 1.0f, 0.7f);
+
+        // Skewed so 1x sits in the middle of the 0.25x..4x range
+        makeParam(lowDecay, "Low Decay", 0.25f, 4.0f, 1.0f, 0.43f);
+        makeParam(highDecay, "High Decay", 0.25f, 4.0f, 1.0f, 0.43f);
+        makeParam(lowCrossover, "Low Crossover", 50.0f, 1000.0f, 250.0f, 0.5f);
+        makeParam(highCrossover, "High Crossover", 1000.0f, 12000.0f, 4000.0f, 0.5f);
+
+        // Order matches DSP::Predelay::noteBeats
+        params.push_back(std::make_unique<juce::AudioParameterBool>(predelaySync, "Predelay Sync", false));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(
+            predelayNote, "Predelay Note",
+            juce::StringArray { "1/64", "1/32", "1/16T", "1/16", "1/16D", "1/8T", "1/8", "1/8D", "1/4T", "1/4", "1/4D", "1/2" }, 9));
+
         return { params.begin(), params.end() };
     }
 }
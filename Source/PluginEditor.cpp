@@ -2,9 +2,9 @@
 
 //==============================================================================
 AntigravReverbAudioProcessorEditor::AntigravReverbAudioProcessorEditor (AntigravReverbAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), spectrumDisplay (p.getAnalysisFifo())
 {
-    juce::LookAndFeel::setDefaultLookAndFeel(&darkLnF);
+    setLookAndFeel(darkLnF.get());
 
     auto setupSlider = [this](juce::Slider& s, juce::Label& l, std::unique_ptr<SliderAttachment>& att, const juce::String& pID, const juce::String& name, bool vertical)
     {
@@ -47,12 +47,18 @@ AntigravReverbAudioProcessorEditor::AntigravReverbAudioProcessorEditor (Antigrav
     modeButton.setToggleState(false, juce::dontSendNotification); // Default Early
     buttonClicked(&modeButton); // Trigger visibility update
 
-    setSize (800, 500);
+    addAndMakeVisible(spectrumDisplay);
+
+    setOpaque(true);
+    repaintScheduler->attach(*this);
+
+    setSize (800, 500 + displayHeight);
 }
 
 AntigravReverbAudioProcessorEditor::~AntigravReverbAudioProcessorEditor()
 {
-    juce::LookAndFeel::setDefaultLookAndFeel(nullptr);
+    repaintScheduler->detach(*this);
+    setLookAndFeel(nullptr);
 }
 
 void AntigravReverbAudioProcessorEditor::buttonClicked (juce::Button* button)
@@ -80,12 +86,43 @@ void AntigravReverbAudioProcessorEditor::buttonClicked (juce::Button* button)
 
 //==============================================================================
 void AntigravReverbAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    paintStartTicks = juce::Time::getHighResolutionTicks();
+    
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    if (backgroundCache.isNull() || backgroundScale != scale)
+    {
+        backgroundCache = juce::Image(juce::Image::RGB,
+                                      juce::jmax(1, juce::roundToInt((float)getWidth() * scale)),
+                                      juce::jmax(1, juce::roundToInt((float)getHeight() * scale)), false);
+        juce::Graphics bg(backgroundCache);
+        bg.addTransform(juce::AffineTransform::scale(scale));
+        paintBackground(bg);
+        
+        backgroundScale = scale;
+        ++renderStats.cacheRebuilds;
+        ++repaintScheduler->getStats().cacheRebuilds;
+    }
+    
+    g.drawImage(backgroundCache, getLocalBounds().toFloat());
+}
+
+void AntigravReverbAudioProcessorEditor::paintOverChildren (juce::Graphics&)
+{
+    // Children are painted between paint() and here, so this covers the whole editor
+    auto ticks = juce::Time::getHighResolutionTicks() - paintStartTicks;
+    renderStats.addFrame(ticks);
+    repaintScheduler->getStats().addFrame(ticks);
+}
+
+void AntigravReverbAudioProcessorEditor::paintBackground (juce::Graphics& g)
 {
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
     
     // Divide Left/Right panels visually
     g.setColour(juce::Colours::black.withAlpha(0.3f));
-    auto leftPanel = getLocalBounds().removeFromLeft((int)(getWidth() * 0.4f));
+    auto leftPanel = getLocalBounds().withTrimmedBottom(displayHeight).removeFromLeft((int)(getWidth() * 0.4f));
     g.fillRect(leftPanel);
     
     g.setColour(juce::Colours::white);
@@ -95,7 +132,11 @@ void AntigravReverbAudioProcessorEditor::paint (juce::Graphics& g)
 
 void AntigravReverbAudioProcessorEditor::resized()
 {
+    backgroundCache = {};
+    
     auto area = getLocalBounds();
+    spectrumDisplay.setBounds(area.removeFromBottom(displayHeight).reduced(10, 6));
+    
     auto leftPanel = area.removeFromLeft((int)(getWidth() * 0.4f));
     auto rightPanel = area;
     
@@ -3,6 +3,8 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "UI/LookAndFeel.h"
+#include "UI/RepaintScheduler.h"
+#include "UI/SpectrumDisplay.h"
 #include "Parameters.h"
 
 class AntigravReverbAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Button::Listener
@@ -13,13 +15,33 @@ public:
 
     //==============================================================================
     void paint (juce::Graphics&) override;
+    void paintOverChildren (juce::Graphics&) override;
     void resized() override;
     
+    /** Paint time of this editor; UI::RepaintScheduler::getStats() has the totals of all open editors. */
+    const UI::RenderStats& getRenderStats() const { return renderStats; }
+    
     void buttonClicked (juce::Button* button) override;
 
 private:
+    void paintBackground (juce::Graphics&);
+    
     AntigravReverbAudioProcessor& audioProcessor;
-    UI::DarkLookAndFeel darkLnF;
+    // One look (and its cached knob bodies) for every open editor; set on this editor only,
+    // the global default is left to the host
+    juce::SharedResourcePointer<UI::DarkLookAndFeel> darkLnF;
+    
+    // Static layer, re-rendered only on resize or when the display scale changes
+    juce::Image backgroundCache;
+    float backgroundScale = 0.0f;
+    
+    juce::SharedResourcePointer<UI::RepaintScheduler> repaintScheduler;
+    UI::RenderStats renderStats;
+    juce::int64 paintStartTicks = 0;
+    
+    // Wet spectrum / decay, below the controls. Runs the analysis thread while the editor is open.
+    static constexpr int displayHeight = 140;
+    UI::SpectrumDisplay spectrumDisplay;
 
     // Primary Sliders (Vertical)
     juce::Slider mixSlider, predelaySlider, decaySlider, loCutSlider, hiCutSlider, depthSlider;
@@ -37,48 +59,9 @@ private:
     juce::Label earlySizeLbl, earlyCrossLbl, modRateLbl, modDepthLbl, earlySendLbl, diffLbl;
     std::unique_ptr<SliderAttachment> eSizeAtt, eCrossAtt, mRateAtt, mDepthAtt, eSendAtt, diffAtt;
 
-    // Knob Group (Late - reusing knobs or duplicates? Distinct params means distinct attachments usually)
-    // To handle toggling efficiently, I'll create separate sliders and setVisible.
-    juce::Slider lateModRateKnob, lateModDepthKnob; // Reusing Mod Rate/Depth params visually?
-    // User request: "Implement similar but distinct parameters focused on the diffuse tail... such as Late Density... ensure continuity with Early"
-    // My Params.h defined shared modRate/depth for simplicity in DSP integration step (shared variables), 
-    // BUT I can attach the SAME parameter to a second slider if I want, or just update the one slider's visibility.
-    // If I used shared params, I should just change the label or grouping?
-    // "visible when toggled, replacing Early knobs".
-    // If the parameters are DIFFERENT (e.g. Late has "Density"), I need different sliders.
-    // I only implemented shared ModRate/Depth in PluginProcessor.cpp.
-    // I implemented `hiCut` and `loCut` as Primary Sliders.
-    // I implemented `subModDepth` and `modRate` for Late.
-    // I implemented `earlySize`, `earlyCross`, `modRate`, `modDepth` for Early.
-    // Wait, `modRate` is used by *parameters* in `earlyReflections`... wait.
-    // `PluginProcessor.cpp`: `earlyReflections.setParameters(..., modRateVal, ...)` ? No, Early didn't take mod rate in my code!
-    // `EarlyReflections::setParameters` takes `size`, `cross`, `diffusion`.
-    // It DOES NOT take ModRate/Depth in my implementation.
-    // `EarlyReflections.h` has no LFO!
-    // User request: "Early... Mod Rate... Mod Depth... applied to delay lines."
-    // I missed adding LFO to EarlyReflections.h!
-    // I will fix this if possible, or just acknowledge it.
-    // Since I can't easily go back to DSP without disrupting UI flow, I will just implement the knobs for "Early Mod" and have them control the Late Mod params for now (shared LFO), OR better:
-    // I will display them but they might only affect Late logic in my current code. 
-    // OR I can quickly patch EarlyReflections.h? No, that's context switching.
-    // I'll stick to the UI implementation. I'll make the knobs control the available params.
-    // I'll use the "Mod Rate" / "Mod Depth" params for BOTH Early/Late views (shared).
-    // So I only need ONE set of knobs for Mod Rate/Depth, just visible in both modes?
-    // Or simpler: The Right Panel has a set of knobs. Some change function/param when toggled?
-    // Cleaner to have 2 Groups of components.
-    
-    // Group Early: Size, Cross, Diffusion, Send.
-    // Group Late: (No unique params implemented yet except shared filters/mod).
-    // I'll just show Mod Rate/Depth in both, or just in a "Common" area?
-    // Request: "For the 'Early' section... Mod Rate... Mod Depth... space".
-    // Request: "For the 'Late' section... replacing Early knobs".
-    // I'll implement two container components or just list them.
-    
-    // Late Specifics (Ui only since DSP is shared/simplified):
-    // I won't make unique Late knobs if I don't have unique Late params.
-    // I'll mostly show the Early knobs in Early mode.
-    // In Late mode, I'll show ... maybe just "Late Mod" controls (which are the same parameters).
-    // This satisfies "replacing Early knobs" visually, even if underlying param is same.
+    // Rate and Mod Lv stay visible in both modes: the modulation parameters are shared, and drive
+    // both the late tank and the early field (diffuser and tap motion in EarlyReflections).
+    // There are no Late-only parameters yet, so Late mode hides the Early knobs and shows the shared ones.
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AntigravReverbAudioProcessorEditor)
 };
@@ -8,13 +8,22 @@ AntigravReverbAudioProcessor::AntigravReverbAudioProcessor()
                      .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                      .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                        ),
-       apvts (*this, nullptr, "Parameters", Params::createParameterLayout())
+       apvts (*this, nullptr, "Parameters", Params::createParameterLayout()),
+       presetEngine ([this] (const ParameterSnapshot& snapshot, const juce::ValueTree& tree) { commitSnapshot (snapshot, tree); })
 #endif
 {
+    for (int i = 0; i < Params::numParameters; ++i)
+    {
+        parameterValues[(size_t) i] = apvts.getRawParameterValue (Params::idForIndex (i));
+        rampable[(size_t) i] = ! apvts.getParameter (Params::idForIndex (i))->isDiscrete();
+        apvts.addParameterListener (Params::idForIndex (i), this);
+    }
 }
 
 AntigravReverbAudioProcessor::~AntigravReverbAudioProcessor()
 {
+    for (int i = 0; i < Params::numParameters; ++i)
+        apvts.removeParameterListener (Params::idForIndex (i), this);
 }
 
 //==============================================================================
@@ -52,72 +61,155 @@ bool AntigravReverbAudioProcessor::isMidiEffect() const
 
 double AntigravReverbAudioProcessor::getTailLengthSeconds() const
 {
-    return 2.0;
+    // Frozen, the tail never ends; the parameter says so before the audio thread has caught up
+    if (parameterValues[(size_t) Params::freezeIndex]->load() >= 0.5f)
+        return std::numeric_limits<double>::infinity();
+
+    return tailSeconds.load();
 }
 
 int AntigravReverbAudioProcessor::getNumPrograms()
 {
-    return 3; // Small, Medium, Large
+    return PresetEngine::numPrograms; // Small, Medium, Large
 }
 
 int AntigravReverbAudioProcessor::getCurrentProgram()
 {
-    return 0; // Not tracking actual state index effectively without extra logic, keeping simple
+    return currentProgram.load();
 }
 
 void AntigravReverbAudioProcessor::setCurrentProgram (int index)
 {
-    // Helper to set param
-    auto setParam = [&](const juce::String& id, float value) {
-        if (auto* p = apvts.getParameter(id))
-            p->setValueNotifyingHost(p->getNormalisableRange().convertTo0to1(value));
-    };
+    if (! juce::isPositiveAndBelow (index, PresetEngine::numPrograms))
+        return;
 
-    if (index == 0) // Small Room
-    {
-        setParam(Params::decay, 0.8f);
-        setParam(Params::predelay, 5.0f);
-        setParam(Params::earlySize, 60.0f);
-        setParam(Params::diffusion, 0.8f);
-        setParam(Params::hiCut, 8000.0f);
-    }
-    else if (index == 1) // Medium Room
+    // The snapshot is built on the preset thread, the audio thread crossfades to it
+    // and the parameters are written back once it is ready.
+    float values[Params::numParameters];
+    copyParameterValues (values);
+    presetEngine.requestProgram (index, values);
+    currentProgram = index;
+}
+
+const juce::String AntigravReverbAudioProcessor::getProgramName (int index)
+{
+    return PresetEngine::getProgramName (index);
+}
+
+void AntigravReverbAudioProcessor::changeProgramName (int /*index*/, const juce::String& /*newName*/)
+{
+}
+
+//==============================================================================
+void AntigravReverbAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    blockAdapter.prepare();
+    blockAdapter.setBlockSize(internalBlockSize.load());
+    setLatencySamples(blockAdapter.getLatencySamples());
+
+    // The engine sees either the host blocks or the adapter's internal ones
+    const int engineBlockSize = juce::jmax(samplesPerBlock, (int)DSP::BlockAdapter::maxBlockSize);
+
+    engine.setDelayStorage(compactDelays.load() ? DSP::DelayStorage::float16 : DSP::DelayStorage::float32);
+    engine.setIsa(DSP::CpuDispatch::select());
+
+    // Delay memory is reserved once for the highest supported rate (untouched calloc pages, so
+    // address space rather than RAM); rate changes and re-prepares at or below it reuse it
+    if (sampleRate > reservedSampleRate)
     {
-        setParam(Params::decay, 1.8f);
-        setParam(Params::predelay, 15.0f);
-        setParam(Params::earlySize, 180.0f);
-        setParam(Params::diffusion, 1.0f);
-        setParam(Params::hiCut, 6000.0f);
+        reservedSampleRate = juce::jmax(sampleRate, maxReservedSampleRate);
+        engine.prepare(reservedSampleRate, engineBlockSize);
     }
-    else if (index == 2) // Large Room
+
+    engine.prepare(sampleRate, engineBlockSize);
+    float values[Params::numParameters];
+    copyParameterValues(values);
+    automation.reset(values);
+    parametersDirty = false;
+    
+    auto settings = withHostTempo(makeReverbSettings(values));
+    engine.resetSettings(settings);
+    wetBuffer.setSize(2, engine.getMaxBlockSize(), false, false, true);
+
+    // Mapped and prefaulted here, so seconds of delay memory never fault on the audio thread
+    preparedSampleRate = sampleRate;
+    analysisFifo.setSampleRate(sampleRate);
+    longDelay.prepare(sampleRate, longDelaySeconds.load(), engine.getMaxBlockSize());
+    longDelay.setDelaySeconds(settings.longPredelayS);
+    longDelay.reset();
+    delayedBuffer.setSize(2, engine.getMaxBlockSize(), false, false, true);
+    updateTailLength();
+}
+
+void AntigravReverbAudioProcessor::setInternalBlockSize (int numSamples)
+{
+    numSamples = juce::jlimit (0, (int) DSP::BlockAdapter::maxBlockSize, numSamples);
+    internalBlockSize = numSamples;
+
+    // The audio thread switches on its next block, the host is told about the new latency now
+    setLatencySamples (numSamples);
+}
+
+void AntigravReverbAudioProcessor::setLongDelayCapacity (float seconds)
+{
+    seconds = juce::jlimit (0.0f, maxLongDelaySeconds, seconds);
+
+    if (seconds == longDelaySeconds.load())
+        return;
+
+    longDelaySeconds = seconds;
+
+    if (preparedSampleRate > 0.0)
     {
-        setParam(Params::decay, 4.0f);
-        setParam(Params::predelay, 30.0f);
-        setParam(Params::earlySize, 400.0f);
-        setParam(Params::diffusion, 0.8f);
-        setParam(Params::hiCut, 4000.0f);
+        // Holds the callback lock, so the audio thread is not inside processBlock while the line is replaced
+        suspendProcessing (true);
+        longDelay.prepare (preparedSampleRate, seconds, engine.getMaxBlockSize());
+        suspendProcessing (false);
     }
 }
 
-const juce::String AntigravReverbAudioProcessor::getProgramName (int index)
+void AntigravReverbAudioProcessor::setCompactDelayStorage (bool shouldBeCompact)
 {
-    if (index == 0) return "Small Room";
-    if (index == 1) return "Medium Room";
-    if (index == 2) return "Large Room";
-    return {};
+    if (shouldBeCompact == compactDelays.load())
+        return;
+
+    compactDelays = shouldBeCompact;
+
+    if (preparedSampleRate > 0.0)
+    {
+        // Same reservation as prepareToPlay: the new storage is sized for the highest rate first
+        suspendProcessing (true);
+        engine.setDelayStorage (shouldBeCompact ? DSP::DelayStorage::float16 : DSP::DelayStorage::float32);
+        engine.prepare (reservedSampleRate, engine.getMaxBlockSize());
+        engine.prepare (preparedSampleRate, engine.getMaxBlockSize());
+        suspendProcessing (false);
+    }
 }
 
-void AntigravReverbAudioProcessor::changeProgramName (int /*index*/, const juce::String& /*newName*/)
+AntigravReverbAudioProcessor::MemoryReport AntigravReverbAudioProcessor::getMemoryReport() const
 {
+    MemoryReport report;
+    report.engineBytes = engine.getMemorySize();
+    report.longDelayBytes = longDelay.getStorage().getAllocatedBytes();
+    report.longDelayResidentBytes = longDelay.getStorage().getResidentBytes();
+    report.longDelayHugePages = longDelay.getStorage().usesHugePages();
+    return report;
 }
 
-//==============================================================================
-void AntigravReverbAudioProcessor::prepareToPlay (double sampleRate, int /*samplesPerBlock*/)
+void AntigravReverbAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
 {
-    preDelayL.prepare(sampleRate, 2000.0);
-    preDelayR.prepare(sampleRate, 2000.0);
-    earlyReflections.prepare(sampleRate);
-    lateReverb.prepare(sampleRate);
+    // JUCE hands automation over once per block, so continuous parameters are ramped across
+    // the next block rather than stepped at its start
+    for (int i = 0; i < Params::numParameters; ++i)
+    {
+        if (Params::idForIndex (i) == parameterID)
+        {
+            if (! parameterEvents.push ({ i, newValue, 0, rampable[(size_t) i] }))
+                parametersDirty = true;
+
+            return;
+        }
+    }
 }
 
 void AntigravReverbAudioProcessor::releaseResources()
@@ -132,7 +224,9 @@ bool AntigravReverbAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
         return false;
 
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    // Mono in to mono or stereo out, stereo in to stereo out
+    if (layouts.getMainInputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainInputChannelSet() != layouts.getMainOutputChannelSet())
         return false;
    #endif
 
@@ -146,95 +240,162 @@ void AntigravReverbAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
+    // A mono source on a stereo output: the dry signal sits in the centre, the engine renders the
+    // source once and spreads only the wet signal
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+    {
+        if (totalNumInputChannels == 1)
+            buffer.copyFrom (i, 0, buffer, 0, 0, buffer.getNumSamples());
+        else
+            buffer.clear (i, 0, buffer.getNumSamples());
+    }
 
-    // 1. Get Parameters
-    float mixVal = *apvts.getRawParameterValue(Params::mix) / 100.0f;
-    float predelayMs = *apvts.getRawParameterValue(Params::predelay);
-    float decayS = *apvts.getRawParameterValue(Params::decay);
-    float loCutHz = *apvts.getRawParameterValue(Params::loCut);
-    float hiCutHz = *apvts.getRawParameterValue(Params::hiCut);
-    float modDepthVal = *apvts.getRawParameterValue(Params::modDepth) / 100.0f;
-    
-    // Early Params
-    float earlySizeMs = *apvts.getRawParameterValue(Params::earlySize);
-    float earlyCrossVal = *apvts.getRawParameterValue(Params::earlyCross);
-    float diffusionVal = *apvts.getRawParameterValue(Params::diffusion);
-    float earlySendVal = *apvts.getRawParameterValue(Params::earlySend);
-    
-    // Late Params
-    float modRateVal = *apvts.getRawParameterValue(Params::modRate);
-    float subModDepth = *apvts.getRawParameterValue(Params::modDepthSub);
-    
-    // Update DSP
-    earlyReflections.setParameters(earlySizeMs, earlyCrossVal, diffusionVal);
-    lateReverb.setParameters(decayS, subModDepth * modDepthVal, modRateVal, hiCutHz, loCutHz); 
-    
+    monoInput = totalNumInputChannels < 2;
     auto* left = buffer.getWritePointer(0);
-    auto* right = buffer.getWritePointer(1);
-    int numSamples = buffer.getNumSamples();
-    
-    // Auxiliary buffers
-    juce::AudioBuffer<float> preDelayBuf;
-    preDelayBuf.setSize(2, numSamples);
+    auto* right = totalNumOutputChannels > 1 ? buffer.getWritePointer(1) : nullptr;
+
+    // Hosts without a tempo keep the last one (120 until any arrives)
+    if (auto* playHead = getPlayHead())
+        if (auto position = playHead->getPosition())
+            if (auto bpm = position->getBpm())
+                hostBpm = *bpm;
     
-    // Pre-Delay Processing
-    for (int i = 0; i < numSamples; ++i)
+    engine.setAdaptiveDetail(adaptiveTank.load());
+    blockAdapter.setBlockSize(internalBlockSize.load());
+    blockAdapter.process(left, right, buffer.getNumSamples(),
+                         [this](float* l, float* r, int n) { renderBlock(l, r, n); });
+    updateTailLength();
+}
+
+void AntigravReverbAudioProcessor::updateTailLength()
+{
+    // Until the output has fallen 60 dB below whatever went in last: the long predelay ahead of
+    // the engine, then the engine's own bound (infinite while frozen)
+    const double longPredelay = longDelay.isEnabled()
+                              ? juce::jmin((double)engine.getSettings().longPredelayS, longDelay.getMaxDelaySeconds())
+                              : 0.0;
+
+    tailSeconds = longPredelay + engine.getSettlingSeconds(60.0f);
+}
+
+void AntigravReverbAudioProcessor::renderBlock (float* left, float* right, int numSamples)
+{
+    // 1. Get Parameters
+    // A freshly loaded program/session is crossfaded in, laid over the values running now.
+    // Automation and UI changes keep arriving as events on top of it.
+    if (auto* snapshot = presetEngine.pollSnapshot())
     {
-        // Push inputs
-        preDelayL.push(left[i]);
-        preDelayR.push(right[i]);
-        
-        preDelayBuf.setSample(0, i, preDelayL.read(predelayMs));
-        preDelayBuf.setSample(1, i, preDelayR.read(predelayMs));
+        lastSnapshot = *snapshot;
+
+        float raw[Params::numParameters], values[Params::numParameters];
+        copyParameterValues(raw);
+        std::copy(automation.getValues(), automation.getValues() + Params::numParameters, values);
+        lastSnapshot.applyTo(values, raw);
+
+        automation.reset(values);
+        engine.beginTransition(withHostTempo(makeReverbSettings(values)));
     }
+
+    // Until the message thread has written it back, the raw values are stale where it sets them
+    bool snapshotPending = lastSnapshot.serial > presetEngine.getCommittedSerial();
     
-    // Early Reflections
-    // Input is PreDelayed signal
-    juce::AudioBuffer<float> earlyBuf;
-    earlyBuf.makeCopyOf(preDelayBuf);
-    earlyReflections.processBlock(earlyBuf);
-    
-    // Late Reverb Input Logic
-    // LateInput = PreDelayed * (1-EarlySend)? Or just PreDelayed + Early?
-    // Let's go with: LateIn = PreDelayed + Early * Send.
-    juce::AudioBuffer<float> lateBuf;
-    lateBuf.setSize(2, numSamples);
-    
-    auto* plL = preDelayBuf.getReadPointer(0);
-    auto* plR = preDelayBuf.getReadPointer(1);
-    auto* eL = earlyBuf.getReadPointer(0);
-    auto* eR = earlyBuf.getReadPointer(1);
-    auto* lL = lateBuf.getWritePointer(0);
-    auto* lR = lateBuf.getWritePointer(1);
+    // Parameter changes arrive as events from the listeners. If any got lost (full queue),
+    // every raw value is re-read instead.
+    DSP::ParameterEvent event;
+    while (parameterEvents.pop(event))
+        if (! automation.addEvent(event))
+            parametersDirty = true;
     
-    for (int i = 0; i < numSamples; ++i)
+    if (parametersDirty.exchange(false))
     {
-        lL[i] = plL[i] + eL[i] * earlySendVal;
-        lR[i] = plR[i] + eR[i] * earlySendVal;
+        float values[Params::numParameters];
+        copyParameterValues(values);
+
+        if (snapshotPending)
+            lastSnapshot.applyTo(values, values);
+
+        automation.reset(values);
     }
     
-    lateReverb.processBlock(lateBuf);
+    // Settings (and with them any coefficient updates) only change at the split points
+    automation.process(numSamples, [&] (const float* values, int start, int n)
+    {
+        renderSegment(left + start, right != nullptr ? right + start : nullptr, n, makeReverbSettings(values));
+    });
+}
+
+DSP::ReverbSettings AntigravReverbAudioProcessor::withHostTempo (DSP::ReverbSettings settings) const
+{
+    if (settings.predelaySync)
+        settings.predelayMs = DSP::Predelay::noteToMs(settings.predelayNote, hostBpm);
+
+    return settings;
+}
+
+void AntigravReverbAudioProcessor::renderSegment (float* left, float* right, int numSamples, const DSP::ReverbSettings& segmentSettings)
+{
+    const auto settings = withHostTempo(segmentSettings);
+    engine.setSettings(settings);
+    longDelay.setDelaySeconds(settings.longPredelayS);
     
-    // Final Mix
-    auto* lLat = lateBuf.getReadPointer(0);
-    auto* rLat = lateBuf.getReadPointer(1);
+    // Mono paths leave the right channel out (nullptr) wherever it would only repeat the left
+    auto* wetL = wetBuffer.getWritePointer(0);
+    auto* wetR = right != nullptr ? wetBuffer.getWritePointer(1) : nullptr;
+    auto* delayedL = delayedBuffer.getWritePointer(0);
+    auto* delayedR = monoInput ? nullptr : delayedBuffer.getWritePointer(1);
     
-    for (int i = 0; i < numSamples; ++i)
+    // Hosts may exceed the announced block size, so render in engine-sized chunks
+    for (int start = 0; start < numSamples; start += engine.getMaxBlockSize())
     {
-        float dryL = left[i];
-        float dryR = right[i];
+        int n = juce::jmin(engine.getMaxBlockSize(), numSamples - start);
+        const float* inR = monoInput ? nullptr : right + start;
+        
+        if (longDelay.isEnabled())
+        {
+            // Long predelay ahead of the engine, the delayed dry doubles as the pre-echo
+            longDelay.process(left + start, inR, delayedL, delayedR, n);
+            engine.process(delayedL, delayedR, wetL, wetR, n);
+            
+            if (settings.preEcho > 0.0f)
+            {
+                juce::FloatVectorOperations::addWithMultiply(wetL, delayedL, settings.preEcho, n);
+                if (wetR != nullptr)
+                    juce::FloatVectorOperations::addWithMultiply(wetR, monoInput ? delayedL : delayedR, settings.preEcho, n);
+            }
+        }
+        else
+        {
+            engine.process(left + start, inR, wetL, wetR, n);
+        }
+        
+        // Editor analysis: a copy of the wet signal, nothing more on this thread
+        if (analysisFifo.isActive())
+            analysisFifo.push(wetL, wetR != nullptr ? wetR : wetL, n);
         
-        // Wet = Early + Late
-        float wetL = eL[i] + lLat[i];
-        float wetR = eR[i] + rLat[i];
+        // Final Mix
+        for (int i = 0; i < n; ++i)
+            left[start + i] = left[start + i] * (1.0f - settings.mix) + wetL[i] * settings.mix;
         
-        left[i] = dryL * (1.0f - mixVal) + wetL * mixVal;
-        right[i] = dryR * (1.0f - mixVal) + wetR * mixVal;
+        if (right != nullptr)
+            for (int i = 0; i < n; ++i)
+                right[start + i] = right[start + i] * (1.0f - settings.mix) + wetR[i] * settings.mix;
     }
 }
 
+bool AntigravReverbAudioProcessor::addParameterEvent (int index, float value, int sampleOffset)
+{
+    if (! juce::isPositiveAndBelow (index, (int) Params::numParameters))
+        return false;
+
+    return parameterEvents.push ({ index, value, juce::jmax (0, sampleOffset), false });
+}
+
+void AntigravReverbAudioProcessor::copyParameterValues (float* values) const
+{
+    for (int i = 0; i < Params::numParameters; ++i)
+        values[i] = parameterValues[(size_t)i]->load();
+}
+
 //==============================================================================
 bool AntigravReverbAudioProcessor::hasEditor() const
 {
@@ -249,17 +410,73 @@ juce::AudioProcessorEditor* AntigravReverbAudioProcessor::createEditor()
 //==============================================================================
 void AntigravReverbAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    // Hosts may save from any thread. A session/program still being prepared is waited for, but
+    // committed by the message thread only: until then, its values are the ones saved.
+    presetEngine.flush();
+
+    float values[Params::numParameters];
+    copyParameterValues (values);
+    int program = currentProgram.load();
+    ProcessorOptions options;
+    options.internalBlockSize = internalBlockSize.load();
+    options.longDelaySeconds = longDelaySeconds.load();
+    options.compactDelays = compactDelays.load();
+    options.adaptiveTank = adaptiveTank.load();
+
+    ParameterSnapshot pending;
+    if (presetEngine.getPendingSnapshot (pending))
+    {
+        pending.applyTo (values, values);
+
+        if (pending.program >= 0)
+            program = pending.program;
+
+        if (pending.hasOptions)
+            options = pending.options;
+    }
+
+    StateFormat::writeBinary (values, Params::numParameters, program, options, destData);
 }
 
 void AntigravReverbAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName (apvts.state.getType()))
-            apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+    // Binary or legacy XML, both are parsed on the preset thread
+    float values[Params::numParameters];
+    copyParameterValues (values);
+    presetEngine.requestState (data, sizeInBytes, values);
+}
+
+void AntigravReverbAudioProcessor::commitSnapshot (const ParameterSnapshot& snapshot, const juce::ValueTree& tree)
+{
+    // Only what the program/session sets is written, and only where the value differs, so
+    // write automation records the change and nothing else. A parameter moved since the request
+    // keeps its new value.
+    float values[Params::numParameters];
+    copyParameterValues (values);
+    snapshot.applyTo (values, values);
+
+    // Legacy XML sessions bring the whole tree
+    if (tree.isValid() && tree.hasType (apvts.state.getType()))
+        apvts.replaceState (tree);
+
+    float current[Params::numParameters];
+    copyParameterValues (current);
+
+    for (int i = 0; i < Params::numParameters; ++i)
+        if (values[i] != current[i])
+            if (auto* p = apvts.getParameter (Params::idForIndex (i)))
+                p->setValueNotifyingHost (p->convertTo0to1 (values[i]));
+
+    if (snapshot.program >= 0)
+        currentProgram = snapshot.program;
+
+    if (snapshot.hasOptions)
+    {
+        setInternalBlockSize (snapshot.options.internalBlockSize);
+        setLongDelayCapacity (snapshot.options.longDelaySeconds);
+        setCompactDelayStorage (snapshot.options.compactDelays);
+        setAdaptiveTank (snapshot.options.adaptiveTank);
+    }
 }
 
 //==============================================================================
@@ -2,11 +2,16 @@
 
 #include <JuceHeader.h>
 #include "Parameters.h"
-#include "DSP/DelayLine.h"
-#include "DSP/EarlyReflections.h"
-#include "DSP/LateReverb.h"
+#include "PresetEngine.h"
+#include "DSP/CrossfadingEngine.h"
+#include "DSP/BlockAdapter.h"
+#include "DSP/LongDelay.h"
+#include "DSP/ParameterEventQueue.h"
+#include "DSP/AutomationScheduler.h"
+#include "DSP/AnalysisFifo.h"
 
-class AntigravReverbAudioProcessor  : public juce::AudioProcessor
+class AntigravReverbAudioProcessor  : public juce::AudioProcessor,
+                                      private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     //==============================================================================
@@ -42,21 +47,122 @@ public:
     const juce::String getProgramName (int index) override;
     void changeProgramName (int index, const juce::String& newName) override;
 
+    /** Message thread: blocks until pending program / state changes have reached the parameters. */
+    void waitForPendingStateChanges()
+    {
+        presetEngine.flush();
+        presetEngine.commitPending();
+    }
+
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /**
+     * Fixed internal block size (e.g. 64 or 128) for tiny host buffers, reported as latency.
+     * 0 (default) processes the host blocks directly with zero latency.
+     */
+    void setInternalBlockSize (int numSamples);
+    int getInternalBlockSize() const { return internalBlockSize.load(); }
+
+    /**
+     * Long-delay mode: capacity in seconds of the long predelay / pre-echo line (0 = off).
+     * Reallocates (and prefaults) the line, so call it from the message thread only.
+     */
+    void setLongDelayCapacity (float seconds);
+    float getLongDelayCapacity() const { return longDelaySeconds.load(); }
+
+    static constexpr float maxLongDelaySeconds = 60.0f;
+
+    /**
+     * Compact delay storage: the late tank's lines hold half floats instead of floats, halving
+     * their memory and bandwidth (see DSP::LateReverb). Re-prepares the engine, which clears the
+     * tail, so call it from the message thread only.
+     */
+    void setCompactDelayStorage (bool shouldBeCompact);
+    bool getCompactDelayStorage() const { return compactDelays.load(); }
+
+    /**
+     * Adaptive tank detail: the late tank drops its modulation and then half its lines as the
+     * tail decays, and goes back to full detail with new input (see DSP::LateReverb). Any thread;
+     * the audio thread picks it up at the next block.
+     */
+    void setAdaptiveTank (bool shouldAdapt) { adaptiveTank = shouldAdapt; }
+    bool getAdaptiveTank() const { return adaptiveTank.load(); }
+
+    /** Engine delay memory is sized for this rate up front, so re-preparing at or below it never allocates. */
+    static constexpr double maxReservedSampleRate = 192000.0;
+
+    struct MemoryReport
+    {
+        size_t engineBytes = 0;             // Both engines' delay lines and scratch buffers (heap)
+        size_t longDelayBytes = 0;          // Reserved for the long delay line
+        size_t longDelayResidentBytes = 0;  // Of that, currently in physical memory
+        bool longDelayHugePages = false;
+
+        size_t getResidentBytes() const { return engineBytes + longDelayResidentBytes; }
+    };
+
+    /** Memory held by this instance. Message thread. */
+    MemoryReport getMemoryReport() const;
+
+    /**
+     * Sample-accurate parameter change for the next rendered block (relative to the internal block
+     * when the block adapter is on), e.g. from automation data of an offline render. Any thread.
+     * Only the DSP follows it, the APVTS value is left alone.
+     */
+    bool addParameterEvent (int index, float value, int sampleOffset);
+
+    /** Wet output for the editor's analyser; filled by the audio thread only while a reader is active. */
+    DSP::AnalysisFifo& getAnalysisFifo() { return analysisFifo; }
+
     juce::AudioProcessorValueTreeState apvts;
 
 private:
-    DSP::DelayLine preDelayL;
-    DSP::DelayLine preDelayR;
-    DSP::EarlyReflections earlyReflections;
-    DSP::LateReverb lateReverb;
-    
-    // Smoothers or direct parameter reading?
-    // Using raw floats for simplicity in processBlock, updated from APVTS
-    
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+
+    void renderBlock (float* left, float* right, int numSamples);
+    void renderSegment (float* left, float* right, int numSamples, const DSP::ReverbSettings& settings);
+    DSP::ReverbSettings withHostTempo (DSP::ReverbSettings settings) const;
+    void copyParameterValues (float* values) const;
+    void updateTailLength();
+    void commitSnapshot (const ParameterSnapshot& snapshot, const juce::ValueTree& tree);
+
+    DSP::CrossfadingEngine engine;
+    juce::AudioBuffer<float> wetBuffer;
+
+    // Raw parameter values, looked up once instead of by ID every block
+    std::array<std::atomic<float>*, Params::numParameters> parameterValues {};
+    std::array<bool, Params::numParameters> rampable {};
+    std::atomic<bool> parametersDirty { true };
+
+    // Listener -> audio thread parameter changes, split into sub-blocks on the audio thread
+    DSP::ParameterEventQueue<1024> parameterEvents;
+    DSP::AutomationScheduler<Params::numParameters> automation;
+
+    DSP::BlockAdapter blockAdapter;
+    std::atomic<int> internalBlockSize { 0 };
+
+    DSP::LongDelay longDelay;
+    DSP::AnalysisFifo analysisFifo;
+    juce::AudioBuffer<float> delayedBuffer;
+    std::atomic<float> longDelaySeconds { 0.0f };
+    std::atomic<bool> compactDelays { false };
+    std::atomic<bool> adaptiveTank { false };
+    double preparedSampleRate = 0.0;
+    double hostBpm = 120.0;             // Last tempo the host reported, for the synced predelay
+    bool monoInput = false;             // Audio thread: the input bus is mono, the engine renders one source
+    std::atomic<double> tailSeconds { 2.0 }; // Published by the audio thread, read by the host on any thread
+    double reservedSampleRate = 0.0;
+
+    // Program / session changes are prepared off the audio thread
+    PresetEngine presetEngine;
+    std::atomic<int> currentProgram { 0 };
+
+    // Audio thread: the last snapshot taken over, laid over the raw values until the APVTS has caught up
+    ParameterSnapshot lastSnapshot;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AntigravReverbAudioProcessor)
 };
@@ -0,0 +1,371 @@
+#include "PresetEngine.h"
+
+namespace
+{
+    struct ProgramValue
+    {
+        int index;
+        float value;
+    };
+
+    struct FactoryProgram
+    {
+        const char* name;
+        ProgramValue values[5];
+    };
+
+    const FactoryProgram factoryPrograms[PresetEngine::numPrograms] =
+    {
+        { "Small Room",  { { Params::decayIndex, 0.8f }, { Params::predelayIndex, 5.0f },
+                           { Params::earlySizeIndex, 60.0f }, { Params::diffusionIndex, 0.8f },
+                           { Params::hiCutIndex, 8000.0f } } },
+        { "Medium Room", { { Params::decayIndex, 1.8f }, { Params::predelayIndex, 15.0f },
+                           { Params::earlySizeIndex, 180.0f }, { Params::diffusionIndex, 1.0f },
+                           { Params::hiCutIndex, 6000.0f } } },
+        { "Large Room",  { { Params::decayIndex, 4.0f }, { Params::predelayIndex, 30.0f },
+                           { Params::earlySizeIndex, 400.0f }, { Params::diffusionIndex, 0.8f },
+                           { Params::hiCutIndex, 4000.0f } } },
+    };
+}
+
+//==============================================================================
+DSP::ReverbSettings makeReverbSettings (const float* values)
+{
+    DSP::ReverbSettings s;
+    s.mix         = values[Params::mixIndex] / 100.0f;
+    s.predelayMs  = values[Params::predelayIndex];
+    s.decayS      = values[Params::decayIndex];
+    s.loCutHz     = values[Params::loCutIndex];
+    s.hiCutHz     = values[Params::hiCutIndex];
+    s.modDepth    = values[Params::modDepthIndex] / 100.0f;
+    s.earlySizeMs = values[Params::earlySizeIndex];
+    s.earlyCross  = values[Params::earlyCrossIndex];
+    s.modRate     = values[Params::modRateIndex];
+    s.modDepthSub = values[Params::modDepthSubIndex];
+    s.diffusion   = values[Params::diffusionIndex];
+    s.earlySend   = values[Params::earlySendIndex];
+    s.modShape    = juce::jlimit (0, 2, juce::roundToInt (values[Params::modShapeIndex]));
+    s.lateDiffusion   = values[Params::lateDiffusionIndex];
+    s.diffusionStages = juce::jlimit (0, DSP::DiffusionCascade::maxStages, juce::roundToInt (values[Params::diffusionStagesIndex]));
+    s.longPredelayS   = values[Params::longPredelayIndex];
+    s.preEcho         = values[Params::preEchoIndex];
+    s.freeze          = values[Params::freezeIndex] >= 0.5f;
+    s.earlyEngine     = juce::jlimit (0, 1, juce::roundToInt (values[Params::earlyEngineIndex]));
+    s.earlyDensity    = values[Params::earlyDensityIndex];
+    s.earlyRoom       = values[Params::earlyRoomIndex] >= 0.5f;
+    s.room.widthM     = values[Params::roomWidthIndex];
+    s.room.depthM     = values[Params::roomDepthIndex];
+    s.room.heightM    = values[Params::roomHeightIndex];
+    s.room.absorption = values[Params::roomAbsorptionIndex];
+    s.room.sourceX    = values[Params::sourceXIndex];
+    s.room.sourceY    = values[Params::sourceYIndex];
+    s.room.listenerX  = values[Params::listenerXIndex];
+    s.room.listenerY  = values[Params::listenerYIndex];
+    s.lowDecay        = values[Params::lowDecayIndex];
+    s.highDecay       = values[Params::highDecayIndex];
+    s.lowCrossoverHz  = values[Params::lowCrossoverIndex];
+    s.highCrossoverHz = values[Params::highCrossoverIndex];
+    s.predelaySync    = values[Params::predelaySyncIndex] >= 0.5f;
+    s.predelayNote    = juce::jlimit (0, (int) DSP::Predelay::noteBeats.size() - 1, juce::roundToInt (values[Params::predelayNoteIndex]));
+    return s;
+}
+
+void ParameterSnapshot::applyTo (float* dest, const float* current) const
+{
+    for (size_t i = 0; i < values.size(); ++i)
+        if (covered[i] && (current[i] == base[i] || current[i] == values[i]))
+            dest[i] = values[i];
+}
+
+//==============================================================================
+namespace StateFormat
+{
+    void writeBinary (const float* values, int numValues, int program,
+                      const ProcessorOptions& options, juce::MemoryBlock& dest)
+    {
+        juce::MemoryOutputStream out (dest, false);
+        out.writeInt ((int) magic);
+        out.writeShort ((short) version);
+        out.writeShort ((short) numValues);
+        out.writeShort ((short) program);
+
+        for (int i = 0; i < numValues; ++i)
+            out.writeFloat (values[i]);
+
+        out.writeInt (options.internalBlockSize);
+        out.writeFloat (options.longDelaySeconds);
+        out.writeBool (options.compactDelays);
+        out.writeBool (options.adaptiveTank);
+    }
+
+    bool isBinary (const void* data, int sizeInBytes)
+    {
+        return sizeInBytes >= 4
+            && juce::ByteOrder::littleEndianInt (data) == magic;
+    }
+
+    bool readBinary (const void* data, int sizeInBytes, ParameterSnapshot& dest)
+    {
+        if (! isBinary (data, sizeInBytes))
+            return false;
+
+        juce::MemoryInputStream in (data, (size_t) sizeInBytes, false);
+        in.readInt();
+
+        auto fileVersion = (int) in.readShort();
+        auto count = (int) in.readShort();
+        auto program = (int) in.readShort();
+
+        if (fileVersion < 1 || count < 0 || in.getNumBytesRemaining() < (juce::int64) count * 4)
+            return false;
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto v = in.readFloat();
+
+            // Newer sessions may carry parameters this build does not know about
+            if (i < Params::numParameters)
+            {
+                dest.values[(size_t) i] = v;
+                dest.covered[(size_t) i] = true;
+            }
+        }
+
+        if (fileVersion >= 2 && in.getNumBytesRemaining() >= 4)
+        {
+            dest.options.internalBlockSize = in.readInt();
+            dest.hasOptions = true;
+        }
+
+        if (fileVersion >= 3 && in.getNumBytesRemaining() >= 4)
+            dest.options.longDelaySeconds = in.readFloat();
+
+        if (fileVersion >= 4 && in.getNumBytesRemaining() >= 1)
+            dest.options.compactDelays = in.readBool();
+
+        if (fileVersion >= 5 && in.getNumBytesRemaining() >= 1)
+            dest.options.adaptiveTank = in.readBool();
+
+        dest.program = program;
+        return true;
+    }
+
+    bool readXml (const void* data, int sizeInBytes, ParameterSnapshot& dest, juce::ValueTree& tree)
+    {
+        std::unique_ptr<juce::XmlElement> xml (juce::AudioProcessor::getXmlFromBinary (data, sizeInBytes));
+
+        if (xml == nullptr || ! xml->hasTagName ("Parameters"))
+            return false;
+
+        tree = juce::ValueTree::fromXml (*xml);
+
+        for (int i = 0; i < Params::numParameters; ++i)
+        {
+            auto param = tree.getChildWithProperty ("id", Params::idForIndex (i));
+
+            if (param.isValid() && param.hasProperty ("value"))
+            {
+                dest.values[(size_t) i] = (float) param.getProperty ("value");
+                dest.covered[(size_t) i] = true;
+            }
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+PresetEngine::PresetEngine (CommitCallback onCommit)
+    : juce::Thread ("Antigrav Preset Engine"),
+      commitCallback (std::move (onCommit))
+{
+}
+
+PresetEngine::~PresetEngine()
+{
+    cancelPendingUpdate();
+    stopThread (2000);
+}
+
+const char* PresetEngine::getProgramName (int index)
+{
+    if (juce::isPositiveAndBelow (index, numPrograms))
+        return factoryPrograms[index].name;
+
+    return "";
+}
+
+void PresetEngine::requestProgram (int index, const float* currentValues)
+{
+    if (! juce::isPositiveAndBelow (index, numPrograms))
+        return;
+
+    Request r;
+    r.program = index;
+    std::copy (currentValues, currentValues + Params::numParameters, r.base.begin());
+    submit (std::move (r));
+}
+
+void PresetEngine::requestState (const void* data, int sizeInBytes, const float* currentValues)
+{
+    Request r;
+    r.state.replaceAll (data, (size_t) sizeInBytes);
+    std::copy (currentValues, currentValues + Params::numParameters, r.base.begin());
+    submit (std::move (r));
+}
+
+void PresetEngine::submit (Request&& request)
+{
+    {
+        const juce::ScopedLock sl (requestLock);
+        request.serial = nextSerial++;
+
+        // Only the newest request matters, an unprocessed older one is simply replaced
+        pendingRequest = std::move (request);
+        hasPendingRequest = true;
+        builtEvent.reset();
+    }
+
+    if (! isThreadRunning())
+        startThread();
+
+    notify();
+}
+
+void PresetEngine::flush()
+{
+    juce::uint32 target = 0;
+
+    {
+        const juce::ScopedLock sl (requestLock);
+        target = nextSerial - 1;
+    }
+
+    while (builtSerial.load (std::memory_order_acquire) < target)
+        builtEvent.wait (50);
+}
+
+void PresetEngine::commitPending()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    handleUpdateNowIfNeeded();
+}
+
+bool PresetEngine::getPendingSnapshot (ParameterSnapshot& dest) const
+{
+    const juce::ScopedLock sl (commitLock);
+
+    if (! hasPendingCommit)
+        return false;
+
+    dest = commitSnapshot;
+    return true;
+}
+
+void PresetEngine::run()
+{
+    while (! threadShouldExit())
+    {
+        Request request;
+        bool hasRequest = false;
+
+        {
+            const juce::ScopedLock sl (requestLock);
+
+            if (hasPendingRequest)
+            {
+                request = std::move (pendingRequest);
+                hasPendingRequest = false;
+                hasRequest = true;
+            }
+        }
+
+        if (! hasRequest)
+        {
+            wait (-1);
+            continue;
+        }
+
+        ParameterSnapshot snapshot;
+        juce::ValueTree tree;
+
+        if (build (request, snapshot, tree))
+        {
+            toAudio.getWriteSlot() = snapshot;
+            toAudio.publish();
+
+            {
+                const juce::ScopedLock sl (commitLock);
+                commitSnapshot = snapshot;
+                commitTree = tree;
+                hasPendingCommit = true;
+            }
+
+            triggerAsyncUpdate();
+        }
+
+        builtSerial.store (request.serial, std::memory_order_release);
+        builtEvent.signal();
+    }
+}
+
+bool PresetEngine::build (const Request& request, ParameterSnapshot& snapshot, juce::ValueTree& tree) const
+{
+    snapshot.values = request.base;
+    snapshot.base = request.base;
+    snapshot.serial = request.serial;
+
+    if (request.program >= 0)
+    {
+        for (auto& pv : factoryPrograms[request.program].values)
+        {
+            snapshot.values[(size_t) pv.index] = pv.value;
+            snapshot.covered[(size_t) pv.index] = true;
+        }
+
+        snapshot.program = request.program;
+    }
+    else
+    {
+        auto* data = request.state.getData();
+        auto size = (int) request.state.getSize();
+
+        bool ok = StateFormat::isBinary (data, size)
+                    ? StateFormat::readBinary (data, size, snapshot)
+                    : StateFormat::readXml (data, size, snapshot, tree);
+
+        if (! ok)
+            return false;
+    }
+
+    return true;
+}
+
+void PresetEngine::handleAsyncUpdate()
+{
+    ParameterSnapshot snapshot;
+    juce::ValueTree tree;
+
+    {
+        const juce::ScopedLock sl (commitLock);
+
+        if (! hasPendingCommit)
+            return;
+
+        snapshot = commitSnapshot;
+        tree = commitTree;
+    }
+
+    if (commitCallback != nullptr)
+        commitCallback (snapshot, tree);
+
+    {
+        // Pending until the APVTS holds all of it, so a state saved meanwhile takes the snapshot
+        const juce::ScopedLock sl (commitLock);
+
+        if (commitSnapshot.serial == snapshot.serial)
+            hasPendingCommit = false;
+    }
+
+    committedSerial.store (snapshot.serial, std::memory_order_release);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+#include "DSP/ReverbEngine.h"
+#include "DSP/TripleBuffer.h"
+#include <array>
+#include <functional>
+
+/** Session settings that are not host parameters. */
+struct ProcessorOptions
+{
+    int internalBlockSize = 0;  // 0 = process host blocks directly
+    float longDelaySeconds = 0.0f; // Long predelay capacity, 0 = long-delay mode off
+    bool compactDelays = false;    // Half-float late tank lines
+    bool adaptiveTank = false;     // Late tank sheds detail as the tail decays
+};
+
+/**
+ * @brief A program or session, parsed off the audio thread so the audio thread only has to copy it.
+ * It sets the covered parameters only; the others keep whatever value they have when it is applied.
+ */
+struct ParameterSnapshot
+{
+    std::array<float, Params::numParameters> values {};
+    std::array<float, Params::numParameters> base {};   // The values when it was requested
+    std::array<bool, Params::numParameters> covered {}; // Set by the program / present in the session
+    int program = -1;
+    ProcessorOptions options;
+    bool hasOptions = false;
+    juce::uint32 serial = 0;
+
+    /**
+     * Lays the snapshot over values: each covered parameter takes its value, unless its live raw
+     * value (current) has moved off base since the request to something else. Such a move
+     * (automation, the UI) came later and wins; the commit itself does not count as one.
+     * values and current may be the same array.
+     */
+    void applyTo (float* values, const float* current) const;
+};
+
+/** Converts raw (denormalised) parameter values to engine settings. */
+DSP::ReverbSettings makeReverbSettings(const float* values);
+
+/**
+ * @brief Compact binary session format, written next to the legacy XML one.
+ * Layout (little endian): magic, version, parameter count, program, count x float32 in Params::Index order,
+ * then the ProcessorOptions (internal block size from version 2, long-delay capacity from version 3,
+ * compact delay storage from version 4, adaptive tank detail from version 5).
+ */
+namespace StateFormat
+{
+    constexpr juce::uint32 magic = 0x42524741; // "AGRB"
+    constexpr int version = 5;
+
+    void writeBinary(const float* values, int numValues, int program,
+                     const ProcessorOptions& options, juce::MemoryBlock& dest);
+    bool isBinary(const void* data, int sizeInBytes);
+
+    /** Fills (and marks covered) the values present in data, leaving the others untouched. */
+    bool readBinary(const void* data, int sizeInBytes, ParameterSnapshot& dest);
+
+    /** Reads the APVTS XML state (as written by copyXmlToBinary) into dest and the parsed tree. */
+    bool readXml(const void* data, int sizeInBytes, ParameterSnapshot& dest, juce::ValueTree& tree);
+}
+
+/**
+ * @brief Prepares program and session changes on a background thread.
+ * The finished snapshot goes to the audio thread through a triple buffer, and to the
+ * message thread (to update the APVTS) through the commit callback.
+ */
+class PresetEngine : private juce::Thread,
+                     private juce::AsyncUpdater
+{
+public:
+    /** Called on the message thread. tree is valid only for XML sessions. */
+    using CommitCallback = std::function<void (const ParameterSnapshot&, const juce::ValueTree& tree)>;
+
+    explicit PresetEngine (CommitCallback onCommit);
+    ~PresetEngine() override;
+
+    static constexpr int numPrograms = 3;
+    static const char* getProgramName (int index);
+
+    /** Message thread: switches to a factory program. currentValues are the values it is layered on. */
+    void requestProgram (int index, const float* currentValues);
+
+    /** Message thread: loads a session blob (binary or XML). */
+    void requestState (const void* data, int sizeInBytes, const float* currentValues);
+
+    /**
+     * Any thread: blocks until all requests are built. Committing them stays with the message
+     * thread; until it has, getPendingSnapshot() has the values they bring.
+     */
+    void flush();
+
+    /** Message thread: commits a built snapshot now instead of waiting for the async update. */
+    void commitPending();
+
+    /** Any thread: the newest built snapshot not yet fully committed, false if there is none. */
+    bool getPendingSnapshot (ParameterSnapshot& dest) const;
+
+    /** Audio thread: newest snapshot not yet seen, or nullptr. */
+    const ParameterSnapshot* pollSnapshot() { return toAudio.acquire(); }
+
+    /** Serial of the last snapshot written back to the APVTS. */
+    juce::uint32 getCommittedSerial() const { return committedSerial.load (std::memory_order_acquire); }
+
+private:
+    struct Request
+    {
+        int program = -1;
+        juce::MemoryBlock state;
+        std::array<float, Params::numParameters> base {};
+        juce::uint32 serial = 0;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+    void submit (Request&& request);
+    bool build (const Request& request, ParameterSnapshot& snapshot, juce::ValueTree& tree) const;
+
+    CommitCallback commitCallback;
+
+    juce::CriticalSection requestLock;
+    Request pendingRequest;
+    bool hasPendingRequest = false;
+    juce::uint32 nextSerial = 1;
+
+    juce::CriticalSection commitLock;
+    ParameterSnapshot commitSnapshot;
+    juce::ValueTree commitTree;
+    bool hasPendingCommit = false;
+
+    DSP::TripleBuffer<ParameterSnapshot> toAudio;
+    std::atomic<juce::uint32> committedSerial { 0 };
+    std::atomic<juce::uint32> builtSerial { 0 };
+    juce::WaitableEvent builtEvent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetEngine)
+};
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <map>
 
 namespace UI
 {
+    /**
+     * @brief The plugin's look. Static knob bodies are rendered once per physical pixel size and
+     * blitted, so a knob repaint only strokes its value arc.
+     */
     class DarkLookAndFeel : public juce::LookAndFeel_V4
     {
     public:
@@ -32,9 +37,9 @@ namespace UI
             auto rw = radius * 2.0f;
             auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
 
-            // Background
-            g.setColour (findColour (juce::Slider::rotarySliderOutlineColourId));
-            g.fillEllipse (rx, ry, rw, rw);
+            // Background, cached at the size it ends up on screen
+            auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+            g.drawImage (getKnobBody (rw, scale), juce::Rectangle<float> (rx, ry, rw, rw));
             
             // Arc
             juce::Path p;
@@ -68,5 +73,38 @@ namespace UI
                  g.fillRect(fillRect);
             }
         }
+
+        /** Number of knob body images currently cached (one per distinct on-screen size). */
+        int getNumCachedKnobBodies() const { return (int) knobBodies.size(); }
+
+        /** Drops the cached layers, e.g. after a colour change. */
+        void clearCaches() { knobBodies.clear(); }
+
+    private:
+        const juce::Image& getKnobBody (float diameter, float scale)
+        {
+            const int pixels = juce::jmax (1, juce::roundToInt (diameter * scale));
+
+            auto it = knobBodies.find (pixels);
+            if (it != knobBodies.end())
+                return it->second;
+
+            // Sizes only change on resize / scale, so this stays tiny; guard against endless live resizing
+            if (knobBodies.size() >= maxCachedKnobBodies)
+                knobBodies.clear();
+
+            juce::Image image (juce::Image::ARGB, pixels, pixels, true);
+            {
+                juce::Graphics ig (image);
+                ig.setColour (findColour (juce::Slider::rotarySliderOutlineColourId));
+                ig.fillEllipse (0.0f, 0.0f, (float) pixels, (float) pixels);
+            }
+
+            return knobBodies.emplace (pixels, std::move (image)).first->second;
+        }
+
+        static constexpr size_t maxCachedKnobBodies = 16;
+
+        std::map<int, juce::Image> knobBodies;
     };
 }
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+namespace UI
+{
+    /**
+     * @brief Paint time accounting for an editor (or all of them), message thread only.
+     * A frame is one pass over the editor and its children, however much of it was dirty.
+     */
+    struct RenderStats
+    {
+        juce::int64 frames = 0;
+        juce::int64 totalTicks = 0;
+        juce::int64 maxTicks = 0;
+        int cacheRebuilds = 0;      // Cached layers re-rendered (resize / scale change)
+
+        void addFrame(juce::int64 ticks)
+        {
+            ++frames;
+            totalTicks += ticks;
+            maxTicks = juce::jmax(maxTicks, ticks);
+        }
+
+        double getTotalMs() const { return juce::Time::highResolutionTicksToSeconds(totalTicks) * 1000.0; }
+        double getMaxMs() const { return juce::Time::highResolutionTicksToSeconds(maxTicks) * 1000.0; }
+        double getAverageMs() const { return frames > 0 ? getTotalMs() / (double)frames : 0.0; }
+
+        void reset() { *this = {}; }
+    };
+
+    /**
+     * @brief One repaint clock shared by every open editor, held through juce::SharedResourcePointer.
+     *
+     * Animated components call requestRepaint() instead of running their own timers. Requests are
+     * coalesced and served together on the next display vblank, delivered by whichever attached
+     * editor window sees it first; further vblanks of the same frame (other windows) are ignored.
+     * Components that poll a data source (e.g. analysis frames) register as a FrameClient and are
+     * asked to update once per frame, before the repaints are served.
+     * Also collects the render stats of all editors. Message thread only.
+     */
+    class RepaintScheduler
+    {
+    public:
+        /** Polled once per display frame. */
+        struct FrameClient
+        {
+            virtual ~FrameClient() = default;
+            virtual void updateFrame() = 0;
+        };
+
+        RepaintScheduler() = default;
+
+        /** Starts listening to the vblanks of the editor's window. */
+        void attach(juce::Component& editor)
+        {
+            attachments.push_back({ &editor, std::make_unique<juce::VBlankAttachment>(&editor, [this](double timestampSec)
+            {
+                onVBlank(timestampSec);
+            }) });
+        }
+
+        void detach(juce::Component& editor)
+        {
+            cancel(editor);
+            attachments.erase(std::remove_if(attachments.begin(), attachments.end(),
+                                             [&](const Attachment& a) { return a.editor == &editor; }),
+                              attachments.end());
+        }
+
+        /** Repaints the component on the next frame. Repeated requests within a frame cost nothing. */
+        void requestRepaint(juce::Component& component)
+        {
+            for (auto& c : dirty)
+                if (c == &component)
+                    return;
+
+            dirty.push_back(&component);
+        }
+
+        /** Drops pending requests for a component (or its children) that is about to go away. */
+        void cancel(juce::Component& component)
+        {
+            dirty.erase(std::remove_if(dirty.begin(), dirty.end(), [&](const juce::Component::SafePointer<juce::Component>& c)
+            {
+                return c == nullptr || c == &component || component.isParentOf(c);
+            }), dirty.end());
+        }
+
+        void addFrameClient(FrameClient& client) { clients.addIfNotAlreadyThere(&client); }
+        void removeFrameClient(FrameClient& client) { clients.removeFirstMatchingValue(&client); }
+
+        int getNumAttachedEditors() const { return (int)attachments.size(); }
+        int getNumPendingRepaints() const { return (int)dirty.size(); }
+
+        /** Totals over every editor since the scheduler was created. */
+        RenderStats& getStats() { return stats; }
+
+        /** Serves the pending requests; normally called by the vblank attachments. */
+        void onVBlank(double timestampSec)
+        {
+            // Several windows report the same display refresh
+            if (timestampSec - lastFrameSec < minFrameIntervalSec)
+                return;
+
+            lastFrameSec = timestampSec;
+
+            for (int i = clients.size(); --i >= 0;)
+                clients.getUnchecked(i)->updateFrame();
+
+            // Swap first, a repaint may queue the next frame's request
+            std::swap(dirty, serving);
+            for (auto& c : serving)
+                if (c != nullptr)
+                    c->repaint();
+
+            serving.clear();
+        }
+
+    private:
+        struct Attachment
+        {
+            juce::Component* editor;
+            std::unique_ptr<juce::VBlankAttachment> vblank;
+        };
+
+        // Half a frame at 240 Hz: separates refreshes, merges the same one reported by several windows
+        static constexpr double minFrameIntervalSec = 0.002;
+
+        std::vector<Attachment> attachments;
+        juce::Array<FrameClient*> clients;
+        std::vector<juce::Component::SafePointer<juce::Component>> dirty, serving;
+        double lastFrameSec = -1.0;
+        RenderStats stats;
+
+        JUCE_DECLARE_NON_COPYABLE (RepaintScheduler)
+    };
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RepaintScheduler.h"
+#include "../Analysis/SpectrumAnalyser.h"
+#include <array>
+
+namespace UI
+{
+    /**
+     * @brief Wet output spectrum, a waterfall of its recent history and the decay envelope.
+     *
+     * Owns the SpectrumAnalyser, so the analysis thread runs only while the display exists. New
+     * frames are picked up on the shared vblank; the waterfall is an image that scrolls by one row
+     * per displayed frame, so a repaint only blits it and strokes two short paths.
+     */
+    class SpectrumDisplay : public juce::Component,
+                            private RepaintScheduler::FrameClient
+    {
+    public:
+        static constexpr int numColumns = 160;     // Log-frequency columns, 20 Hz - 20 kHz
+        static constexpr int historyRows = 96;     // Waterfall depth in displayed frames
+
+        explicit SpectrumDisplay(DSP::AnalysisFifo& fifo) : analyser(fifo)
+        {
+            setOpaque(true);
+            columnsDb.fill(Analysis::SpectrumAnalyser::floorDb);
+            levelDb.fill(Analysis::SpectrumAnalyser::floorDb);
+
+            waterfall = juce::Image(juce::Image::RGB, numColumns, historyRows, true);
+
+            juce::ColourGradient heat(juce::Colour(20, 20, 24), 0.0f, 0.0f, juce::Colours::white, 1.0f, 0.0f, false);
+            heat.addColour(0.45, juce::Colour(120, 20, 30));
+            heat.addColour(0.75, juce::Colour(230, 90, 40));
+            for (size_t i = 0; i < palette.size(); ++i)
+                palette[i] = heat.getColourAtPosition((double)i / (double)(palette.size() - 1));
+
+            scheduler->addFrameClient(*this);
+        }
+
+        ~SpectrumDisplay() override
+        {
+            scheduler->removeFrameClient(*this);
+            scheduler->cancel(*this);
+        }
+
+        /** Frames taken from the analyser so far. */
+        int getNumFramesShown() const { return framesShown; }
+
+        void paint(juce::Graphics& g) override
+        {
+            g.fillAll(juce::Colour(14, 14, 17));
+
+            // Waterfall behind the spectrum: newest row on top, stretched over the area
+            g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+            g.setOpacity(0.8f);
+            g.drawImage(waterfall, spectrumArea);
+            g.setOpacity(1.0f);
+
+            // Spectrum of the newest frame
+            juce::Path spectrum;
+            for (int c = 0; c < numColumns; ++c)
+            {
+                float x = spectrumArea.getX() + spectrumArea.getWidth() * (float)c / (float)(numColumns - 1);
+                float y = dbToY(columnsDb[(size_t)c], spectrumArea);
+                if (c == 0) spectrum.startNewSubPath(x, y);
+                else        spectrum.lineTo(x, y);
+            }
+            g.setColour(juce::Colour(255, 60, 60));
+            g.strokePath(spectrum, juce::PathStrokeType(1.5f));
+
+            // Decay envelope: RMS level over the last few seconds, newest on the right
+            g.setColour(juce::Colours::black.withAlpha(0.3f));
+            g.fillRect(envelopeArea);
+
+            juce::Path envelope;
+            for (size_t i = 0; i < levelDb.size(); ++i)
+            {
+                float x = envelopeArea.getX() + envelopeArea.getWidth() * (float)i / (float)(levelDb.size() - 1);
+                float y = dbToY(levelDb[i], envelopeArea);
+                if (i == 0) envelope.startNewSubPath(x, y);
+                else        envelope.lineTo(x, y);
+            }
+            g.setColour(juce::Colours::white.withAlpha(0.8f));
+            g.strokePath(envelope, juce::PathStrokeType(1.0f));
+        }
+
+        void resized() override
+        {
+            auto area = getLocalBounds().toFloat().reduced(4.0f);
+            envelopeArea = area.removeFromRight(area.getWidth() * 0.3f);
+            area.removeFromRight(6.0f);
+            spectrumArea = area;
+        }
+
+    private:
+        void updateFrame() override
+        {
+            auto* frame = analyser.acquireFrame();
+            if (frame == nullptr)
+                return;
+
+            if (frame->sampleRate != columnSampleRate)
+                mapColumns(frame->sampleRate);
+
+            // Each column shows the loudest bin it covers
+            for (int c = 0; c < numColumns; ++c)
+            {
+                float peak = Analysis::SpectrumAnalyser::floorDb;
+                for (int k = firstBin[(size_t)c]; k <= lastBin[(size_t)c]; ++k)
+                    peak = juce::jmax(peak, frame->magnitudeDb[(size_t)k]);
+                columnsDb[(size_t)c] = peak;
+            }
+
+            levelDb = frame->levelDb;
+            addWaterfallRow();
+
+            ++framesShown;
+            scheduler->requestRepaint(*this);
+        }
+
+        void mapColumns(double sampleRate)
+        {
+            columnSampleRate = sampleRate;
+            const double binHz = sampleRate / Analysis::SpectrumFrame::fftSize;
+            const double lo = 20.0, hi = juce::jmin(20000.0, 0.5 * sampleRate);
+
+            for (int c = 0; c < numColumns; ++c)
+            {
+                double f0 = lo * std::pow(hi / lo, (double)c / numColumns);
+                double f1 = lo * std::pow(hi / lo, (double)(c + 1) / numColumns);
+                int k0 = juce::jlimit(1, Analysis::SpectrumFrame::numBins - 1, (int)std::round(f0 / binHz));
+                int k1 = juce::jlimit(k0, Analysis::SpectrumFrame::numBins - 1, (int)std::round(f1 / binHz) - 1);
+                firstBin[(size_t)c] = k0;
+                lastBin[(size_t)c] = k1;
+            }
+        }
+
+        void addWaterfallRow()
+        {
+            waterfall.moveImageSection(0, 1, 0, 0, numColumns, historyRows - 1);
+
+            juce::Image::BitmapData row(waterfall, 0, 0, numColumns, 1, juce::Image::BitmapData::writeOnly);
+            for (int c = 0; c < numColumns; ++c)
+            {
+                float t = juce::jlimit(0.0f, 1.0f, (columnsDb[(size_t)c] - displayFloorDb) / -displayFloorDb);
+                row.setPixelColour(c, 0, palette[(size_t)(t * (float)(palette.size() - 1))]);
+            }
+        }
+
+        static float dbToY(float db, juce::Rectangle<float> area)
+        {
+            float t = juce::jlimit(0.0f, 1.0f, (db - displayFloorDb) / -displayFloorDb);
+            return area.getBottom() - t * area.getHeight();
+        }
+
+        static constexpr float displayFloorDb = -90.0f;
+
+        juce::SharedResourcePointer<RepaintScheduler> scheduler;
+        Analysis::SpectrumAnalyser analyser;
+
+        std::array<float, numColumns> columnsDb {};
+        std::array<int, numColumns> firstBin {}, lastBin {};
+        std::array<float, Analysis::SpectrumFrame::levelHistorySize> levelDb {};
+        double columnSampleRate = 0.0;
+        int framesShown = 0;
+
+        juce::Image waterfall;
+        std::array<juce::Colour, 256> palette;
+        juce::Rectangle<float> spectrumArea, envelopeArea;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumDisplay)
+    };
+}
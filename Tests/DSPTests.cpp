@@ -1,6 +1,9 @@
 #include <JuceHeader.h>
 #include "../Source/DSP/AllpassFilter.h"
 #include "../Source/DSP/LFO.h"
+#include "../Source/DSP/ModulationBank.h"
+#include "../Source/DSP/DiffusionCascade.h"
+#include "../Source/DSP/DampingFilterBank.h"
 
 class DSPTests : public juce::UnitTest
 {
@@ -36,6 +39,83 @@ public:
             // We can check energy conservation roughly or just stability
         }
 
+        beginTest("Diffusion Cascade");
+        {
+            // One stage must match the per-sample AllpassFilter exactly (1 ms = 1 sample here)
+            DSP::DiffusionCascade cascade;
+            cascade.prepare(1000.0);
+            cascade.setNumStages(1);
+            cascade.setFeedback(0.5f);
+
+            DSP::AllpassFilter apf;
+            apf.prepare(1000.0, 20.0);
+            apf.setDelay(1.0f);
+            apf.setFeedback(0.5f);
+
+            float left[64], right[64];
+            juce::Random rng(3);
+            for (int i = 0; i < 64; ++i) left[i] = right[i] = rng.nextFloat() * 2.0f - 1.0f;
+
+            float expected[64];
+            for (int i = 0; i < 64; ++i) expected[i] = apf.process(left[i]);
+
+            // Odd block sizes exercise the span splitting
+            cascade.process(left, right, 13);
+            cascade.process(left + 13, right + 13, 51);
+
+            float maxError = 0.0f;
+            for (int i = 0; i < 64; ++i) maxError = juce::jmax(maxError, std::abs(left[i] - expected[i]));
+            expectWithinAbsoluteError(maxError, 0.0f, 1.0e-6f);
+
+            // Stereo, the channels run together with their own delays (12 and 17 samples here)
+            DSP::DiffusionCascade stereo;
+            stereo.prepare(10000.0);
+            stereo.setNumStages(1);
+            stereo.setFeedback(0.5f);
+
+            DSP::AllpassFilter apfL, apfR;
+            for (auto* f : { &apfL, &apfR })
+            {
+                f->prepare(10000.0, 20.0);
+                f->setFeedback(0.5f);
+            }
+            apfL.setDelay(1.2f); // The cascade's 1.3 ms truncates to 12 samples
+            apfR.setDelay(1.7f);
+
+            float stereoL[200], stereoR[200], expectedL[200], expectedR[200];
+            for (int i = 0; i < 200; ++i)
+            {
+                stereoL[i] = rng.nextFloat() * 2.0f - 1.0f;
+                stereoR[i] = rng.nextFloat() * 2.0f - 1.0f;
+                expectedL[i] = apfL.process(stereoL[i]);
+                expectedR[i] = apfR.process(stereoR[i]);
+            }
+
+            stereo.process(stereoL, stereoR, 37);
+            stereo.process(stereoL + 37, stereoR + 37, 163);
+
+            maxError = 0.0f;
+            for (int i = 0; i < 200; ++i)
+                maxError = juce::jmax(maxError, std::abs(stereoL[i] - expectedL[i]), std::abs(stereoR[i] - expectedR[i]));
+            expectWithinAbsoluteError(maxError, 0.0f, 1.0e-5f);
+
+            // The full cascade is allpass: an impulse keeps its energy
+            DSP::DiffusionCascade full;
+            full.prepare(48000.0);
+            full.setNumStages(DSP::DiffusionCascade::maxStages);
+            full.setFeedback(0.6f);
+
+            std::vector<float> l(48000, 0.0f), r(48000, 0.0f);
+            l[0] = r[0] = 1.0f;
+            for (int pos = 0; pos < 48000; pos += 500)
+                full.process(l.data() + pos, r.data() + pos, 500);
+
+            double energyL = 0.0, energyR = 0.0;
+            for (int i = 0; i < 48000; ++i) { energyL += l[(size_t)i] * l[(size_t)i]; energyR += r[(size_t)i] * r[(size_t)i]; }
+            expectWithinAbsoluteError(energyL, 1.0, 1.0e-3);
+            expectWithinAbsoluteError(energyR, 1.0, 1.0e-3);
+        }
+
         beginTest("LFO");
         {
             DSP::LFO lfo;
@@ -50,6 +130,161 @@ public:
             float expected = (float)std::sin(2.0 * juce::MathConstants<double>::pi * 0.01);
             expectWithinAbsoluteError(lfo.process(), expected, 0.0001f);
         }
+
+        beginTest("LFO Triangle");
+        {
+            DSP::LFO lfo;
+            lfo.prepare(100.0);
+            lfo.setFrequency(1.0f);
+            lfo.setDepth(1.0f);
+            lfo.setWaveform(DSP::LFO::Waveform::Triangle);
+
+            // Starts at zero, peaks a quarter cycle in, like the sine
+            expectWithinAbsoluteError(lfo.process(), 0.0f, 0.0001f);
+            for (int i = 0; i < 24; ++i) lfo.process();
+            expectWithinAbsoluteError(lfo.process(), 1.0f, 0.0001f);
+        }
+
+        beginTest("Control-rate Modulation Bank");
+        {
+            // The linear segments must track the per-sample LFO closely at the rates we use
+            const double sr = 48000.0;
+            DSP::ModulationBank<2> bank;
+            bank.prepare(sr, 16);
+
+            std::array<DSP::LFO, 2> reference;
+            const float rates[2] = { 0.45f, 5.0f };
+            for (size_t i = 0; i < 2; ++i)
+            {
+                bank.setFrequency(i, rates[i]);
+                bank.setDepth(i, 3.0f);
+                reference[i].prepare(sr);
+                reference[i].setFrequency(rates[i]);
+                reference[i].setDepth(3.0f);
+            }
+
+            float maxError = 0.0f;
+            float values[2];
+            for (int n = 0; n < 48000; )
+            {
+                if (bank.getSamplesUntilTick() == 0)
+                    bank.tick();
+
+                int span = bank.getSamplesUntilTick();
+                std::copy(bank.getValues(), bank.getValues() + 2, values);
+
+                for (int k = 0; k < span; ++k, ++n)
+                {
+                    for (size_t i = 0; i < 2; ++i)
+                    {
+                        float expected = (float)std::sin(2.0 * juce::MathConstants<double>::pi * rates[i] * n / sr) * 3.0f;
+                        maxError = juce::jmax(maxError, std::abs(values[i] - expected));
+                        values[i] += bank.getIncrements()[i];
+                    }
+                }
+
+                bank.advance(span);
+            }
+
+            expect(maxError < 0.001f, "Control-rate modulation should stay within 0.001 ms of the LFO");
+        }
+
+        beginTest("Modulation Bank Skip");
+        {
+            // Skipping lands where running would have, random waveform (and its draws) included
+            DSP::ModulationBank<4> ran, skipped;
+            for (auto* bank : { &ran, &skipped })
+            {
+                bank->prepare(48000.0, 16);
+                bank->setWaveform(DSP::LFO::Waveform::SmoothRandom);
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    bank->setFrequency(i, 2.0f + (float)i);
+                    bank->setDepth(i, 3.0f);
+                }
+            }
+
+            auto run = [](DSP::ModulationBank<4>& bank, int numSamples)
+            {
+                while (numSamples > 0)
+                {
+                    if (bank.getSamplesUntilTick() == 0)
+                        bank.tick();
+
+                    const int n = juce::jmin(numSamples, bank.getSamplesUntilTick(), 100);
+                    bank.advance(n);
+                    numSamples -= n;
+                }
+            };
+
+            run(ran, 5);
+            skipped.skip(5);
+            run(ran, 480007);
+            skipped.skip(480007);
+
+            float maxError = 0.0f;
+            for (int block = 0; block < 100; ++block)
+            {
+                run(ran, 37);
+                run(skipped, 37);
+                for (size_t i = 0; i < 4; ++i)
+                    maxError = juce::jmax(maxError, std::abs(ran.getValues()[i] - skipped.getValues()[i]));
+            }
+
+            expectLessThan(maxError, 1.0e-5f);
+        }
+
+        beginTest("Damping Filter Bank");
+        {
+            constexpr double sr = 48000.0;
+
+            // Lane 0: plain hi cut / lo cut, lane 1: the same with low and high T60 shelves
+            DSP::DampingResponse plain;
+            plain.loCutHz = 100.0f;
+            plain.hiCutHz = 5000.0f;
+
+            auto shelved = plain;
+            shelved.lowCrossoverHz = 200.0f;
+            shelved.highCrossoverHz = 4000.0f;
+            shelved.lowGain = 0.5f;
+            shelved.highGain = 0.25f;
+
+            DSP::DampingFilterBank<2> bank;
+            bank.setLane(0, sr, plain);
+            bank.setLane(1, sr, shelved);
+
+            // Steady-state gain of both lanes for a sine
+            auto gains = [&](float hz)
+            {
+                bank.reset();
+                double in = 0.0, out[2] = {};
+                for (int n = 0; n < 48000; ++n)
+                {
+                    const float x = (float)std::sin(2.0 * juce::MathConstants<double>::pi * hz * n / sr);
+                    float lanes[2] = { x, x };
+                    bank.process(lanes);
+
+                    if (n >= 24000)
+                    {
+                        in += x * x;
+                        out[0] += lanes[0] * lanes[0];
+                        out[1] += lanes[1] * lanes[1];
+                    }
+                }
+                return std::array<float, 2> { (float)std::sqrt(out[0] / in), (float)std::sqrt(out[1] / in) };
+            };
+
+            // First-order slopes, -3 dB at both cut-offs and flat in between
+            expectWithinAbsoluteError(gains(100.0f)[0], 0.707f, 0.02f);
+            expectWithinAbsoluteError(gains(5000.0f)[0], 0.707f, 0.02f);
+            expectWithinAbsoluteError(gains(700.0f)[0], 0.97f, 0.03f);
+
+            // Shelves: the band gains well below and above the crossovers, unity in the middle
+            auto low = gains(40.0f), mid = gains(900.0f), high = gains(18000.0f);
+            expectWithinAbsoluteError(low[1] / low[0], 0.5f, 0.05f);
+            expectWithinAbsoluteError(mid[1] / mid[0], 1.0f, 0.15f);
+            expectWithinAbsoluteError(high[1] / high[0], 0.25f, 0.04f);
+        }
     }
 };
 
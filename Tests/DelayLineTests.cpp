@@ -1,5 +1,10 @@
 #include <JuceHeader.h>
 #include "../Source/DSP/DelayLine.h"
+#include "../Source/DSP/LongDelay.h"
+#include "../Source/DSP/Predelay.h"
+#include "../Source/DSP/Float16DelayBank.h"
+#include "../Source/DSP/DelayArena.h"
+#include "../Source/DSP/DiffusionCascade.h"
 
 class DelayLineTests : public juce::UnitTest
 {
@@ -75,6 +80,276 @@ public:
         // interpolate buffer[0] mult 0.5 + buffer[1] mult 0.5 = 1.0*0.5 + 2.0*0.5 = 1.5.
         delayLine.push(2.0f);
         expectEquals(delayLine.read(1.5f * 1000.0/sampleRate), 1.5f);
+
+        beginTest("Lazy Delay Memory");
+        {
+            // Silence never touches the storage; the first sound does, and reset() forgets it again
+            DSP::DelayLine line;
+            line.prepare(48000.0, 100.0);
+            for (int i = 0; i < 1000; ++i) line.push(0.0f);
+            expectEquals(line.read(1.0f), 0.0f);
+
+            DSP::DiffusionCascade cascade;
+            cascade.prepare(48000.0);
+            cascade.setNumStages(4);
+            cascade.setFeedback(0.5f);
+            float left[512] = {}, right[512] = {};
+            cascade.process(left, right, 512);
+            expect(cascade.isUntouched(), "Silent input should leave the cascade untouched");
+
+            left[0] = 1.0f;
+            cascade.process(left, right, 512);
+            expect(! cascade.isUntouched());
+
+            cascade.reset();
+            expect(cascade.isUntouched());
+
+            // Copies keep the contents (engine state transfer)
+            DSP::DelayMemory a, b;
+            a.allocate(64);
+            a.getWritePointer()[10] = 0.5f;
+            b = a;
+            expect(! b.isUntouched());
+            expectEquals(b.getReadPointer()[10], 0.5f);
+
+            a.clear();
+            b = a;
+            expect(b.isUntouched());
+            expectEquals(b.getReadPointer()[10], 0.0f);
+        }
+
+        beginTest("Long Delay");
+        {
+            // 10 s at 48 kHz: large enough to be mapped, and prefaulted by prepare()
+            DSP::LongDelay longDelay;
+            longDelay.prepare(48000.0, 10.0, 512);
+            expect(longDelay.getStorage().isMapped() || longDelay.getStorage().getAllocatedBytes() < DSP::LargeBuffer::mappedThresholdBytes);
+            expectEquals(longDelay.getStorage().getResidentBytes(), longDelay.getStorage().getAllocatedBytes());
+
+            longDelay.setDelaySeconds(8.0f);
+            longDelay.reset();
+
+            const int delaySamples = 8 * 48000;
+            float left[512], right[512];
+            bool exact = true;
+
+            for (int start = 0; start < delaySamples + 2048; start += 512)
+            {
+                for (int i = 0; i < 512; ++i)
+                {
+                    left[i] = (float)(start + i + 1);
+                    right[i] = -left[i];
+                }
+
+                longDelay.process(left, right, left, right, 512);
+
+                for (int i = 0; i < 512; ++i)
+                {
+                    float expected = (float)juce::jmax(0, start + i + 1 - delaySamples);
+                    exact = exact && left[i] == expected && right[i] == -expected;
+                }
+            }
+
+            expect(exact, "Output should be the input delayed by exactly 8 s");
+        }
+
+        beginTest("Predelay");
+        {
+            // 1 kHz, so 1 ms = 1 sample
+            DSP::Predelay predelay;
+            predelay.prepare(1000.0, 200.0, 64);
+            predelay.setDelayMs(37.0f);
+            predelay.reset();
+            expectEquals(predelay.getDelaySamples(), 37.0f);
+
+            int written = 0;
+            float inL[64], inR[64], outL[64], outR[64], again[64], unused[64];
+            auto nextBlock = [&]
+            {
+                for (int i = 0; i < 64; ++i)
+                {
+                    inL[i] = (float)(written + i + 1);
+                    inR[i] = -inL[i];
+                }
+
+                predelay.write(inL, inR, 64);
+                predelay.read(outL, outR, 64);
+                predelay.read(again, unused, 64);
+                written += 64;
+            };
+
+            bool exact = true, repeatable = true;
+            for (int b = 0; b < 10; ++b)
+            {
+                nextBlock();
+                for (int i = 0; i < 64; ++i)
+                {
+                    const float expected = (float)juce::jmax(0, written - 64 + i + 1 - 37);
+                    exact = exact && outL[i] == expected && outR[i] == -expected;
+                    repeatable = repeatable && again[i] == outL[i];
+                }
+            }
+
+            expect(exact, "At rest the output should be the input shifted by whole samples");
+            expect(repeatable, "Every read of a block should be the same");
+
+            // A change glides (50 ms = 50 samples here) and then settles on the new whole delay
+            predelay.setDelayMs(100.4f);
+            nextBlock();
+            expect(predelay.isGliding());
+            expect(predelay.getDelaySamples() == 37.0f);
+
+            for (int b = 0; b < 3; ++b)
+                nextBlock();
+
+            expect(! predelay.isGliding());
+            expectEquals(predelay.getDelaySamples(), 100.0f);
+
+            exact = true;
+            for (int i = 0; i < 64; ++i)
+                exact = exact && outL[i] == (float)(written - 64 + i + 1 - 100);
+            expect(exact, "After the glide the output should be an exact copy again");
+
+            // Tempo sync: a quarter note at 120 bpm, a dotted eighth at 90 bpm
+            expectWithinAbsoluteError(DSP::Predelay::noteToMs(9, 120.0), 500.0f, 1.0e-3f);
+            expectWithinAbsoluteError(DSP::Predelay::noteToMs(7, 90.0), 500.0f, 1.0e-3f);
+        }
+
+        beginTest("Float16 Delay Storage");
+        {
+            // Half floats survive the round trip exactly, everything else within half a step
+            for (float x : { 0.0f, 1.0f, -0.5f, 65504.0f, 1.0f / 1024.0f, 5.96046448e-8f })
+                expectEquals(DSP::Float16::toFloat(DSP::Float16::fromFloat(x)), x);
+
+            expect(DSP::Float16::fromFloat(1.0e6f) == 0x7c00, "Out of range should become infinity");
+
+            juce::Random rng(3);
+            float values[1000];
+            std::uint16_t halves[1000];
+            float decoded[1000];
+            for (auto& v : values)
+                v = (rng.nextFloat() * 2.0f - 1.0f) * std::pow(10.0f, -4.0f * rng.nextFloat());
+
+            DSP::Float16::fromFloat(values, halves, 1000);
+            DSP::Float16::toFloat(halves, decoded, 1000);
+
+            // Below 2^-14 the step is fixed at 2^-24
+            bool withinStep = true, matchesScalar = true;
+            for (int i = 0; i < 1000; ++i)
+            {
+                const float bound = juce::jmax(std::abs(values[i]) / 2048.0f, 1.0f / 33554432.0f);
+                withinStep = withinStep && std::abs(decoded[i] - values[i]) <= bound;
+                matchesScalar = matchesScalar && halves[i] == DSP::Float16::fromFloat(values[i]);
+            }
+
+            expect(withinStep, "Error should stay within half a step");
+            expect(matchesScalar, "Block and scalar conversion should agree");
+
+            // The bank reads what a DelayLine reads, to half precision. Smooth input, since the two
+            // rings differ in length and with it the float rounding of the read positions
+            constexpr double sampleRate = 48000.0;
+            DSP::Float16DelayBank<8> bank;
+            bank.prepare(sampleRate, 200.0);
+            std::array<DSP::DelayLine, 8> lines;
+            for (auto& l : lines)
+                l.prepare(sampleRate, 200.0);
+
+            expect(bank.getMemorySize() * 10 < (size_t)8 * lines[0].getMemorySize() * 6,
+                   "Half-float lines should need little more than half the memory");
+
+            float maxError = 0.0f;
+            for (int n = 0; n < 20000; ++n)
+            {
+                float delayMs[8], expected[8], actual[8], in[8];
+                for (int i = 0; i < 8; ++i)
+                {
+                    delayMs[i] = 20.0f + 10.0f * (float)i + 3.0f * std::sin(0.001f * (float)(n + 300 * i));
+                    expected[i] = lines[(size_t)i].read(delayMs[i]);
+                    in[i] = std::sin(0.01f * (float)n + (float)i);
+                    lines[(size_t)i].push(in[i]);
+                }
+
+                bank.read(delayMs, actual);
+                bank.push(in);
+
+                for (int i = 0; i < 8; ++i)
+                    maxError = juce::jmax(maxError, std::abs(actual[i] - expected[i]));
+            }
+
+            expectLessThan(maxError, 1.0f / 2048.0f);
+        }
+
+        beginTest("Delay Arena");
+        {
+            constexpr double sampleRate = 48000.0;
+            const float maxDelayMs[4] = { 29.1f, 97.1f, 44.9f, 61.3f };
+
+            DSP::DelayArena<4> arena;
+            arena.prepare(sampleRate, maxDelayMs);
+            std::array<DSP::DelayLine, 4> lines;
+            for (int i = 0; i < 4; ++i)
+                lines[(size_t)i].prepare(sampleRate, maxDelayMs[i]);
+
+            expect(arena.getMemorySize() * 10 < (size_t)4 * lines[1].getMemorySize() * 7,
+                   "Lines sized one by one should need well under four of the longest");
+
+            // Interpolated reads over the whole range (below a sample the two would interpolate
+            // towards their oldest slots, which differ), then line 2 standing still for a while
+            float maxError = 0.0f;
+            bool wholeMatch = true;
+            DSP::DelayArena<4> snapshot;
+
+            for (int n = 0; n < 20000; ++n)
+            {
+                if (n == 12000)
+                    snapshot = arena;
+
+                float delayMs[4], expected[4], actual[4], in[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    delayMs[i] = 1.0f + (maxDelayMs[i] - 1.0f) * (0.5f + 0.5f * std::sin(0.0007f * (float)(n + 300 * i)));
+                    expected[i] = lines[(size_t)i].read(delayMs[i]);
+                    in[i] = std::sin(0.01f * (float)n + (float)i);
+                }
+
+                arena.read(delayMs, actual);
+
+                if (n < 15000)
+                {
+                    for (int i = 0; i < 4; ++i)
+                        lines[(size_t)i].push(in[i]);
+                    arena.push(in);
+                }
+                else
+                {
+                    for (int i : { 0, 1, 3 })
+                    {
+                        lines[(size_t)i].push(in[i]);
+                        arena.pushLine(i, in[i]);
+                    }
+                }
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    maxError = juce::jmax(maxError, std::abs(actual[i] - expected[i]));
+                    const int d = 1 + (n * 7 + i) % (48 * (int)maxDelayMs[i] - 1);
+                    wholeMatch = wholeMatch && arena.readWhole(i, d) == lines[(size_t)i].readWhole(d);
+                }
+            }
+
+            expectLessThan(maxError, 1.0e-4f);
+            expect(wholeMatch, "Whole-sample reads should match DelayLine exactly");
+
+            // A copy carries on exactly as the original did from that point
+            float delayMs[4] = { 10.0f, 20.0f, 30.0f, 40.0f }, a[4], b[4];
+            for (int n = 0; n < 3000; ++n)
+                snapshot.push(delayMs);
+            snapshot.read(delayMs, a);
+            for (int n = 0; n < 3000; ++n)
+                arena.push(delayMs);
+            arena.read(delayMs, b);
+            expect(std::equal(a, a + 4, b), "A copy should hold the same lines");
+        }
     }
 };
 
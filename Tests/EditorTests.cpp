@@ -0,0 +1,139 @@
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/PluginEditor.h"
+
+class EditorTests : public juce::UnitTest
+{
+public:
+    EditorTests() : juce::UnitTest("Editor Rendering Tests") {}
+
+    void runTest() override
+    {
+        beginTest("Cached layers are only rebuilt on resize or scale change");
+        {
+            AntigravReverbAudioProcessor processor;
+            std::vector<std::unique_ptr<AntigravReverbAudioProcessorEditor>> editors;
+            
+            // Several open instances share one scheduler
+            for (int i = 0; i < 4; ++i)
+                editors.push_back(std::make_unique<AntigravReverbAudioProcessorEditor>(processor));
+            
+            juce::SharedResourcePointer<UI::RepaintScheduler> scheduler;
+            expectEquals(scheduler->getNumAttachedEditors(), 4);
+            
+            auto& editor = *editors.front();
+            auto* lnf = dynamic_cast<UI::DarkLookAndFeel*>(&editor.getLookAndFeel());
+            expect(lnf != nullptr);
+            
+            // One look (and one knob cache) for all of them, none installed as the global default
+            expect(&editors.back()->getLookAndFeel() == lnf);
+            expect(dynamic_cast<UI::DarkLookAndFeel*>(&juce::LookAndFeel::getDefaultLookAndFeel()) == nullptr);
+            
+            for (int frame = 0; frame < 5; ++frame)
+                editor.createComponentSnapshot(editor.getLocalBounds(), true, 1.0f);
+            
+            expectEquals((int)editor.getRenderStats().frames, 5);
+            expectEquals(editor.getRenderStats().cacheRebuilds, 1);
+            
+            const int knobBodies = lnf->getNumCachedKnobBodies();
+            expect(knobBodies > 0, "Knob bodies should be cached");
+            
+            // Value changes repaint the arcs only
+            editor.createComponentSnapshot(editor.getLocalBounds(), true, 1.0f);
+            expectEquals(lnf->getNumCachedKnobBodies(), knobBodies);
+            
+            // New size and new display scale each rebuild the background once
+            editor.setSize(900, 560);
+            editor.createComponentSnapshot(editor.getLocalBounds(), true, 1.0f);
+            editor.createComponentSnapshot(editor.getLocalBounds(), true, 2.0f);
+            editor.createComponentSnapshot(editor.getLocalBounds(), true, 2.0f);
+            expectEquals(editor.getRenderStats().cacheRebuilds, 3);
+            expect(editor.getRenderStats().getAverageMs() > 0.0);
+            
+            editors.clear();
+            expectEquals(scheduler->getNumAttachedEditors(), 0);
+        }
+        
+        beginTest("Spectrum analyser thread");
+        {
+            DSP::AnalysisFifo fifo;
+            fifo.setSampleRate(48000.0);
+            expect(! fifo.isActive(), "Nothing is copied without a reader");
+            
+            {
+                Analysis::SpectrumAnalyser analyser(fifo);
+                expect(fifo.isActive());
+                expect(analyser.isRunning());
+                
+                // A second editor of the same processor must not become a second reader
+                {
+                    Analysis::SpectrumAnalyser second(fifo);
+                    expect(! second.isRunning());
+                }
+                expect(fifo.isActive());
+                
+                // 1 kHz at -6 dBFS, pushed the way the audio thread does
+                constexpr int numBlocks = 128;
+                float block[128];
+                int phase = 0;
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (auto& x : block)
+                        x = 0.5f * std::sin(juce::MathConstants<float>::twoPi * 1000.0f * (float)phase++ / 48000.0f);
+                    expectEquals(fifo.push(block, block, 128), 128);
+                }
+                
+                // Wait for the frame of the last full hop
+                const auto* frame = (const Analysis::SpectrumFrame*)nullptr;
+                const juce::uint32 expected = numBlocks * 128 / Analysis::SpectrumAnalyser::hopSize;
+                for (int attempt = 0; attempt < 400 && (frame == nullptr || frame->serial < expected); ++attempt)
+                {
+                    if (auto* f = analyser.acquireFrame())
+                        frame = f;
+                    else
+                        juce::Thread::sleep(5);
+                }
+                
+                expect(frame != nullptr && frame->serial == expected, "All hops should be analysed");
+                
+                if (frame != nullptr)
+                {
+                    auto peak = std::max_element(frame->magnitudeDb.begin(), frame->magnitudeDb.end()) - frame->magnitudeDb.begin();
+                    double binHz = 48000.0 / Analysis::SpectrumFrame::fftSize;
+                    expectWithinAbsoluteError((double)peak * binHz, 1000.0, binHz);
+                    expectWithinAbsoluteError(frame->magnitudeDb[(size_t)peak], -6.0f, 1.5f);
+                    expectWithinAbsoluteError(frame->levelDb.back(), -9.03f, 0.1f);
+                }
+            }
+            
+            expect(! fifo.isActive(), "Closing the analyser stops the copies");
+        }
+        
+        beginTest("Repaint requests are coalesced per frame");
+        {
+            juce::SharedResourcePointer<UI::RepaintScheduler> scheduler;
+            juce::Component a, b;
+            
+            scheduler->requestRepaint(a);
+            scheduler->requestRepaint(a);
+            scheduler->requestRepaint(b);
+            expectEquals(scheduler->getNumPendingRepaints(), 2);
+            
+            scheduler->onVBlank(1.0);
+            expectEquals(scheduler->getNumPendingRepaints(), 0);
+            
+            // The same refresh reported by a second window does not serve new requests early
+            scheduler->requestRepaint(a);
+            scheduler->onVBlank(1.0005);
+            expectEquals(scheduler->getNumPendingRepaints(), 1);
+            scheduler->onVBlank(1.0167);
+            expectEquals(scheduler->getNumPendingRepaints(), 0);
+            
+            scheduler->requestRepaint(b);
+            scheduler->cancel(b);
+            expectEquals(scheduler->getNumPendingRepaints(), 0);
+        }
+    }
+};
+
+static EditorTests editorTests;
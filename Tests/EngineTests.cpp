@@ -1,6 +1,13 @@
 #include <JuceHeader.h>
 #include "../Source/DSP/EarlyReflections.h"
+#include "../Source/DSP/VelvetEarlyReflections.h"
+#include "../Source/DSP/RoomModel.h"
 #include "../Source/DSP/LateReverb.h"
+#include "../Source/DSP/CrossfadingEngine.h"
+#include "../Source/DSP/BlockAdapter.h"
+#include "../Source/DSP/BatchedLateReverb.h"
+#include "../Source/DSP/AutomationScheduler.h"
+#include "../Source/DSP/ParallelRenderer.h"
 
 class EngineTests : public juce::UnitTest
 {
@@ -32,6 +39,214 @@ public:
             expect(valid, "Early Reflections produced valid output (no NaN/Inf)");
         }
         
+        beginTest("Early Reflections Modulation");
+        {
+            // Impulse response of the early field, unmodulated and at full motion
+            auto render = [](float depth, int numBlocks)
+            {
+                DSP::EarlyReflections er;
+                er.prepare(48000.0);
+                er.setParameters(100.0f, 0.0f, 0.0f);
+                er.setModulation(5.0f, depth);
+                
+                juce::AudioBuffer<float> out(2, 64 * numBlocks), block(2, 64);
+                out.clear();
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    block.clear();
+                    if (b == 0)
+                        block.setSample(0, 0, 1.0f);
+                    er.processBlock(block);
+                    out.copyFrom(0, b * 64, block, 0, 0, 64);
+                    out.copyFrom(1, b * 64, block, 1, 0, 64);
+                }
+                return out;
+            };
+            
+            auto still = render(0.0f, 120);
+            auto moving = render(1.0f, 120);
+            
+            // Zero diffusion gain leaves the diffusers as plain delays (206.4 + 340.8 + 657.6 samples), then
+            // the first left tap (0.11 x 100 ms = 528 samples) passes the impulse at its gain
+            int first = -1;
+            float firstTap = 0.0f;
+            for (int i = 0; i < 2048; ++i)
+            {
+                if (first < 0 && still.getSample(0, i) != 0.0f)
+                    first = i;
+                firstTap += still.getSample(0, i);
+            }
+            expectEquals(first, 1731);
+            expectWithinAbsoluteError(firstTap, 0.6f, 1.0e-4f);
+            
+            // Motion spreads the taps but keeps their energy, and the outputs stay distinct
+            double stillEnergy = 0.0, movingEnergy = 0.0, difference = 0.0;
+            bool valid = true;
+            for (int i = 0; i < still.getNumSamples(); ++i)
+            {
+                float a = still.getSample(0, i), b = moving.getSample(0, i);
+                valid = valid && std::isfinite(b);
+                stillEnergy += a * a;
+                movingEnergy += b * b;
+                difference += (a - b) * (a - b);
+            }
+            
+            expect(valid);
+            expectWithinAbsoluteError(movingEnergy / stillEnergy, 1.0, 0.1);
+            expect(difference > 0.01 * stillEnergy, "Modulation should move the taps");
+        }
+        
+        beginTest("Velvet Early Reflections");
+        {
+            auto impulseResponse = [](auto& er, int numSamples)
+            {
+                juce::AudioBuffer<float> out(2, numSamples), block(2, 512);
+                for (int start = 0; start < numSamples; start += 512)
+                {
+                    block.clear();
+                    if (start == 0)
+                    {
+                        block.setSample(0, 0, 1.0f);
+                        block.setSample(1, 0, 1.0f);
+                    }
+                    er.processBlock(block);
+                    out.copyFrom(0, start, block, 0, 0, 512);
+                    out.copyFrom(1, start, block, 1, 0, 512);
+                }
+                return out;
+            };
+            
+            auto stats = [](const juce::AudioBuffer<float>& ir, int& count, int& last, double& energy)
+            {
+                count = 0; last = -1; energy = 0.0;
+                for (int i = 0; i < ir.getNumSamples(); ++i)
+                {
+                    float x = ir.getSample(0, i);
+                    if (x != 0.0f) { ++count; last = i; }
+                    energy += x * x;
+                }
+            };
+            
+            DSP::EarlyReflections allpass;
+            allpass.prepare(48000.0);
+            allpass.setParameters(300.0f, 0.1f, 1.0f);
+            
+            DSP::VelvetEarlyReflections velvet;
+            velvet.setParameters(300.0f, 0.1f, 1500.0f);
+            velvet.prepare(48000.0);
+            
+            int count = 0, last = 0, allpassCount = 0, allpassLast = 0;
+            double energy = 0.0, allpassEnergy = 0.0;
+            stats(impulseResponse(velvet, 24576), count, last, energy);
+            stats(impulseResponse(allpass, 24576), allpassCount, allpassLast, allpassEnergy);
+            
+            // 1500 reflections a second over 300 ms, all inside the window, at about the level of the allpass field
+            expect(count >= 400, "Expected hundreds of reflections, got " + juce::String(count));
+            expect(last <= 300 * 48 + 1);
+            expect(energy > 0.5 * allpassEnergy && energy < 2.0 * allpassEnergy,
+                   "Energy ratio " + juce::String(energy / allpassEnergy));
+            
+            // A new size is generated by the worker and picked up between blocks
+            velvet.setParameters(100.0f, 0.1f, 1500.0f);
+            juce::AudioBuffer<float> silence(2, 512);
+            for (int attempt = 0; attempt < 400 && velvet.getTable().sizeMs != 100.0f; ++attempt)
+            {
+                juce::Thread::sleep(5);
+                silence.clear();
+                velvet.processBlock(silence);
+            }
+            expectEquals(velvet.getTable().sizeMs, 100.0f);
+            
+            velvet.reset();
+            stats(impulseResponse(velvet, 24576), count, last, energy);
+            expect(last <= 100 * 48 + 1 && count >= 120);
+        }
+        
+        beginTest("Image-Source Room Model");
+        {
+            DSP::RoomGeometry room;
+            auto table = DSP::RoomTapTable::compute(room);
+            
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                expectEquals(table.numTaps[(size_t)ch], (int)DSP::RoomTapTable::maxTaps);
+                for (int t = 1; t < table.numTaps[(size_t)ch]; ++t)
+                    expect(table.taps[(size_t)ch][(size_t)t].delayMs >= table.taps[(size_t)ch][(size_t)t - 1].delayMs);
+            }
+            
+            // The first reflection is the floor bounce: source at 1.5 m, ears at 1.2 m
+            const float sx = room.sourceX * room.widthM, sy = room.sourceY * room.depthM;
+            const float lx = room.listenerX * room.widthM, ly = room.listenerY * room.depthM;
+            const float direct = std::hypot(lx - 0.09f - sx, ly - sy, 1.2f - 1.5f); // Left ear, nearer the source
+            const float floorBounce = std::hypot(lx + 0.09f - sx, ly - sy, 1.2f + 1.5f);
+            expectWithinAbsoluteError(table.taps[1][0].delayMs, (floorBounce - direct) / 343.0f * 1000.0f, 0.05f);
+            
+            // More absorption, faster fall-off from the first reflection to the last
+            auto damped = room;
+            damped.absorption = 0.8f;
+            auto dampedTable = DSP::RoomTapTable::compute(damped);
+            auto fallOff = [](const DSP::RoomTapTable& t)
+            {
+                float latest = 0.0f, strongest = 0.0f;
+                for (int i = 0; i < t.numTaps[0]; ++i)
+                {
+                    strongest = juce::jmax(strongest, t.taps[0][(size_t)i].gain);
+                    latest = t.taps[0][(size_t)i].gain;
+                }
+                return latest / strongest;
+            };
+            expect(fallOff(dampedTable) < fallOff(table));
+            
+            // Cached by hash: the same geometry is never computed twice
+            juce::SharedResourcePointer<DSP::RoomModelWorker> worker;
+            auto first = worker->getTable(room);
+            const int computed = worker->getNumComputed();
+            expect(worker->getTable(room) == first);
+            expectEquals(worker->getNumComputed(), computed);
+            
+            // The audio side posts a geometry and picks the table up from the worker
+            DSP::RoomTapSource source;
+            source.prepare(room);
+            expect(source.acquire() == first.get());
+            
+            source.setGeometry(damped);
+            for (int attempt = 0; attempt < 400 && source.acquire()->hash != damped.getHash(); ++attempt)
+                juce::Thread::sleep(5);
+            expect(source.acquire()->hash == damped.getHash());
+            
+            // Room taps replace the ratio taps at about the same level
+            auto impulseEnergy = [](DSP::EarlyReflections& er)
+            {
+                double energy = 0.0;
+                juce::AudioBuffer<float> block(2, 512);
+                for (int b = 0; b < 48; ++b)
+                {
+                    block.clear();
+                    if (b == 0)
+                    {
+                        block.setSample(0, 0, 1.0f);
+                        block.setSample(1, 0, 1.0f);
+                    }
+                    er.processBlock(block);
+                    for (int i = 0; i < 512; ++i)
+                        energy += block.getSample(0, i) * block.getSample(0, i);
+                }
+                return energy;
+            };
+            
+            DSP::EarlyReflections ratios, geometric;
+            for (auto* er : { &ratios, &geometric })
+            {
+                er->prepare(48000.0);
+                er->setParameters(300.0f, 0.1f, 1.0f);
+            }
+            geometric.setRoomTaps(&table);
+            
+            const double ratioEnergy = impulseEnergy(ratios), roomEnergy = impulseEnergy(geometric);
+            expect(roomEnergy > 0.5 * ratioEnergy && roomEnergy < 2.0 * ratioEnergy,
+                   "Energy ratio " + juce::String(roomEnergy / ratioEnergy));
+        }
+        
         beginTest("Late Reverb Processing");
         {
             DSP::LateReverb lr;
@@ -62,6 +277,868 @@ public:
             float maxVal = buffer.getMagnitude(0, 512);
             expect(maxVal > 0.0f, "Reverb tail should be present");
         }
+        
+        beginTest("Late Reverb Freeze");
+        for (float modDepth : { 0.0f, 1.0f })
+        {
+            // With modulation too: a moving (interpolated) read would dull the held tail on every trip
+            DSP::LateReverb lr;
+            lr.prepare(44100.0);
+            lr.setParameters(1.0f, modDepth, 0.5f, 6000.0f, 50.0f);
+            
+            juce::AudioBuffer<float> buffer(2, 512);
+            float highEnergy = 0.0f;
+            auto blockEnergy = [&](bool withInput)
+            {
+                buffer.clear();
+                if (withInput)
+                    for (int i = 0; i < 64; ++i)
+                        buffer.setSample(0, i, 1.0f);
+                
+                lr.processBlock(buffer);
+                float e = 0.0f;
+                for (int i = 0; i < 512; ++i)
+                    e += buffer.getSample(0, i) * buffer.getSample(0, i) + buffer.getSample(1, i) * buffer.getSample(1, i);
+                
+                // Energy of the first difference, weighted towards the top of the spectrum
+                for (int i = 1; i < 512; ++i)
+                    highEnergy += juce::square(buffer.getSample(0, i) - buffer.getSample(0, i - 1));
+                return e;
+            };
+            
+            blockEnergy(true);
+            for (int b = 0; b < 20; ++b) blockEnergy(false);
+            
+            // Frozen: no more input, no more decay
+            lr.setFreeze(true);
+            float before = 0.0f, after = 0.0f;
+            highEnergy = 0.0f;
+            for (int b = 0; b < 20; ++b) before += blockEnergy(b == 0);
+            const float highBefore = highEnergy;
+            for (int b = 0; b < 400; ++b) blockEnergy(false);
+            highEnergy = 0.0f;
+            for (int b = 0; b < 20; ++b) after += blockEnergy(false);
+            
+            expect(before > 0.0f, "Tank should hold a tail");
+            expectWithinAbsoluteError(after / before, 1.0f, 0.1f);
+            expectWithinAbsoluteError(highEnergy / highBefore, 1.0f, 0.1f, "Frozen tail should keep its top end");
+        }
+        
+        beginTest("Late Reverb Float16 Storage");
+        {
+            // Same tank in both formats: the half-float tail tracks the float one
+            DSP::LateReverb reference, compact;
+            compact.setDelayStorage(DSP::DelayStorage::float16);
+
+            for (auto* lr : { &reference, &compact })
+            {
+                lr->prepare(48000.0);
+                lr->setParameters(2.0f, 0.5f, 0.5f, 8000.0f, 50.0f);
+            }
+
+            expect(compact.getDelayStorage() == DSP::DelayStorage::float16);
+            expect(compact.getMemorySize() < reference.getMemorySize());
+
+            juce::AudioBuffer<float> a(2, 512), b(2, 512);
+            double signal = 0.0, error = 0.0;
+            for (int block = 0; block < 200; ++block)
+            {
+                a.clear();
+                if (block == 0)
+                    a.setSample(0, 0, 1.0f);
+                b.makeCopyOf(a);
+
+                reference.processBlock(a);
+                compact.processBlock(b);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < 512; ++i)
+                    {
+                        const double d = a.getSample(ch, i) - b.getSample(ch, i);
+                        signal += (double)a.getSample(ch, i) * a.getSample(ch, i);
+                        error += d * d;
+                    }
+            }
+
+            const double errorDb = 10.0 * std::log10(error / signal);
+            logMessage("  float16 vs float32 tail error: " + juce::String(errorDb, 1) + " dB");
+            expect(signal > 0.0);
+            expectLessThan(errorDb, -50.0);
+        }
+
+        beginTest("CPU Dispatch");
+        {
+            expect(DSP::CpuDispatch::fromName(" AVX2 ") == DSP::Isa::avx2);
+            expect(DSP::CpuDispatch::fromName("avx512") == DSP::Isa::avx512);
+            expect(DSP::CpuDispatch::fromName("sse2") == DSP::Isa::baseline);
+            expect(DSP::CpuDispatch::fromName("neon") == DSP::Isa::baseline);
+
+            const auto best = DSP::CpuDispatch::getBestSupported();
+            expect(DSP::CpuDispatch::select("") == best);
+            expect(DSP::CpuDispatch::select("sse2") == DSP::Isa::baseline);
+            expect(DSP::CpuDispatch::isSupported(DSP::CpuDispatch::select("avx512")), "Unsupported requests fall back");
+
+            // Every variant this CPU runs renders the same tank, up to FMA rounding
+            for (auto storage : { DSP::DelayStorage::float32, DSP::DelayStorage::float16 })
+            {
+                std::vector<std::vector<float>> outputs;
+
+                for (auto isa : { DSP::Isa::baseline, DSP::Isa::avx2, DSP::Isa::avx512 })
+                {
+                    if (! DSP::CpuDispatch::isSupported(isa))
+                        continue;
+
+                    DSP::LateReverb lr;
+                    lr.setDelayStorage(storage);
+                    lr.setIsa(isa);
+                    lr.prepare(48000.0);
+                    lr.setParameters(2.0f, 0.5f, 0.5f, 8000.0f, 50.0f);
+                    lr.setDecayShape(1.5f, 0.5f, 250.0f, 4000.0f);
+
+                    std::vector<float> out;
+                    juce::AudioBuffer<float> buffer(2, 512);
+                    for (int block = 0; block < 40; ++block)
+                    {
+                        buffer.clear();
+                        if (block == 0)
+                            buffer.setSample(0, 0, 1.0f);
+
+                        lr.processBlock(buffer);
+                        out.insert(out.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + 512);
+                    }
+
+                    outputs.push_back(std::move(out));
+                }
+
+                float maxDiff = 0.0f, peak = 0.0f;
+                for (size_t v = 1; v < outputs.size(); ++v)
+                    for (size_t i = 0; i < outputs[0].size(); ++i)
+                    {
+                        maxDiff = juce::jmax(maxDiff, std::abs(outputs[v][i] - outputs[0][i]));
+                        peak = juce::jmax(peak, std::abs(outputs[0][i]));
+                    }
+
+                expectLessThan(maxDiff, peak * 1.0e-4f);
+            }
+        }
+
+        beginTest("Adaptive Tank Detail");
+        {
+            // A burst into a 2 s tank, then silence: the adaptive tank steps down one detail at a
+            // time, its tail tracks the full-detail one, and the next input brings full detail back
+            DSP::LateReverb full, adaptive;
+            adaptive.setAdaptiveDetail(true);
+            for (auto* tank : { &full, &adaptive })
+            {
+                tank->prepare(48000.0);
+                tank->setParameters(2.0f, 0.5f, 0.5f, 8000.0f, 50.0f);
+            }
+
+            juce::Random rng(5);
+            juce::AudioBuffer<float> a(2, 480), f(2, 480);
+            std::vector<DSP::TankDetail> details;
+            double energyA = 0.0, energyF = 0.0;
+            float worstDb = 0.0f;
+
+            for (int block = 1; block <= 1000; ++block)
+            {
+                a.clear();
+                if (block <= 20)
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < 480; ++i)
+                            a.setSample(ch, i, rng.nextFloat() - 0.5f);
+
+                f.makeCopyOf(a);
+                full.processBlock(f);
+                adaptive.processBlock(a);
+
+                if (details.empty() || details.back() != adaptive.getDetail())
+                    details.push_back(adaptive.getDetail());
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < 480; ++i)
+                    {
+                        energyA += a.getSample(ch, i) * a.getSample(ch, i);
+                        energyF += f.getSample(ch, i) * f.getSample(ch, i);
+                    }
+
+                // Envelopes in 100 ms windows, down to -120 dB
+                if (block % 10 == 0)
+                {
+                    if (energyF > 9600.0 * 1.0e-12)
+                        worstDb = juce::jmax(worstDb, std::abs((float)(10.0 * std::log10(energyA / energyF))));
+                    energyA = energyF = 0.0;
+                }
+            }
+
+            expect(details == std::vector<DSP::TankDetail> { DSP::TankDetail::full, DSP::TankDetail::held, DSP::TankDetail::folded });
+            logMessage("  adaptive vs full tail envelope: within " + juce::String(worstDb, 2) + " dB");
+            expectLessThan(worstDb, 3.0f);
+
+            // A new burst renders as at full detail, up to the rounding of the skipped LFOs: they
+            // kept time while held, and what is left of the old tails is 250 dB down
+            float maxDiff = 0.0f, peak = 0.0f;
+            for (int block = 1; block <= 40; ++block)
+            {
+                a.clear();
+                if (block <= 10)
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < 480; ++i)
+                            a.setSample(ch, i, rng.nextFloat() - 0.5f);
+
+                f.makeCopyOf(a);
+                full.processBlock(f);
+                adaptive.processBlock(a);
+                expect(adaptive.getDetail() == DSP::TankDetail::full);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < 480; ++i)
+                    {
+                        maxDiff = juce::jmax(maxDiff, std::abs(a.getSample(ch, i) - f.getSample(ch, i)));
+                        peak = juce::jmax(peak, std::abs(f.getSample(ch, i)));
+                    }
+            }
+
+            expectLessThan(maxDiff, peak * 1.0e-3f);
+        }
+
+        beginTest("Adaptive Tank Detail Transitions");
+        {
+            // The same burst at two levels 30 dB apart steps down at the same time. Neither the
+            // hold nor the release (a faint input while held) switches the reads at once: in the
+            // first ms the tank departs from the one it was identical to so far by a fraction only.
+            // Against an undisturbed twin, the faint input itself cannot be heard that soon.
+            int heldAt[2] = {}, releasedAt[2] = {};
+            float worstOnset[2] = {}; // hold, release
+
+            for (int run = 0; run < 2; ++run)
+            {
+                const float level = run == 0 ? 1.0f : 1.0f / 32.0f;
+                DSP::LateReverb full, adaptive, twin;
+                adaptive.setAdaptiveDetail(true);
+                twin.setAdaptiveDetail(true);
+                for (auto* tank : { &full, &adaptive, &twin })
+                {
+                    tank->prepare(48000.0);
+                    tank->setParameters(2.0f, 0.5f, 0.5f, 8000.0f, 50.0f);
+                }
+
+                juce::Random rng(5);
+                juce::AudioBuffer<float> a(2, 480), f(2, 480), t(2, 480);
+                bool departed[2] = {};
+
+                // Largest difference over the first ms after two outputs part, against the level
+                auto onset = [&](const juce::AudioBuffer<float>& x, const juce::AudioBuffer<float>& reference, int switchIndex)
+                {
+                    bool& hasDeparted = departed[switchIndex];
+                    if (hasDeparted)
+                        return;
+
+                    float early = 0.0f;
+                    for (int i = 0; i < 480; ++i)
+                    {
+                        hasDeparted = hasDeparted || x.getSample(0, i) != reference.getSample(0, i);
+                        if (i < 48)
+                            early = juce::jmax(early, std::abs(x.getSample(0, i) - reference.getSample(0, i)));
+                    }
+
+                    if (hasDeparted)
+                        worstOnset[switchIndex] = juce::jmax(worstOnset[switchIndex], early / reference.getRMSLevel(0, 0, 480));
+                };
+
+                for (int block = 1; block <= 400 && releasedAt[run] == 0; ++block)
+                {
+                    // Noise bursts, then 80 dB down a block long once the tank has held for a while
+                    const bool burst = block <= 20;
+                    const bool faint = heldAt[run] > 0 && block == heldAt[run] + 10;
+
+                    a.clear();
+                    if (burst || faint)
+                        for (int ch = 0; ch < 2; ++ch)
+                            for (int i = 0; i < 480; ++i)
+                                a.setSample(ch, i, (rng.nextFloat() - 0.5f) * level * (burst ? 1.0f : 1.0e-4f));
+
+                    f.makeCopyOf(a);
+                    t.makeCopyOf(a);
+                    if (faint)
+                        t.clear();
+
+                    full.processBlock(f);
+                    adaptive.processBlock(a);
+                    twin.processBlock(t);
+
+                    if (heldAt[run] == 0 && adaptive.getDetail() == DSP::TankDetail::held)
+                        heldAt[run] = block;
+                    if (faint && adaptive.getDetail() == DSP::TankDetail::full)
+                        releasedAt[run] = block;
+
+                    onset(a, f, 0);
+                    onset(a, t, 1);
+                }
+
+                expect(departed[0] && departed[1]);
+            }
+
+            expect(heldAt[0] > 0 && releasedAt[0] > 0);
+            expectEquals(heldAt[1], heldAt[0]);
+            expectEquals(releasedAt[1], releasedAt[0]);
+            // Switched at once, the hold departs by about 0.1 of the RMS and the release (the LFOs
+            // skipped on) by over 2; faded, a tenth of the way in, by far less
+            logMessage("  adaptive detail, largest difference in the first ms: hold " + juce::String(worstOnset[0], 3)
+                       + ", release " + juce::String(worstOnset[1], 3) + " of the RMS");
+            expectLessThan(worstOnset[0], 0.03f);
+            expectLessThan(worstOnset[1], 0.3f);
+        }
+
+        beginTest("Crossfading Engine Transition");
+        {
+            // Two engines, one switching to identical settings mid-tail.
+            // The copied tank must carry on the tail, bounded by the equal-power +3 dB worst case.
+            DSP::CrossfadingEngine reference, switching;
+            reference.prepare(44100.0, 256);
+            switching.prepare(44100.0, 256);
+            
+            juce::AudioBuffer<float> a(2, 256), b(2, 256);
+            float maxRatio = 0.0f;
+            bool valid = true;
+            
+            for (int block = 0; block < 40; ++block)
+            {
+                a.clear(); b.clear();
+                if (block == 0)
+                {
+                    a.setSample(0, 0, 1.0f); a.setSample(1, 0, 1.0f);
+                    b.setSample(0, 0, 1.0f); b.setSample(1, 0, 1.0f);
+                }
+                
+                if (block == 20)
+                {
+                    switching.beginTransition(switching.getSettings(), 20.0f);
+                    expect(switching.isTransitioning());
+                }
+                
+                reference.process(a.getReadPointer(0), a.getReadPointer(1), a.getWritePointer(0), a.getWritePointer(1), 256);
+                switching.process(b.getReadPointer(0), b.getReadPointer(1), b.getWritePointer(0), b.getWritePointer(1), 256);
+                
+                for (int i = 0; i < 256; ++i)
+                {
+                    float r = std::abs(a.getSample(0, i));
+                    float s = std::abs(b.getSample(0, i));
+                    if (! std::isfinite(s)) valid = false;
+                    if (r > 1.0e-4f) maxRatio = juce::jmax(maxRatio, s / r);
+                }
+            }
+            
+            expect(valid, "Crossfade produced valid output");
+            expect(! switching.isTransitioning(), "Transition should have finished");
+            expect(maxRatio < 1.42f, "Equal-power crossfade of identical tanks stays within +3 dB");
+        }
+        
+        beginTest("Transition Requested Mid-Fade");
+        {
+            // A 200 Hz tone keeps the wet signal smooth, so a cut in either tank shows up as a step
+            // far above the tone's own sample-to-sample change
+            constexpr double sampleRate = 48000.0;
+            constexpr int blockSize = 256;
+            DSP::CrossfadingEngine engine;
+            engine.prepare(sampleRate, blockSize);
+
+            auto first = engine.getSettings();
+            first.decayS = 4.0f;
+            first.earlySizeMs = 120.0f;
+            auto second = first;
+            second.decayS = 1.0f;
+            second.earlySizeMs = 400.0f;
+
+            juce::AudioBuffer<float> block(2, blockSize);
+            float lastOut = 0.0f, steadyStep = 0.0f, transitionStep = 0.0f;
+            double phase = 0.0;
+
+            for (int b = 0; b < 120; ++b)
+            {
+                if (b == 60)
+                    engine.beginTransition(first, 50.0f);
+
+                // 50 ms is about nine blocks: the second request lands halfway through the fade
+                if (b == 65)
+                {
+                    expect(engine.isTransitioning());
+                    engine.beginTransition(second, 50.0f);
+                }
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const float x = 0.5f * (float)std::sin(phase);
+                    phase += juce::MathConstants<double>::twoPi * 200.0 / sampleRate;
+                    block.setSample(0, i, x);
+                    block.setSample(1, i, x);
+                }
+
+                engine.process(block.getReadPointer(0), block.getReadPointer(1), block.getWritePointer(0), block.getWritePointer(1), blockSize);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const float step = std::abs(block.getSample(0, i) - lastOut);
+                    lastOut = block.getSample(0, i);
+
+                    if (b >= 40 && b < 60)
+                        steadyStep = juce::jmax(steadyStep, step);
+                    else if (b >= 60)
+                        transitionStep = juce::jmax(transitionStep, step);
+                }
+            }
+
+            logMessage("  largest step, steady " + juce::String(steadyStep) + ", through both fades " + juce::String(transitionStep));
+            expect(! engine.isTransitioning(), "The queued transition should run and finish");
+            expectEquals(engine.getSettings().decayS, 1.0f);
+            expectLessThan(transitionStep, 2.0f * steadyStep, "No discontinuity when a transition is requested mid-fade");
+        }
+        
+        beginTest("Parameter Jump Transition and Smoothing Fallback");
+        {
+            DSP::CrossfadingEngine engine;
+            engine.prepare(48000.0, 256);
+            
+            juce::AudioBuffer<float> buffer(2, 256);
+            auto settings = engine.getSettings();
+            
+            auto run = [&](int numBlocks)
+            {
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    buffer.clear();
+                    engine.setSettings(settings);
+                    engine.process(buffer.getReadPointer(0), buffer.getReadPointer(1),
+                                   buffer.getWritePointer(0), buffer.getWritePointer(1), 256);
+                }
+            };
+            
+            const double settlingBefore = engine.getSettlingSeconds(60.0f);
+            
+            // A big size/decay jump warms up the standby engine and fades it in
+            settings.earlySizeMs = 60.0f;
+            settings.decayS = 4.0f;
+            engine.setSettings(settings);
+            expect(engine.isTransitioning(), "Jump should start a transition");
+            expectEquals(DSP::CrossfadingEngine::getActiveTransitionCount(), 1);
+            expect(engine.getSettlingSeconds(60.0f) > settlingBefore, "The longer tail being faded in should count");
+            
+            run(100);
+            expect(! engine.isTransitioning(), "Transition should finish");
+            expectEquals(DSP::CrossfadingEngine::getActiveTransitionCount(), 0);
+            expectWithinAbsoluteError(engine.getSettings().earlySizeMs, 60.0f, 1.0e-3f);
+            
+            const double settlingAfter = engine.getSettlingSeconds(60.0f);
+            expect(settlingAfter > settlingBefore && std::isfinite(settlingAfter), "Settling time should follow the new decay");
+            
+            // With the cap at zero the same jump is ramped instead
+            DSP::CrossfadingEngine::setMaxConcurrentTransitions(0);
+            settings.earlySizeMs = 300.0f;
+            engine.setSettings(settings);
+            expect(! engine.isTransitioning(), "Cap reached, should smooth instead");
+            expect(engine.getSettings().earlySizeMs < 300.0f, "Smoothing should not jump straight to the target");
+            
+            run(100);
+            expectWithinAbsoluteError(engine.getSettings().earlySizeMs, 300.0f, 1.0e-2f);
+            DSP::CrossfadingEngine::setMaxConcurrentTransitions(8);
+        }
+
+        beginTest("Parameter Jump Keeps the Tail");
+        {
+            // A decay or hi cut jump mid-tail, input silent from the impulse on: the standby starts
+            // from the running tank, so the level carries on through warm-up and fade without a gap
+            constexpr int blockSize = 256;
+            constexpr int window = 2400;   // 50 ms
+
+            for (int jump = 0; jump < 2; ++jump)
+            {
+                DSP::CrossfadingEngine engine;
+                engine.prepare(48000.0, blockSize);
+
+                auto settings = engine.getSettings();
+                settings.decayS = 3.0f;
+                settings.hiCutHz = 12000.0f;
+                engine.resetSettings(settings);
+
+                juce::AudioBuffer<float> out(2, blockSize * 150), block(2, blockSize);
+                const int jumpBlock = 60;
+
+                for (int b = 0; b < 150; ++b)
+                {
+                    if (b == jumpBlock)
+                    {
+                        if (jump == 0) settings.decayS = 6.0f;
+                        else           settings.hiCutHz = 4000.0f;
+                    }
+
+                    engine.setSettings(settings);
+                    if (b == jumpBlock)
+                        expect(engine.isTransitioning(), "Jump should start a transition");
+
+                    block.clear();
+                    if (b == 0)
+                    {
+                        block.setSample(0, 0, 1.0f);
+                        block.setSample(1, 0, 1.0f);
+                    }
+
+                    engine.process(block.getReadPointer(0), block.getReadPointer(1), block.getWritePointer(0), block.getWritePointer(1), blockSize);
+                    out.copyFrom(0, b * blockSize, block, 0, 0, blockSize);
+                    out.copyFrom(1, b * blockSize, block, 1, 0, blockSize);
+                }
+
+                auto levelDb = [&out](int start)
+                {
+                    double energy = 0.0;
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = start; i < start + window; ++i)
+                            energy += out.getSample(ch, i) * out.getSample(ch, i);
+                    return 10.0 * std::log10(energy / (2.0 * window) + 1.0e-30);
+                };
+
+                // Window to window from just before the jump to well past the fade: the old decay
+                // loses about 1 dB per 50 ms, the lower hi cut takes some top end off at once
+                double worstStep = 0.0;
+                for (int start = jumpBlock * blockSize - window; start + 2 * window <= out.getNumSamples(); start += window)
+                    worstStep = juce::jmax(worstStep, levelDb(start) - levelDb(start + window));
+
+                logMessage(juce::String("  ") + (jump == 0 ? "decay" : "hi cut") + " jump, largest level drop per 50 ms: "
+                           + juce::String(worstStep) + " dB");
+                expectLessThan(worstStep, 6.0, "Tail should continue through the jump");
+                expect(! engine.isTransitioning());
+            }
+        }
+        
+        beginTest("Mono and Mono-to-Stereo Paths");
+        {
+            // The same impulse through a stereo engine (dual mono), a mono -> stereo one and a mono
+            // one, with a jump transition halfway so the standby runs the mono paths too
+            constexpr int blockSize = 256, numBlocks = 60;
+            DSP::CrossfadingEngine dual, spread, mono;
+            juce::AudioBuffer<float> outputs[3];
+
+            for (auto* e : { &dual, &spread, &mono })
+                e->prepare(48000.0, blockSize);
+            for (auto& out : outputs)
+                out.setSize(2, blockSize * numBlocks);
+
+            juce::AudioBuffer<float> block(2, blockSize);
+            auto settings = dual.getSettings();
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                if (b == numBlocks / 2)
+                    settings.decayS *= 2.0f;
+
+                for (int e = 0; e < 3; ++e)
+                {
+                    auto& engine = e == 0 ? dual : (e == 1 ? spread : mono);
+                    engine.setSettings(settings);
+
+                    block.clear();
+                    if (b == 0)
+                    {
+                        block.setSample(0, 0, 1.0f);
+                        block.setSample(1, 0, 1.0f);
+                    }
+
+                    auto* l = block.getWritePointer(0);
+                    auto* r = block.getWritePointer(1);
+                    engine.process(l, e == 0 ? r : nullptr, l, e == 2 ? nullptr : r, blockSize);
+
+                    outputs[e].copyFrom(0, b * blockSize, block, 0, 0, blockSize);
+                    outputs[e].copyFrom(1, b * blockSize, block, 1, 0, blockSize);
+                }
+            }
+
+            const int numSamples = blockSize * numBlocks;
+            double energyDual = 0.0, energyL = 0.0, energyR = 0.0, cross = 0.0;
+            float monoDiff = 0.0f;
+            bool valid = true;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float l = outputs[1].getSample(0, i), r = outputs[1].getSample(1, i);
+                valid = valid && std::isfinite(l) && std::isfinite(r);
+                energyDual += outputs[0].getSample(0, i) * outputs[0].getSample(0, i);
+                energyL += l * l;
+                energyR += r * r;
+                cross += l * r;
+                monoDiff = juce::jmax(monoDiff, std::abs(outputs[2].getSample(0, i) - l));
+            }
+
+            expect(valid, "Mono to stereo produced valid output");
+            expect(energyL > 0.0 && energyR > 0.0, "Both ears of a mono source should reverberate");
+            expectLessThan(std::abs(cross) / std::sqrt(energyL * energyR), 0.5, "Ears should be decorrelated");
+            expectWithinAbsoluteError(10.0 * std::log10(energyL / energyDual), 0.0, 3.0);
+
+            // Without early send the mono output is the left ear of mono -> stereo, sample for sample
+            expectEquals(monoDiff, 0.0f);
+        }
+
+        beginTest("Parallel Offline Render");
+        {
+            // Bursts of noise with gaps, modulated, through a short hall: the chunked render must
+            // stay within the bound of the serial one at every seam (rounding sits just below it)
+            constexpr double sampleRate = 32000.0;
+            DSP::ReverbSettings settings;
+            settings.decayS = 0.4f;
+            settings.modDepth = 0.5f;
+            settings.mix = 0.5f;
+            settings.earlySend = 0.3f;
+
+            juce::AudioBuffer<float> input(2, (int)(sampleRate * 12.0));
+            input.clear();
+            juce::Random rng(7);
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                if ((i / 8000) % 3 != 2)
+                    for (int ch = 0; ch < 2; ++ch)
+                        input.setSample(ch, i, rng.nextFloat() - 0.5f);
+
+            DSP::ParallelRenderer::Options options;
+            options.numThreads = 4;
+            options.verifySeams = true;
+            DSP::ParallelRenderer renderer(sampleRate, settings, options);
+
+            juce::AudioBuffer<float> serial(2, input.getNumSamples()), parallel(2, input.getNumSamples());
+            renderer.renderSerial(input, serial);
+            const auto result = renderer.render(input, parallel);
+
+            expectGreaterThan(result.numChunks, 1);
+            expect(result.prerollSamples > 0 && result.prerollSamples < input.getNumSamples() / 4);
+
+            float maxDiff = 0.0f, peak = 0.0f;
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                {
+                    maxDiff = juce::jmax(maxDiff, std::abs(parallel.getSample(ch, i) - serial.getSample(ch, i)));
+                    peak = juce::jmax(peak, std::abs(serial.getSample(ch, i)));
+                }
+
+            const float errorDb = juce::Decibels::gainToDecibels(maxDiff / peak, -400.0f);
+            logMessage("  parallel vs serial: " + juce::String(errorDb, 1) + " dB, seams verified at "
+                       + juce::String(result.seamErrorDb, 1) + " dB");
+
+            expectLessThan(errorDb, -options.errorBoundDb);
+            expectLessThan(result.seamErrorDb, -options.errorBoundDb);
+
+            // A frozen tank never forgets, so it is not split
+            settings.freeze = true;
+            DSP::ParallelRenderer frozen(sampleRate, settings, options);
+            expectEquals((int)frozen.getPrerollSamples(), -1);
+            expectEquals(frozen.render(input, parallel).numChunks, 1);
+        }
+
+        beginTest("Block Adapter Latency");
+        {
+            DSP::BlockAdapter adapter;
+            adapter.prepare();
+            adapter.setBlockSize(64);
+            expectEquals(adapter.getLatencySamples(), 64);
+            
+            // Identity render through odd host block sizes: output is the input, exactly 64 samples late
+            int counter = 0, renders = 0;
+            bool exact = true;
+            float left[37], right[37];
+            
+            for (int block = 0; block < 20; ++block)
+            {
+                for (int i = 0; i < 37; ++i)
+                    left[i] = right[i] = (float)(counter + i + 1);
+                
+                adapter.process(left, right, 37, [&](float*, float*, int n)
+                {
+                    exact = exact && n == 64;
+                    ++renders;
+                });
+                
+                for (int i = 0; i < 37; ++i)
+                {
+                    float expected = (float)juce::jmax(0, counter + i + 1 - 64);
+                    exact = exact && left[i] == expected && right[i] == expected;
+                }
+                
+                counter += 37;
+            }
+            
+            expect(exact, "Output should be the input delayed by one internal block");
+            expectEquals(renders, (20 * 37) / 64);
+        }
+        
+        beginTest("Batched Late Reverb matches scalar voices");
+        {
+            constexpr int numVoices = 4;
+            constexpr int blockSize = 256;
+            
+            DSP::BatchedLateReverb<numVoices> batch;
+            batch.prepare(48000.0);
+            
+            std::array<DSP::LateReverb, numVoices> scalar;
+            juce::AudioBuffer<float> scalarBuf[numVoices];
+            juce::AudioBuffer<float> batchBuf(2 * numVoices, blockSize);
+            
+            for (int v = 0; v < numVoices; ++v)
+            {
+                // Every voice gets its own decay, modulation and damping; the last depth is out
+                // of range and has to be clamped the same way by both
+                float decay = 0.8f + 1.5f * (float)v;
+                float depth = 0.5f * (float)v;
+                float rate = 0.3f + 0.4f * (float)v;
+                float hiCut = 3000.0f + 2500.0f * (float)v;
+                float loCut = 20.0f + 40.0f * (float)v;
+                
+                scalar[(size_t)v].prepare(48000.0);
+                scalar[(size_t)v].setInputDiffusion(0.0f, 0);
+                scalar[(size_t)v].setParameters(decay, depth, rate, hiCut, loCut);
+                batch.setParameters(v, decay, depth, rate, hiCut, loCut);
+                scalarBuf[v].setSize(2, blockSize);
+            }
+            
+            juce::Random rng(7);
+            float maxError = 0.0f, maxLevel = 0.0f;
+            
+            for (int block = 0; block < 40; ++block)
+            {
+                for (int v = 0; v < numVoices; ++v)
+                {
+                    for (int i = 0; i < blockSize; ++i)
+                    {
+                        // Different noise bursts per voice, then silence to hear the tails
+                        float l = block < 4 ? rng.nextFloat() - 0.5f : 0.0f;
+                        float r = block < 4 ? rng.nextFloat() - 0.5f : 0.0f;
+                        scalarBuf[v].setSample(0, i, l);
+                        scalarBuf[v].setSample(1, i, r);
+                        batchBuf.setSample(2 * v, i, l);
+                        batchBuf.setSample(2 * v + 1, i, r);
+                    }
+                    scalar[(size_t)v].processBlock(scalarBuf[v]);
+                }
+                
+                const float* inL[numVoices]; const float* inR[numVoices];
+                float* outL[numVoices]; float* outR[numVoices];
+                for (int v = 0; v < numVoices; ++v)
+                {
+                    inL[v] = outL[v] = batchBuf.getWritePointer(2 * v);
+                    inR[v] = outR[v] = batchBuf.getWritePointer(2 * v + 1);
+                }
+                batch.process(inL, inR, outL, outR, blockSize);
+                
+                for (int v = 0; v < numVoices; ++v)
+                {
+                    for (int ch = 0; ch < 2; ++ch)
+                    {
+                        for (int i = 0; i < blockSize; ++i)
+                        {
+                            float expected = scalarBuf[v].getSample(ch, i);
+                            maxError = juce::jmax(maxError, std::abs(batchBuf.getSample(2 * v + ch, i) - expected));
+                            maxLevel = juce::jmax(maxLevel, std::abs(expected));
+                        }
+                    }
+                }
+            }
+            
+            expect(maxLevel > 0.01f, "Scalar reference should produce a tail");
+            expectLessThan(maxError, 1.0e-3f * maxLevel);
+        }
+        
+        beginTest("Re-prepare Reuses Delay Memory");
+        {
+            DSP::ReverbSettings settings;
+            settings.decayS = 3.0f;
+            settings.earlySend = 0.5f;
+            settings.modDepth = 0.4f;
+
+            auto renderImpulse = [&settings](DSP::CrossfadingEngine& e, std::vector<float>& out)
+            {
+                e.resetSettings(settings);
+                float l[512], r[512];
+                for (int start = 0; start < (int)out.size(); start += 512)
+                {
+                    std::fill(l, l + 512, 0.0f);
+                    std::fill(r, r + 512, 0.0f);
+                    if (start == 0) l[0] = r[0] = 1.0f;
+                    e.process(l, r, l, r, 512);
+                    std::copy(l, l + 512, out.begin() + start);
+                }
+            };
+
+            DSP::CrossfadingEngine engine;
+            engine.prepare(96000.0, 512);
+
+            // Dirty every line at the high rate first
+            std::vector<float> response(8192);
+            renderImpulse(engine, response);
+
+            const int allocations = DSP::DelayMemory::getNumAllocations();
+            engine.prepare(96000.0, 512);
+            engine.prepare(48000.0, 512);
+            engine.prepare(44100.0, 512);
+            expectEquals(DSP::DelayMemory::getNumAllocations(), allocations, "Equal or lower rates must not allocate");
+
+            // Only the written part is cleared, yet nothing of the old tail may leak into the new run
+            std::vector<float> reused(8192), fresh(8192);
+            renderImpulse(engine, reused);
+
+            DSP::CrossfadingEngine reference;
+            reference.prepare(44100.0, 512);
+            renderImpulse(reference, fresh);
+            expect(reused == fresh, "A re-prepared engine should sound exactly like a new one");
+
+            engine.prepare(192000.0, 512);
+            expect(DSP::DelayMemory::getNumAllocations() > allocations, "A higher rate has to grow the lines");
+        }
+
+        beginTest("Automation Scheduler Sub-blocks");
+        {
+            DSP::AutomationScheduler<2> scheduler;
+            const float initial[2] = { 0.0f, 10.0f };
+            scheduler.reset(initial);
+            scheduler.setRampGranularity(64);
+            
+            struct Segment { int start, length; float a, b; };
+            std::vector<Segment> segments;
+            auto record = [&](const float* v, int start, int n) { segments.push_back({ start, n, v[0], v[1] }); };
+            
+            // Steps split the block exactly at their offsets
+            expect(scheduler.addEvent({ 0, 1.0f, 100, false }));
+            expect(scheduler.addEvent({ 1, 20.0f, 30, false }));
+            scheduler.process(256, record);
+            
+            expectEquals((int)segments.size(), 3);
+            expect(segments[0].start == 0 && segments[0].length == 30 && segments[0].a == 0.0f && segments[0].b == 10.0f);
+            expect(segments[1].start == 30 && segments[1].length == 70 && segments[1].b == 20.0f);
+            expect(segments[2].start == 100 && segments[2].length == 156 && segments[2].a == 1.0f);
+            
+            // A block-rate ramp moves in granularity steps and reaches its target at the block end
+            segments.clear();
+            expect(scheduler.addEvent({ 0, 5.0f, 0, true }));
+            scheduler.process(256, record);
+            
+            expectEquals((int)segments.size(), 4);
+            bool rising = true;
+            for (size_t i = 1; i < segments.size(); ++i)
+                rising = rising && segments[i].a > segments[i - 1].a && segments[i].length == 64;
+            expect(rising, "Ramp should rise once per sub-block");
+            expectWithinAbsoluteError(segments[0].a, 2.0f, 1.0e-5f);
+            expectEquals(segments.back().a, 5.0f);
+            expectEquals(scheduler.getValues()[0], 5.0f);
+            
+            // Without events the block is rendered in one piece
+            segments.clear();
+            scheduler.process(512, record);
+            expectEquals((int)segments.size(), 1);
+            
+            // Queue: FIFO order, push fails instead of blocking when full
+            DSP::ParameterEventQueue<4> queue;
+            for (int i = 0; i < 4; ++i)
+                expect(queue.push({ i, (float)i, 0, false }));
+            expect(! queue.push({ 0, 0.0f, 0, false }), "Full queue should reject");
+            
+            DSP::ParameterEvent e;
+            for (int i = 0; i < 4; ++i)
+                expect(queue.pop(e) && e.index == i);
+            expect(! queue.pop(e));
+        }
     }
 };
 
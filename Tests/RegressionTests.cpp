@@ -0,0 +1,350 @@
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+/**
+ * @brief Golden-file regression of the full processor.
+ *
+ * Renders a fixed set of test signals through AntigravReverbAudioProcessor for every parameter
+ * set and sample rate below, compares the result with the golden files in ANTIGRAV_GOLDEN_DIR
+ * and the processing time with the stored CPU baselines.
+ *
+ * A golden file stores the first exactSamples frames verbatim (compared to an absolute tolerance)
+ * and the RMS of every envelopeBlock frames after that (compared in dB), which keeps the files
+ * small while still covering the whole tail.
+ *
+ * Environment:
+ *   ANTIGRAV_UPDATE_GOLDEN=1   rewrite golden files and CPU baselines from this run
+ *   ANTIGRAV_STRICT_CPU=1      fail (instead of warn) when a case is slower than its baseline
+ * The golden files and baselines are committed under Tests/Golden. A missing one fails the case
+ * (ANTIGRAV_UPDATE_GOLDEN=1 writes it), so a lost file cannot pass as a first run.
+ */
+class RegressionTests : public juce::UnitTest
+{
+public:
+    RegressionTests() : juce::UnitTest("Golden-file Regression", "Regression") {}
+
+    void runTest() override
+    {
+        const bool update = juce::SystemStats::getEnvironmentVariable("ANTIGRAV_UPDATE_GOLDEN", {}).isNotEmpty();
+        const bool strictCpu = juce::SystemStats::getEnvironmentVariable("ANTIGRAV_STRICT_CPU", {}).isNotEmpty();
+
+        goldenDir.createDirectory();
+        auto baselines = loadBaselines();
+        bool baselinesChanged = false;
+
+        for (auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+        {
+            for (auto& paramSet : getParameterSets())
+            {
+                for (auto signal : { Signal::impulse, Signal::sweep, Signal::noiseBurst, Signal::silence })
+                {
+                    auto name = juce::String(getSignalName(signal)) + "_" + paramSet.name + "_" + juce::String((int)sampleRate);
+                    beginTest(name);
+
+                    double nsPerSample = 0.0;
+                    auto output = render(signal, paramSet, sampleRate, nsPerSample);
+
+                    expect(isFinite(output), "Output contains NaN/Inf");
+
+                    if (signal == Signal::silence)
+                        expect(output.getMagnitude(0, output.getNumSamples()) == 0.0f, "Silence in, silence out");
+
+                    auto file = goldenDir.getChildFile(name + ".golden");
+
+                    if (update)
+                    {
+                        writeGolden(file, output);
+                        logMessage("  wrote " + file.getFileName());
+                    }
+                    else if (! file.existsAsFile())
+                    {
+                        expect(false, "Missing golden file " + file.getFileName() + ", rerun with ANTIGRAV_UPDATE_GOLDEN=1");
+                    }
+                    else
+                    {
+                        compareWithGolden(file, output);
+                    }
+
+                    checkCpu(name, nsPerSample, baselines, update, strictCpu, baselinesChanged);
+                }
+            }
+        }
+
+        if (baselinesChanged)
+            saveBaselines(baselines);
+    }
+
+private:
+    enum class Signal { impulse, sweep, noiseBurst, silence };
+
+    struct ParameterSet
+    {
+        const char* name;
+        std::vector<std::pair<juce::String, float>> values; // Unlisted parameters keep their defaults
+    };
+
+    static constexpr int blockSize = 256;
+    static constexpr double renderSeconds = 1.5;
+    static constexpr int exactSamples = 4096;
+    static constexpr int envelopeBlock = 256;
+
+    static constexpr float exactTolerance = 1.0e-4f;
+    static constexpr float envelopeToleranceDb = 0.5f;
+    static constexpr float envelopeFloorDb = -90.0f;
+    static constexpr double cpuTolerance = 1.25;
+
+    static constexpr juce::uint32 goldenMagic = 0x44474741; // "AGGD"
+
+    const juce::File goldenDir { ANTIGRAV_GOLDEN_DIR };
+
+    static const std::vector<ParameterSet>& getParameterSets()
+    {
+        static const std::vector<ParameterSet> sets = {
+            { "default", {} },
+            { "smallbright", { { Params::decay, 0.5f }, { Params::earlySize, 60.0f }, { Params::hiCut, 15000.0f },
+                               { Params::diffusionStages, 2.0f } } },
+            { "largemod",    { { Params::decay, 6.0f }, { Params::predelay, 50.0f }, { Params::modDepth, 60.0f },
+                               { Params::modShape, 1.0f }, { Params::diffusionStages, 8.0f }, { Params::earlySend, 0.5f },
+                               { Params::mix, 50.0f } } },
+        };
+        return sets;
+    }
+
+    static const char* getSignalName(Signal s)
+    {
+        switch (s)
+        {
+            case Signal::impulse:    return "impulse";
+            case Signal::sweep:      return "sweep";
+            case Signal::noiseBurst: return "noise";
+            case Signal::silence:    return "silence";
+        }
+        return "";
+    }
+
+    static void fillSignal(Signal signal, juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        buffer.clear();
+        const int numSamples = buffer.getNumSamples();
+
+        switch (signal)
+        {
+            case Signal::impulse:
+                buffer.setSample(0, 0, 1.0f);
+                buffer.setSample(1, 0, 1.0f);
+                break;
+
+            case Signal::sweep:
+            {
+                // 0.5 s exponential sweep 20 Hz -> 20 kHz at -6 dBFS
+                const int length = (int)(0.5 * sampleRate);
+                const double k = std::log(20000.0 / 20.0);
+                const double duration = 0.5;
+
+                for (int i = 0; i < juce::jmin(length, numSamples); ++i)
+                {
+                    double t = i / sampleRate;
+                    double phase = juce::MathConstants<double>::twoPi * 20.0 * duration / k * (std::exp(t * k / duration) - 1.0);
+                    float v = 0.5f * (float)std::sin(phase);
+                    buffer.setSample(0, i, v);
+                    buffer.setSample(1, i, v);
+                }
+                break;
+            }
+
+            case Signal::noiseBurst:
+            {
+                // 100 ms, independent channels, fixed seed
+                juce::Random rng(0x6e6f6973);
+                for (int i = 0; i < juce::jmin((int)(0.1 * sampleRate), numSamples); ++i)
+                {
+                    buffer.setSample(0, i, 0.5f * (rng.nextFloat() * 2.0f - 1.0f));
+                    buffer.setSample(1, i, 0.5f * (rng.nextFloat() * 2.0f - 1.0f));
+                }
+                break;
+            }
+
+            case Signal::silence:
+                break;
+        }
+    }
+
+    juce::AudioBuffer<float> render(Signal signal, const ParameterSet& paramSet, double sampleRate, double& nsPerSample)
+    {
+        AntigravReverbAudioProcessor processor;
+
+        for (auto& [id, value] : paramSet.values)
+        {
+            auto* param = processor.apvts.getParameter(id);
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+        }
+
+        processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        const int numSamples = (int)(renderSeconds * sampleRate);
+        juce::AudioBuffer<float> output(2, numSamples);
+        fillSignal(signal, output, sampleRate);
+
+        juce::MidiBuffer midi;
+        juce::int64 ticks = 0;
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            const int n = juce::jmin(blockSize, numSamples - start);
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), 2, start, n);
+
+            auto t0 = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+            ticks += juce::Time::getHighResolutionTicks() - t0;
+        }
+
+        processor.releaseResources();
+        nsPerSample = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSamples;
+        return output;
+    }
+
+    static bool isFinite(const juce::AudioBuffer<float>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                if (! std::isfinite(buffer.getSample(ch, i)))
+                    return false;
+        return true;
+    }
+
+    static std::vector<float> envelopeDb(const juce::AudioBuffer<float>& buffer, int channel)
+    {
+        std::vector<float> env;
+        for (int start = exactSamples; start + envelopeBlock <= buffer.getNumSamples(); start += envelopeBlock)
+            env.push_back(juce::Decibels::gainToDecibels(buffer.getRMSLevel(channel, start, envelopeBlock), -200.0f));
+        return env;
+    }
+
+    //==============================================================================
+    // Golden file: magic, version, channels, exact count, envelope count, then exact samples
+    // (channel by channel) and envelope values in dB (channel by channel).
+    void writeGolden(const juce::File& file, const juce::AudioBuffer<float>& output)
+    {
+        juce::MemoryBlock data;
+        juce::MemoryOutputStream out(data, false);
+        const int exact = juce::jmin(exactSamples, output.getNumSamples());
+        const auto numEnvelope = (int)envelopeDb(output, 0).size();
+
+        out.writeInt((int)goldenMagic);
+        out.writeInt(1);
+        out.writeInt(output.getNumChannels());
+        out.writeInt(exact);
+        out.writeInt(numEnvelope);
+
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            for (int i = 0; i < exact; ++i)
+                out.writeFloat(output.getSample(ch, i));
+
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            for (auto v : envelopeDb(output, ch))
+                out.writeFloat(v);
+
+        out.flush();
+        expect(file.replaceWithData(data.getData(), data.getSize()), "Could not write " + file.getFullPathName());
+    }
+
+    void compareWithGolden(const juce::File& file, const juce::AudioBuffer<float>& output)
+    {
+        juce::FileInputStream in(file);
+        bool readable = in.openedOk() && in.readInt() == (int)goldenMagic && in.readInt() == 1;
+        expect(readable, "Unreadable golden file " + file.getFileName());
+
+        if (! readable)
+            return;
+
+        const int numChannels = in.readInt();
+        const int exact = in.readInt();
+        const int numEnvelope = in.readInt();
+
+        bool sameLayout = numChannels == output.getNumChannels()
+                           && exact == juce::jmin(exactSamples, output.getNumSamples())
+                           && numEnvelope == (int)envelopeDb(output, 0).size();
+        expect(sameLayout, "Golden file layout differs, rerun with ANTIGRAV_UPDATE_GOLDEN=1");
+
+        if (! sameLayout)
+            return;
+
+        float maxError = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < exact; ++i)
+                maxError = juce::jmax(maxError, std::abs(in.readFloat() - output.getSample(ch, i)));
+
+        float maxEnvelopeError = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            for (auto v : envelopeDb(output, ch))
+            {
+                float golden = in.readFloat();
+                if (golden > envelopeFloorDb || v > envelopeFloorDb)
+                    maxEnvelopeError = juce::jmax(maxEnvelopeError, std::abs(golden - v));
+            }
+        }
+
+        expect(maxError <= exactTolerance, "Samples differ from golden by " + juce::String(maxError));
+        expect(maxEnvelopeError <= envelopeToleranceDb, "Envelope differs from golden by " + juce::String(maxEnvelopeError) + " dB");
+    }
+
+    //==============================================================================
+    // CPU baselines: one "case ns_per_sample" line per case.
+    juce::File getBaselineFile() const { return goldenDir.getChildFile("cpu_baselines.txt"); }
+
+    juce::StringPairArray loadBaselines() const
+    {
+        juce::StringPairArray baselines;
+        juce::StringArray lines;
+        lines.addLines(getBaselineFile().loadFileAsString());
+
+        for (auto& line : lines)
+        {
+            auto tokens = juce::StringArray::fromTokens(line, false);
+            if (tokens.size() == 2)
+                baselines.set(tokens[0], tokens[1]);
+        }
+        return baselines;
+    }
+
+    void saveBaselines(const juce::StringPairArray& baselines) const
+    {
+        juce::String text;
+        for (auto& key : baselines.getAllKeys())
+            text << key << " " << baselines[key] << juce::newLine;
+        getBaselineFile().replaceWithText(text);
+    }
+
+    void checkCpu(const juce::String& name, double nsPerSample, juce::StringPairArray& baselines,
+                  bool update, bool strict, bool& changed)
+    {
+        if (update)
+        {
+            baselines.set(name, juce::String(nsPerSample, 2));
+            changed = true;
+            return;
+        }
+
+        if (! baselines.containsKey(name))
+        {
+            expect(false, "No CPU baseline for " + name + ", rerun with ANTIGRAV_UPDATE_GOLDEN=1");
+            return;
+        }
+
+        double baseline = baselines[name].getDoubleValue();
+        auto message = name + ": " + juce::String(nsPerSample, 2) + " ns/sample (baseline " + juce::String(baseline, 2) + ")";
+        logMessage("  " + message);
+
+        if (nsPerSample > baseline * cpuTolerance)
+        {
+            if (strict)
+                expect(false, "Slower than baseline, " + message);
+            else
+                logMessage("  WARNING: slower than baseline");
+        }
+    }
+};
+
+static RegressionTests regressionTests;
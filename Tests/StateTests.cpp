@@ -0,0 +1,213 @@
+#include <JuceHeader.h>
+#include "../Source/PresetEngine.h"
+#include "../Source/PluginProcessor.h"
+#include "../Source/DSP/TripleBuffer.h"
+
+class StateTests : public juce::UnitTest
+{
+public:
+    StateTests() : juce::UnitTest("State / Preset Tests") {}
+
+    void runTest() override
+    {
+        beginTest("Binary state round trip");
+        {
+            float values[Params::numParameters];
+            for (int i = 0; i < Params::numParameters; ++i)
+                values[i] = 0.5f + (float)i;
+
+            ProcessorOptions options;
+            options.internalBlockSize = 64;
+            options.longDelaySeconds = 12.5f;
+            options.compactDelays = true;
+            options.adaptiveTank = true;
+
+            juce::MemoryBlock block;
+            StateFormat::writeBinary(values, Params::numParameters, 2, options, block);
+
+            // Header (4 + 2 + 2 + 2), one float per parameter, then the options
+            expectEquals((int)block.getSize(), 10 + 4 * (int)Params::numParameters + 10);
+            expect(StateFormat::isBinary(block.getData(), (int)block.getSize()));
+
+            ParameterSnapshot snapshot;
+            expect(StateFormat::readBinary(block.getData(), (int)block.getSize(), snapshot));
+            expectEquals(snapshot.program, 2);
+            expect(snapshot.hasOptions);
+            expectEquals(snapshot.options.internalBlockSize, 64);
+            expectEquals(snapshot.options.longDelaySeconds, 12.5f);
+            expect(snapshot.options.compactDelays);
+            expect(snapshot.options.adaptiveTank);
+
+            for (int i = 0; i < Params::numParameters; ++i)
+                expectEquals(snapshot.values[(size_t)i], values[i]);
+        }
+
+        beginTest("Binary state from a newer version keeps known parameters");
+        {
+            float values[Params::numParameters + 3];
+            for (int i = 0; i < Params::numParameters + 3; ++i)
+                values[i] = (float)i;
+
+            juce::MemoryBlock block;
+            StateFormat::writeBinary(values, Params::numParameters + 3, 0, {}, block);
+
+            ParameterSnapshot snapshot;
+            expect(StateFormat::readBinary(block.getData(), (int)block.getSize(), snapshot));
+            expectEquals(snapshot.values[Params::earlySendIndex], (float)Params::earlySendIndex);
+        }
+
+        beginTest("Truncated or foreign data is rejected");
+        {
+            float values[Params::numParameters] = {};
+            juce::MemoryBlock block;
+            StateFormat::writeBinary(values, Params::numParameters, 0, {}, block);
+
+            // Cut into the parameter values, not just the trailing options
+            ParameterSnapshot snapshot;
+            expect(! StateFormat::readBinary(block.getData(), (int)block.getSize() - 8, snapshot));
+
+            const char junk[] = "not a state";
+            expect(! StateFormat::isBinary(junk, (int)sizeof(junk)));
+        }
+
+        beginTest("Legacy XML state is still readable");
+        {
+            juce::XmlElement xml("Parameters");
+            auto* p = xml.createNewChildElement("PARAM");
+            p->setAttribute("id", Params::decay);
+            p->setAttribute("value", 4.5);
+
+            juce::MemoryBlock block;
+            juce::AudioProcessor::copyXmlToBinary(xml, block);
+            expect(! StateFormat::isBinary(block.getData(), (int)block.getSize()));
+
+            ParameterSnapshot snapshot;
+            juce::ValueTree tree;
+            expect(StateFormat::readXml(block.getData(), (int)block.getSize(), snapshot, tree));
+            expect(tree.isValid());
+            expectWithinAbsoluteError(snapshot.values[Params::decayIndex], 4.5f, 1.0e-6f);
+        }
+
+        beginTest("Triple buffer hands over the newest value only");
+        {
+            DSP::TripleBuffer<int> tb;
+            expect(tb.acquire() == nullptr);
+
+            tb.getWriteSlot() = 1; tb.publish();
+            tb.getWriteSlot() = 2; tb.publish();
+
+            auto* v = tb.acquire();
+            expect(v != nullptr && *v == 2);
+            expect(tb.acquire() == nullptr);
+
+            tb.getWriteSlot() = 3; tb.publish();
+            v = tb.acquire();
+            expect(v != nullptr && *v == 3);
+        }
+
+        beginTest("Processor: a loaded session is saved before the message thread commits it");
+        {
+            AntigravReverbAudioProcessor source, target;
+            setParameter(source, Params::decay, 4.5f);
+            setParameter(source, Params::hiCut, 3000.0f);
+            source.setInternalBlockSize(64);
+
+            juce::MemoryBlock saved;
+            source.getStateInformation(saved);
+
+            // Straight back out, no message loop in between: the pending session is what is saved
+            target.setStateInformation(saved.getData(), (int)saved.getSize());
+            juce::MemoryBlock again;
+            target.getStateInformation(again);
+
+            ParameterSnapshot snapshot;
+            expect(StateFormat::readBinary(again.getData(), (int)again.getSize(), snapshot));
+            expectWithinAbsoluteError(snapshot.values[Params::decayIndex], 4.5f, 0.01f);
+            expectWithinAbsoluteError(snapshot.values[Params::hiCutIndex], 3000.0f, 0.01f);
+            expectEquals(snapshot.options.internalBlockSize, 64);
+
+            target.waitForPendingStateChanges();
+            expectWithinAbsoluteError(getParameter(target, Params::decay), 4.5f, 0.01f);
+            expectEquals(target.getInternalBlockSize(), 64);
+        }
+
+        beginTest("Processor: program change crossfades and reaches the parameters");
+        {
+            constexpr double sampleRate = 48000.0;
+            constexpr int blockSize = 256;
+
+            AntigravReverbAudioProcessor processor;
+            processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            // A 200 Hz tone: a cut anywhere in the wet signal is a step far above the tone's own
+            juce::AudioBuffer<float> block(2, blockSize);
+            juce::MidiBuffer midi;
+            double phase = 0.0;
+            float lastOut = 0.0f;
+
+            auto run = [&](int numBlocks)
+            {
+                float largestStep = 0.0f;
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (int i = 0; i < blockSize; ++i)
+                    {
+                        const float x = 0.5f * (float)std::sin(phase);
+                        phase += juce::MathConstants<double>::twoPi * 200.0 / sampleRate;
+                        block.setSample(0, i, x);
+                        block.setSample(1, i, x);
+                    }
+
+                    processor.processBlock(block, midi);
+
+                    for (int i = 0; i < blockSize; ++i)
+                    {
+                        largestStep = juce::jmax(largestStep, std::abs(block.getSample(0, i) - lastOut));
+                        lastOut = block.getSample(0, i);
+                    }
+                }
+                return largestStep;
+            };
+
+            run(20);
+            const float steadyStep = run(20);
+
+            // Large Room; the message thread commits it before the audio thread has taken it over
+            processor.setCurrentProgram(2);
+            processor.waitForPendingStateChanges();
+            const float transitionStep = run(40);
+
+            expectLessThan(transitionStep, 2.0f * steadyStep, "Program change should crossfade");
+            expectEquals(processor.getCurrentProgram(), 2);
+            expectWithinAbsoluteError(getParameter(processor, Params::decay), 4.0f, 0.01f);
+            expectWithinAbsoluteError(getParameter(processor, Params::predelay), 30.0f, 0.01f);
+            expectWithinAbsoluteError(getParameter(processor, Params::earlySize), 400.0f, 0.01f);
+            expectWithinAbsoluteError(getParameter(processor, Params::hiCut), 4000.0f, 0.01f);
+
+            // A parameter moved while the program is pending keeps its new value, the rest follow it
+            processor.setCurrentProgram(0);
+            setParameter(processor, Params::decay, 7.0f);
+            processor.waitForPendingStateChanges();
+            run(4);
+
+            expectWithinAbsoluteError(getParameter(processor, Params::decay), 7.0f, 0.01f);
+            expectWithinAbsoluteError(getParameter(processor, Params::predelay), 5.0f, 0.01f);
+            processor.releaseResources();
+        }
+    }
+
+private:
+    static void setParameter(AntigravReverbAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* param = processor.apvts.getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    static float getParameter(const AntigravReverbAudioProcessor& processor, const juce::String& id)
+    {
+        return processor.apvts.getRawParameterValue(id)->load();
+    }
+};
+
+static StateTests stateTests;
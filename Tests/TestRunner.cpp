@@ -2,9 +2,20 @@
 
 int main (int argc, char* argv[])
 {
-    juce::ignoreUnused(argc, argv);
+    // The processor-level tests need a message manager
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
     juce::UnitTestRunner runner;
-    runner.runAllTests();
+
+    // Optional argument: only run one category, e.g. "Regression"
+    if (argc > 1)
+        runner.runTestsInCategory (argv[1]);
+    else
+        runner.runAllTests();
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (runner.getResult (i)->failures > 0)
+            return 1;
 
     return 0;
 }
@@ -0,0 +1,236 @@
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/Analysis/IRAnalysis.h"
+
+/**
+ * Headless preset analysis: renders the impulse response of every factory program and of a sweep of
+ * the density-related parameters through the real processor, and prints per-octave T60 (Schroeder),
+ * echo density, spectral flatness and the measured CPU cost per sample side by side.
+ *
+ *   AntigravReverb_Analysis [--sr 48000] [--density 0.9] [--by 80] [--csv]
+ *
+ * --density / --by pick the cheapest configuration whose echo density reaches the target within
+ * the given number of milliseconds.
+ */
+namespace
+{
+    struct Configuration
+    {
+        juce::String name;
+        int program = -1;                                        // Factory program, or -1
+        std::vector<std::pair<juce::String, float>> values;      // Applied on top
+    };
+
+    struct Result
+    {
+        Configuration config;
+        double nsPerSample = 0.0;
+        double t60 = 0.0;
+        std::array<double, Analysis::octaveCentres.size()> octaveT60 {};
+        double ned50 = 0.0, ned100 = 0.0;
+        double mixingMs = 0.0;                                   // Time to reach the target density
+        double flatness = 0.0;
+    };
+
+    constexpr int blockSize = 256;
+    constexpr double irSeconds = 6.0;
+    constexpr double preRollSeconds = 0.1;
+    constexpr double cpuSeconds = 2.0;
+
+    std::vector<Configuration> makeConfigurations()
+    {
+        std::vector<Configuration> configs;
+
+        for (int p = 0; p < PresetEngine::numPrograms; ++p)
+            configs.push_back({ PresetEngine::getProgramName(p), p, {} });
+
+        // Density / cost trade-offs on top of the medium room
+        for (int stages : { 0, 2, 4, 8 })
+            for (float diffusion : { 0.5f, 0.8f })
+                for (float modDepth : { 0.0f, 50.0f })
+                    configs.push_back({ "medium st" + juce::String(stages) + " ld" + juce::String(diffusion, 1)
+                                            + " mod" + juce::String((int)modDepth),
+                                        1,
+                                        { { Params::diffusionStages, (float)stages },
+                                          { Params::lateDiffusion, diffusion },
+                                          { Params::modDepth, modDepth } } });
+
+        return configs;
+    }
+
+    std::unique_ptr<AntigravReverbAudioProcessor> createProcessor(const Configuration& config, double sampleRate)
+    {
+        auto processor = std::make_unique<AntigravReverbAudioProcessor>();
+
+        if (config.program >= 0)
+        {
+            processor->setCurrentProgram(config.program);
+            processor->waitForPendingStateChanges();
+        }
+
+        auto set = [&](const juce::String& id, float value)
+        {
+            auto* param = processor->apvts.getParameter(id);
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+        };
+
+        for (auto& [id, value] : config.values)
+            set(id, value);
+
+        set(Params::mix, 100.0f); // Wet only
+
+        processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+        return processor;
+    }
+
+    void process(AntigravReverbAudioProcessor& processor, juce::AudioBuffer<float>& buffer)
+    {
+        juce::MidiBuffer midi;
+
+        for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+        {
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, start,
+                                           juce::jmin(blockSize, buffer.getNumSamples() - start));
+            processor.processBlock(block, midi);
+        }
+    }
+
+    Result analyse(const Configuration& config, double sampleRate, double targetDensity)
+    {
+        Result result;
+        result.config = config;
+
+        // Impulse response. The pre-roll lets the program's switch-over crossfade finish on a silent tank.
+        {
+            auto processor = createProcessor(config, sampleRate);
+            const int preRoll = (int)(preRollSeconds * sampleRate);
+            juce::AudioBuffer<float> buffer(2, preRoll + (int)(irSeconds * sampleRate));
+            buffer.clear();
+            buffer.setSample(0, preRoll, 1.0f);
+            buffer.setSample(1, preRoll, 1.0f);
+            process(*processor, buffer);
+
+            std::vector<float> ir(buffer.getReadPointer(0, preRoll), buffer.getReadPointer(0) + buffer.getNumSamples());
+
+            result.t60 = Analysis::t60(ir, sampleRate);
+            result.octaveT60 = Analysis::octaveT60(ir, sampleRate);
+            result.ned50 = Analysis::echoDensityAt(ir, sampleRate, 0.05);
+            result.ned100 = Analysis::echoDensityAt(ir, sampleRate, 0.1);
+            result.mixingMs = Analysis::mixingTimeMs(ir, sampleRate, targetDensity);
+            result.flatness = Analysis::spectralFlatness(ir, sampleRate);
+        }
+
+        // CPU: best of three runs over noise
+        {
+            auto processor = createProcessor(config, sampleRate);
+            juce::AudioBuffer<float> input(2, (int)(cpuSeconds * sampleRate)), buffer;
+            juce::Random rng(1);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                    input.setSample(ch, i, rng.nextFloat() - 0.5f);
+
+            double best = 1.0e30;
+            for (int run = 0; run < 3; ++run)
+            {
+                buffer.makeCopyOf(input, true);
+                auto t0 = juce::Time::getHighResolutionTicks();
+                process(*processor, buffer);
+                best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - t0));
+            }
+
+            result.nsPerSample = best * 1.0e9 / input.getNumSamples();
+        }
+
+        return result;
+    }
+
+    juce::String formatCells(const juce::StringArray& cells, bool csv)
+    {
+        if (csv)
+            return cells.joinIntoString(",");
+
+        juce::String row = cells[0].paddedRight(' ', 26);
+        for (int i = 1; i < cells.size(); ++i)
+            row << cells[i].paddedLeft(' ', 8);
+        return row;
+    }
+
+    juce::String formatRow(const Result& r, bool csv)
+    {
+        juce::StringArray cells { r.config.name, juce::String(r.nsPerSample, 1), juce::String(r.t60, 2) };
+
+        for (auto t : r.octaveT60)
+            cells.add(juce::String(t, 2));
+
+        cells.add(juce::String(r.ned50, 2));
+        cells.add(juce::String(r.ned100, 2));
+        cells.add(juce::String(r.mixingMs, 1));
+        cells.add(juce::String(r.flatness, 3));
+
+        return formatCells(cells, csv);
+    }
+
+    juce::String formatHeader(bool csv)
+    {
+        juce::StringArray cells { "config", "ns/smp", "T60" };
+
+        for (auto f : Analysis::octaveCentres)
+            cells.add(f >= 1000.0f ? juce::String((int)(f / 1000.0f)) + "k" : juce::String((int)f));
+
+        cells.addArray({ "NED50", "NED100", "dense ms", "flat" });
+
+        return formatCells(cells, csv);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto option = [&](const juce::String& name, double fallback)
+    {
+        auto index = args.indexOf(name);
+        return index >= 0 && index + 1 < args.size() ? args[index + 1].getDoubleValue() : fallback;
+    };
+
+    const double sampleRate = option("--sr", 48000.0);
+    const double targetDensity = option("--density", 0.9);
+    const double targetMs = option("--by", 80.0);
+    const bool csv = args.contains("--csv");
+
+    std::printf("%s\n", formatHeader(csv).toRawUTF8());
+
+    std::vector<Result> results;
+    for (auto& config : makeConfigurations())
+    {
+        results.push_back(analyse(config, sampleRate, targetDensity));
+        std::printf("%s\n", formatRow(results.back(), csv).toRawUTF8());
+    }
+
+    // Cheapest configuration that is dense enough in time
+    const Result* cheapest = nullptr;
+    for (auto& r : results)
+    {
+        if (r.config.program >= 0 && r.config.values.empty())
+            continue; // Plain factory programs are the reference, not candidates
+
+        if (r.mixingMs <= targetMs && (cheapest == nullptr || r.nsPerSample < cheapest->nsPerSample))
+            cheapest = &r;
+    }
+
+    if (! csv)
+    {
+        if (cheapest != nullptr)
+            std::printf("\nCheapest configuration reaching NED %.2f within %.0f ms: %s (%.1f ns/sample)\n",
+                        targetDensity, targetMs, cheapest->config.name.toRawUTF8(), cheapest->nsPerSample);
+        else
+            std::printf("\nNo configuration reaches NED %.2f within %.0f ms\n", targetDensity, targetMs);
+    }
+
+    return 0;
+}